@@ -29,6 +29,7 @@
 #include "cairo-dock-dialog-factory.h"  // gldi_dialog_show_temporary_with_default_icon
 #include "cairo-dock-themes-manager.h"  // cairo_dock_update_conf_file
 #include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
+#include "cairo-dock-icon-manager.h"  // cairo_dock_reset_icon_path_cache
 #include "cairo-dock-log.h"
 #include "cairo-dock-dock-manager.h"
 #include "cairo-dock-keybinder.h"  // cairo_dock_trigger_shortkey
@@ -484,6 +485,7 @@ void cairo_dock_set_custom_icon_on_appli (const gchar *cFilePath, Icon *icon, Gl
 		cairo_dock_copy_file (cPath?cPath:cFilePath, cDestPath);
 		g_free (cDestPath);
 		g_free (cPath);
+		cairo_dock_reset_icon_path_cache ();  // the icon was maybe not found before
 		
 		cairo_dock_reload_icon_image (icon, pContainer);
 		cairo_dock_redraw_icon (icon);
@@ -43,6 +43,7 @@
 #include "cairo-dock-dock-facility.h"
 #include "cairo-dock-themes-manager.h"  // cairo_dock_update_conf_file
 #include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
+#include "cairo-dock-icon-manager.h"  // cairo_dock_reset_icon_path_cache
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_launch_command_sync
 #include "cairo-dock-desklet-manager.h"
@@ -1011,6 +1012,7 @@ static void _cairo_dock_remove_custom_appli_icon (G_GNUC_UNUSED GtkMenuItem *pMe
 	if (cCustomIcon != NULL)
 	{
 		g_remove (cCustomIcon);
+		cairo_dock_reset_icon_path_cache ();
 		cairo_dock_reload_icon_image (icon, pContainer);
 		cairo_dock_redraw_icon (icon);
 	}
@@ -48,11 +48,13 @@
 
 #include <unistd.h> // sleep, execl, isatty
 #include <signal.h>
+#include <string.h>  // strlen
 
 #define __USE_POSIX
 #include <time.h>
 
 #include <glib/gstdio.h>
+#include <glib-unix.h>  // g_unix_signal_add
 #include <dbus/dbus-glib.h>  // dbus_g_thread_init
 
 #include "config.h"
@@ -74,6 +76,7 @@
 #include "cairo-dock-packages.h"
 #include "cairo-dock-utils.h"  // cairo_dock_launch_command
 #include "cairo-dock-core.h"
+#include "cairo-dock-profiling.h"  // gldi_profiling_dump_report
 
 #include "cairo-dock-gui-manager.h"
 #include "cairo-dock-gui-backend.h"
@@ -109,6 +112,7 @@ extern gboolean g_bX11UseEgl;
 extern gboolean g_bDisableSystemd; // defined in cairo-dock-core.c
 extern gboolean g_bDisableDbusActivation; // defined in cairo-dock-class-manager.c
 extern gboolean g_bGioLaunch; // defined in cairo-dock-class-manager.c
+extern gboolean g_bShowDamage; // defined in cairo-dock-container.c
 
 extern GldiModuleInstance *g_pCurrentModule;
 extern GtkWidget *cairo_dock_build_simple_gui_window (void);
@@ -188,16 +192,42 @@ static void _cairo_dock_quit (G_GNUC_UNUSED int signal)
 {
 	gtk_main_quit ();
 }
+/* SIGUSR2: write what the applets and the core have cost since the previous signal, and measure the time of the notifications from now on (it's not done by default, since it has a cost).
+ * So send it twice, some time apart, to know who is using the CPU in the meantime.
+ */
+static gboolean _cairo_dock_dump_profiling (G_GNUC_UNUSED gpointer data)
+{
+	gldi_profiling_dump_report (NULL);
+	gldi_profiling_reset ();
+	gldi_profiling_set_enabled (TRUE);
+	return G_SOURCE_CONTINUE;
+}
 /* Crash at startup:
  *  - First 2 crashes: retry with a delay of 2 sec (maybe due to a problem at startup)
  *  - 3th crash: remove the applet and restart the dock
  *  - 4th crash: show the maintenance mode
  *  - 5th crash: quit
  */
+static void _write_to_stderr (const char *str)  // async-signal-safe
+{
+	if (write (STDERR_FILENO, str, strlen (str)) < 0) return;
+}
 static void _cairo_dock_intercept_signal (int signal)
 {
 	// Note: we should not use any stdio in a signal handler -- but it is worth the risk to give some diagnostic at least...
-	cd_warning ("Cairo-Dock has crashed (sig %d).\nIt will be restarted now.\nFeel free to report this bug on https://github.com/Cairo-Dock/cairo-dock-core/issues to help improving the dock!", signal);
+	// the banner doesn't go through the log though, which allocates and takes locks when a thread logs for the first time.
+	char cSignal[12];
+	int i = sizeof (cSignal) - 1, n = signal;
+	cSignal[i] = '\0';
+	do
+	{
+		cSignal[--i] = '0' + n % 10;
+		n /= 10;
+	} while (n != 0 && i > 0);
+	_write_to_stderr ("\nCairo-Dock has crashed (sig ");
+	_write_to_stderr (cSignal + i);
+	_write_to_stderr (").\nIt will be restarted now.\nFeel free to report this bug on https://github.com/Cairo-Dock/cairo-dock-core/issues to help improving the dock!\n");
+	cd_log_dump_last_entries (STDERR_FILENO, 20);  // the messages are written by another thread, so the last ones may not have been written yet, and give some context anyway
 	
 	char cCounter[12];
 	
@@ -366,6 +396,8 @@ int main (int argc, char** argv)
 	textdomain (CAIRO_DOCK_GETTEXT_PACKAGE);
 	
 	//\___________________ get app's options.
+	gint64 iStartTime = g_get_monotonic_time ();
+	gboolean bVerbose = FALSE;
 	gboolean bSafeMode = FALSE, bMaintenance = FALSE, bNoSticky = FALSE, bCappuccino = FALSE, bPrintVersion = FALSE, bTesting = FALSE, bForceOpenGL = FALSE, bToggleIndirectRendering = FALSE, bKeepAbove = FALSE, bForceColors = FALSE, bAskBackend = FALSE, bTransparencyWorkaround = FALSE;
 	gchar *cEnvironment = NULL, *cUserDefinedDataDir = NULL, *cVerbosity = 0, *cUserDefinedModuleDir = NULL, *cExcludeModule = NULL, *cThemeServerAdress = NULL;
 	int iDelay = 0;
@@ -411,6 +443,9 @@ int main (int argc, char** argv)
 		{"log", 'l', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_STRING,
 			&cVerbosity,
 			_("Log verbosity (debug,message,warning,critical,error); default is warning."), NULL},
+		{"verbose", 0, G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE,
+			&bVerbose,
+			_("Print how long each step of the startup takes."), NULL},
 		{"colors", 'F', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE,
 			&bForceColors,
 			_("Force to display some output messages with colors."), NULL},
@@ -472,6 +507,9 @@ int main (int argc, char** argv)
 		{"force-gio-launch", 0, G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE,
 			&g_bGioLaunch,
 			_("For debugging purposes only. Rely on GIO to launch apps instead of our own implementation (implies --disable-systemd)."), NULL},
+		{"show-damage", 0, G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE,
+			&g_bShowDamage,
+			_("For debugging purposes only. Paint the areas of the docks that are redrawn."), NULL},
 		{NULL, 0, 0, 0,
 			NULL,
 			NULL, NULL}
@@ -513,6 +551,8 @@ int main (int argc, char** argv)
 	if (bForceColors)
 		cd_log_force_use_color ();
 	
+	cairo_dock_set_print_loading_times (bVerbose);
+	
 	CairoDockDesktopEnv iDesktopEnv = CAIRO_DOCK_UNKNOWN_ENV;
 	if (cEnvironment != NULL)
 	{
@@ -768,6 +808,9 @@ int main (int argc, char** argv)
 	//\___________________ handle terminate signals to quit properly (especially when the system shuts down).
 	signal (SIGTERM, _cairo_dock_quit);  // Term // kill -15 (system)
 	signal (SIGHUP,  _cairo_dock_quit);  // sent to a process when its controlling terminal is closed
+	
+	//\___________________ dump the profiling report on demand (kill -USR2).
+	g_unix_signal_add (SIGUSR2, _cairo_dock_dump_profiling, NULL);
 
 	//\___________________ Disable modules that have crashed
 	if (cExcludeModule != NULL && (s_iNbCrashes > 2 || bMaintenance)) // 3th crash or 4th (with -m)
@@ -880,6 +923,8 @@ int main (int argc, char** argv)
 		g_free (cConfFilePath);
 	}
 	cairo_dock_load_current_theme ();
+	if (bVerbose)
+		g_print ("Startup: the theme is loaded %.1f ms after the start\n", (g_get_monotonic_time () - iStartTime) / 1000.);
 	
 	//\___________________ lock mode.
 	if (g_bLocked)  // comme on ne pourra pas ouvrir le panneau de conf, ces 2 variables resteront tel quel.
@@ -1016,6 +1061,7 @@ int main (int argc, char** argv)
 	signal (SIGTERM, NULL);
 	signal (SIGHUP, NULL);
 
+	cairo_dock_sync_key_files ();  // write the last changes of the conf files
 	gldi_free_all ();
 
 	#if (LIBRSVG_MAJOR_VERSION == 2 && LIBRSVG_MINOR_VERSION < 36)
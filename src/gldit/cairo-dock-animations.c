@@ -138,14 +138,257 @@ gfloat cairo_dock_calculate_magnitude (gint iMagnitudeIndex)  // merci a Robrob
 }
 
 
+  /////////////////
+ /// SCHEDULER ///
+/////////////////
+
+// All the animated containers are stepped by a single scheduler, driven by the frame clock of one of them
+// (so that the steps are aligned on the refresh of the screen), or by a timer if none of them is mapped or if its clock has stopped (e.g. an occluded window on Wayland).
+// Each container makes its step at the frame closest to its deadline, and the next deadline is iAnimationDeltaT ms after the previous deadline (not after the frame), so that on average it makes one step every iAnimationDeltaT ms, whatever the refresh rate.
+
+typedef struct _GldiAnimatedContainer {
+	GldiContainer *pContainer;  // NULL once it has been removed
+	gint64 iNextStep;  // deadline of the next step, in us
+	gint64 iLastStep;  // time of the previous step (or of the launch), in us
+} GldiAnimatedContainer;
+
+static GList *s_pAnimatedContainers = NULL;  // list of GldiAnimatedContainer
+static GldiContainer *s_pClockContainer = NULL;  // container whose frame clock drives the scheduler
+static GdkFrameClock *s_pFrameClock = NULL;
+static gulong s_iSidFrameClockUpdate = 0;
+static gulong s_iSidClockContainerUnmap = 0;
+static gint64 s_iLastFrameTime = 0;  // when the frame clock ticked for the last time
+static gboolean s_bFrameClockStalled = FALSE;  // TRUE if the frame clock doesn't tick any more; the timer takes over until it ticks again
+static guint s_iSidClockWatchdog = 0;
+static guint s_iSidAnimationTimer = 0;  // fallback timer
+static gboolean s_bSteppingContainers = FALSE;
+
+#define _DEFAULT_FRAME_INTERVAL 16667  // us, in case the frame clock doesn't know the refresh rate
+#define _TIMER_TOLERANCE 500  // us; the timer fires at the deadline, only round the ms
+#define _CLOCK_STALL_DELAY 100  // ms without a frame before the frame clock is considered as stopped
+
+static void _update_animation_driver (void);
+
+static GldiAnimatedContainer *_find_animated_container (GldiContainer *pContainer)
+{
+	GList *a;
+	for (a = s_pAnimatedContainers; a != NULL; a = a->next)
+	{
+		GldiAnimatedContainer *pAnimated = a->data;
+		if (pAnimated->pContainer == pContainer)
+			return pAnimated;
+	}
+	return NULL;
+}
+
+// iTolerance: half the interval between 2 ticks; a step is made at the tick closest to its deadline.
+static void _step_animated_containers (gint64 iTime, gint64 iTolerance)
+{
+	s_bSteppingContainers = TRUE;
+	GList *a;
+	for (a = s_pAnimatedContainers; a != NULL; a = a->next)  // containers launched during a step are appended and will be stepped at the next frame
+	{
+		GldiAnimatedContainer *pAnimated = a->data;
+		GldiContainer *pContainer = pAnimated->pContainer;
+		if (pContainer == NULL)
+			continue;
+		if (iTime + iTolerance < pAnimated->iNextStep)  // the next tick will be closer to the deadline
+			continue;
+		
+		pAnimated->iNextStep += (gint64)pContainer->iAnimationDeltaT * 1000;  // carry the remainder forward
+		if (pAnimated->iNextStep + iTolerance <= iTime)  // frames have been missed (busy main loop): don't try to catch up with a burst of steps
+			pAnimated->iNextStep = iTime + (gint64)pContainer->iAnimationDeltaT * 1000;
+		pContainer->iAnimationRealDeltaT = MAX (0, (iTime - pAnimated->iLastStep + 500) / 1000);
+		pAnimated->iLastStep = iTime;
+		gboolean bContinue = pContainer->iface.animation_loop (pContainer);
+		// note: the container may have been destroyed during its step, in which case it has been removed already
+		if (! bContinue && pAnimated->pContainer != NULL)
+		{
+			pAnimated->pContainer = NULL;
+			pContainer->iSidGLAnimation = 0;
+		}
+	}
+	s_bSteppingContainers = FALSE;
+	
+	// now we can free the removed containers
+	GList *next;
+	for (a = s_pAnimatedContainers; a != NULL; a = next)
+	{
+		next = a->next;
+		GldiAnimatedContainer *pAnimated = a->data;
+		if (pAnimated->pContainer == NULL)
+		{
+			g_free (pAnimated);
+			s_pAnimatedContainers = g_list_delete_link (s_pAnimatedContainers, a);
+		}
+	}
+	
+	_update_animation_driver ();
+}
+
+static void _on_frame_clock_update (GdkFrameClock *pFrameClock, G_GNUC_UNUSED gpointer data)
+{
+	s_iLastFrameTime = g_get_monotonic_time ();
+	if (s_bFrameClockStalled)  // it ticks again, take the lead back from the timer
+	{
+		s_bFrameClockStalled = FALSE;
+		cd_debug ("the frame clock ticks again");
+	}
+	gint64 iFrameTime = gdk_frame_clock_get_frame_time (pFrameClock);
+	gint64 iRefreshInterval = 0;
+	gdk_frame_clock_get_refresh_info (pFrameClock, iFrameTime, &iRefreshInterval, NULL);
+	if (iRefreshInterval <= 0)
+		iRefreshInterval = _DEFAULT_FRAME_INTERVAL;
+	_step_animated_containers (iFrameTime, iRefreshInterval / 2);
+}
+
+static gboolean _on_animation_timer (G_GNUC_UNUSED gpointer data)
+{
+	s_iSidAnimationTimer = 0;  // it's a one-shot timer, set again for the next deadline
+	_step_animated_containers (g_get_monotonic_time (), _TIMER_TOLERANCE);
+	return FALSE;
+}
+
+static gboolean _on_clock_watchdog (G_GNUC_UNUSED gpointer data)
+{
+	if (! s_bFrameClockStalled && g_get_monotonic_time () - s_iLastFrameTime > _CLOCK_STALL_DELAY * 1000)
+	{
+		cd_debug ("the frame clock has stopped, fall back to the timer");
+		s_bFrameClockStalled = TRUE;
+		_update_animation_driver ();
+	}
+	return TRUE;
+}
+
+static gboolean _update_animation_driver_idle (G_GNUC_UNUSED gpointer data)
+{
+	_update_animation_driver ();
+	return FALSE;
+}
+
+static void _on_clock_container_unmapped (G_GNUC_UNUSED GtkWidget *pWidget, G_GNUC_UNUSED gpointer data)
+{
+	// its frame clock may stop, take another one
+	g_idle_add (_update_animation_driver_idle, NULL);
+}
+
+static void _stop_frame_clock (void)
+{
+	if (s_iSidClockWatchdog != 0)
+	{
+		g_source_remove (s_iSidClockWatchdog);
+		s_iSidClockWatchdog = 0;
+	}
+	s_bFrameClockStalled = FALSE;
+	if (s_pFrameClock == NULL)
+		return;
+	g_signal_handler_disconnect (s_pFrameClock, s_iSidFrameClockUpdate);
+	gdk_frame_clock_end_updating (s_pFrameClock);
+	g_object_unref (s_pFrameClock);
+	s_pFrameClock = NULL;
+	s_iSidFrameClockUpdate = 0;
+	if (s_pClockContainer != NULL && s_pClockContainer->pWidget != NULL)
+		g_signal_handler_disconnect (s_pClockContainer->pWidget, s_iSidClockContainerUnmap);
+	s_iSidClockContainerUnmap = 0;
+	s_pClockContainer = NULL;
+}
+
+static void _stop_animation_timer (void)
+{
+	if (s_iSidAnimationTimer != 0)
+	{
+		g_source_remove (s_iSidAnimationTimer);
+		s_iSidAnimationTimer = 0;
+	}
+}
+
+static void _update_animation_driver (void)
+{
+	if (s_bSteppingContainers)  // will be done at the end of the steps
+		return;
+	
+	// look for a mapped container with a frame clock, keeping the current one if possible, and for the next deadline
+	GldiContainer *pClockContainer = NULL;
+	GdkFrameClock *pFrameClock = NULL;
+	gint64 iNextStep = G_MAXINT64;
+	GList *a;
+	for (a = s_pAnimatedContainers; a != NULL; a = a->next)
+	{
+		GldiAnimatedContainer *pAnimated = a->data;
+		GldiContainer *pContainer = pAnimated->pContainer;
+		if (pContainer == NULL)
+			continue;
+		iNextStep = MIN (iNextStep, pAnimated->iNextStep);
+		if ((pClockContainer == NULL || pContainer == s_pClockContainer)
+		&& pContainer->pWidget != NULL && gtk_widget_get_mapped (pContainer->pWidget))
+		{
+			GdkFrameClock *pClock = gtk_widget_get_frame_clock (pContainer->pWidget);
+			if (pClock != NULL)
+			{
+				pClockContainer = pContainer;
+				pFrameClock = pClock;
+			}
+		}
+	}
+	
+	if (pFrameClock != NULL)  // use the frame clock
+	{
+		if (pFrameClock != s_pFrameClock)
+		{
+			_stop_frame_clock ();
+			s_pFrameClock = g_object_ref (pFrameClock);
+			s_pClockContainer = pClockContainer;
+			s_iSidFrameClockUpdate = g_signal_connect (pFrameClock, "update", G_CALLBACK (_on_frame_clock_update), NULL);
+			s_iSidClockContainerUnmap = g_signal_connect (pClockContainer->pWidget, "unmap", G_CALLBACK (_on_clock_container_unmapped), NULL);
+			gdk_frame_clock_begin_updating (pFrameClock);
+			s_iLastFrameTime = g_get_monotonic_time ();
+		}
+		if (s_iSidClockWatchdog == 0)
+			s_iSidClockWatchdog = g_timeout_add (_CLOCK_STALL_DELAY, _on_clock_watchdog, NULL);
+	}
+	else
+		_stop_frame_clock ();
+	
+	_stop_animation_timer ();
+	if (iNextStep != G_MAXINT64 && (s_pFrameClock == NULL || s_bFrameClockStalled))  // no frame clock available, fall back to a timer set at the next deadline
+	{
+		gint64 iDelay = (iNextStep - g_get_monotonic_time () + 500) / 1000;  // ms
+		s_iSidAnimationTimer = g_timeout_add (MAX (0, iDelay), _on_animation_timer, NULL);
+	}
+}
+
 void cairo_dock_launch_animation (GldiContainer *pContainer)
 {
-	if (pContainer->iSidGLAnimation == 0 && pContainer->iface.animation_loop != NULL)
+	if (pContainer->iface.animation_loop != NULL && _find_animated_container (pContainer) == NULL)
 	{
-		int iAnimationDeltaT = cairo_dock_get_animation_delta_t (pContainer);
 		pContainer->bKeepSlowAnimation = TRUE;
 		
-		pContainer->iSidGLAnimation = g_timeout_add (iAnimationDeltaT, (GSourceFunc)pContainer->iface.animation_loop, pContainer);
+		GldiAnimatedContainer *pAnimated = g_new0 (GldiAnimatedContainer, 1);
+		pAnimated->pContainer = pContainer;
+		pAnimated->iLastStep = g_get_monotonic_time ();
+		pAnimated->iNextStep = pAnimated->iLastStep + (gint64)pContainer->iAnimationDeltaT * 1000;  // the first step is made after iAnimationDeltaT
+		s_pAnimatedContainers = g_list_append (s_pAnimatedContainers, pAnimated);
+		pContainer->iSidGLAnimation = 1;  // no source of its own any more, it just means that it is animated
+		
+		_update_animation_driver ();
+	}
+}
+
+void cairo_dock_stop_container_animation (GldiContainer *pContainer)
+{
+	GldiAnimatedContainer *pAnimated = _find_animated_container (pContainer);
+	pContainer->iSidGLAnimation = 0;
+	if (pAnimated == NULL)
+		return;
+	
+	pAnimated->pContainer = NULL;  // it is freed at the end of the current steps, or right now
+	if (pContainer == s_pClockContainer)
+		_stop_frame_clock ();
+	if (! s_bSteppingContainers)
+	{
+		s_pAnimatedContainers = g_list_remove (s_pAnimatedContainers, pAnimated);
+		g_free (pAnimated);
+		_update_animation_driver ();
 	}
 }
 
@@ -400,7 +643,7 @@ static gboolean _cairo_dock_transition_step (G_GNUC_UNUSED gpointer pUserData, I
 		return GLDI_NOTIFICATION_LET_PASS;
 	
 	pTransition->iCount ++;
-	int iDetlaT = (pTransition->bFastPace ? cairo_dock_get_animation_delta_t (pContainer) : cairo_dock_get_slow_animation_delta_t (pContainer));
+	int iDetlaT = (pTransition->bFastPace ? cairo_dock_get_animation_real_delta_t (pContainer) : cairo_dock_get_slow_animation_delta_t (pContainer));
 	//int iNbSteps = 1.*pTransition->iDuration / iDetlaT;
 	pTransition->iElapsedTime += iDetlaT;
 	if (pTransition->iElapsedTime > pTransition->iDuration)
@@ -112,11 +112,16 @@ void cairo_dock_pop_down (CairoDock *pDock);
 
 gfloat cairo_dock_calculate_magnitude (gint iMagnitudeIndex);
 
-/** Launch the animation of a Container.
+/** Launch the animation of a Container. Its animation loop will be called by the animation scheduler every iAnimationDeltaT ms on average, at the frame of the screen closest to each step, until it returns FALSE. The real time elapsed between 2 steps is given by cairo_dock_get_animation_real_delta_t.
 *@param pContainer the container to animate.
 */
 void cairo_dock_launch_animation (GldiContainer *pContainer);
 
+/** Stop the animation of a Container right away (normally, it stops when its animation loop returns FALSE).
+*@param pContainer the container.
+*/
+void cairo_dock_stop_container_animation (GldiContainer *pContainer);
+
 void cairo_dock_start_shrinking (CairoDock *pDock);
 
 void cairo_dock_start_growing (CairoDock *pDock);
@@ -167,6 +172,10 @@ void cairo_dock_trigger_icon_removal_from_dock (Icon *pIcon);
 *@param pContainer the container.
 */
 #define cairo_dock_get_animation_delta_t(pContainer) CAIRO_CONTAINER(pContainer)->iAnimationDeltaT
+/** Get the real time elapsed since the previous iteration of the fast loop (in ms). Time-based animations should use it rather than the nominal interval.
+*@param pContainer the container.
+*/
+#define cairo_dock_get_animation_real_delta_t(pContainer) CAIRO_CONTAINER(pContainer)->iAnimationRealDeltaT
 /** Get the interval of time between 2 iterations of the slow loop (in ms).
 *@param pContainer the container.
 */
@@ -260,16 +260,10 @@ void cairo_dock_set_renderer (CairoDock *pDock, const gchar *cRendererName)
 	pDock->fMagnitudeMax = 1.;
 	pDock->container.bUseReflect = pDock->pRenderer->bUseReflect;
 	
-	int iAnimationDeltaT = pDock->container.iAnimationDeltaT;
 	pDock->container.iAnimationDeltaT = (g_bUseOpenGL && pDock->pRenderer->render_opengl != NULL ? myContainersParam.iGLAnimationDeltaT : myContainersParam.iCairoAnimationDeltaT);
 	if (pDock->container.iAnimationDeltaT == 0)
 		pDock->container.iAnimationDeltaT = 30;  // le main dock est cree avant meme qu'on ait recupere la valeur en conf. Lorsqu'une vue lui sera attribuee, la bonne valeur sera renseignee, en attendant on met un truc non nul.
-	if (iAnimationDeltaT != pDock->container.iAnimationDeltaT && pDock->container.iSidGLAnimation != 0)
-	{
-		g_source_remove (pDock->container.iSidGLAnimation);
-		pDock->container.iSidGLAnimation = 0;
-		cairo_dock_launch_animation (CAIRO_CONTAINER (pDock));
-	}
+	// note: if the dock is being animated, the animation scheduler will use the new interval from the next step
 	if (pDock->cRendererName != cRendererName)  // NULL ecrase le nom de l'ancienne vue.
 	{
 		g_free (pDock->cRendererName);
@@ -95,6 +95,7 @@ static GHashTable *s_hAltClass = NULL; // we store alternative class / app-ids h
 
 static gchar *_cairo_dock_register_class_full (const gchar *cSearchTerm, const gchar *cFallbackClass, const gchar *cWmClass,
 	gboolean bUseWmClass, gboolean bCreateAlways, gboolean bIsDesktopFile, GDesktopAppInfo *app, CairoDockClassAppli **pResult);
+static void _load_resolved_classes (void);
 
 static void _cairo_dock_free_class_appli (CairoDockClassAppli *pClassAppli)
 {
@@ -780,6 +781,7 @@ void gldi_app_info_set_run_in_terminal (GldiAppInfo *app, gboolean bNeedsTermina
 void cairo_dock_initialize_class_manager (void)
 {
 	gldi_desktop_file_db_init ();
+	_load_resolved_classes ();
 	if (s_hClassTable == NULL)
 		s_hClassTable = g_hash_table_new_full (g_str_hash,
 			g_str_equal,
@@ -2581,6 +2583,157 @@ gchar *cairo_dock_guess_class (const gchar *cCommand, const gchar *cStartupWMCla
 
 
 
+/***********************************************************************
+ * cache of the desktop files found for a class.
+ * Finding the desktop file of a new class takes several lookups with
+ * heuristics, so the result is remembered (also between sessions) as
+ * long as the desktop file DB doesn't change. */
+#define CLASS_CACHE_VERSION 1
+
+static GHashTable *s_hResolvedClasses = NULL;  // search key -> "desktop file ID\tfilename", or "" if none was found
+static guint s_iResolvedClassesGeneration = 0;  // generation of the desktop file DB that the cache is valid for
+static guint s_iSidSaveResolvedClasses = 0;
+
+static gchar *_get_resolved_classes_path (void)
+{
+	return g_build_filename (g_get_user_cache_dir (), "cairo-dock", "classes", NULL);
+}
+
+static void _load_resolved_classes (void)
+{
+	if (s_hResolvedClasses != NULL)  // already loaded
+		return;
+	s_hResolvedClasses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	
+	gchar *cPath = _get_resolved_classes_path ();
+	gchar *cContent = NULL;
+	gboolean bRead = g_file_get_contents (cPath, &cContent, NULL, NULL);
+	g_free (cPath);
+	if (!bRead) return;
+	
+	// 1st line: version and generation; then: search term, fallback class, WM class, desktop file flag, desktop file ID, filename
+	gchar **pLines = g_strsplit (cContent, "\n", -1);
+	g_free (cContent);
+	int iVersion = 0;
+	if (pLines[0] && sscanf (pLines[0], "%d %u", &iVersion, &s_iResolvedClassesGeneration) == 2 && iVersion == CLASS_CACHE_VERSION)
+	{
+		int i;
+		for (i = 1; pLines[i] != NULL; i++)
+		{
+			gchar **pFields = g_strsplit (pLines[i], "\t", 5);
+			if (g_strv_length (pFields) == 5)
+				g_hash_table_insert (s_hResolvedClasses,
+					g_strdup_printf ("%s\t%s\t%s\t%s", pFields[0], pFields[1], pFields[2], pFields[3]),
+					g_strdup (pFields[4]));
+			g_strfreev (pFields);
+		}
+	}
+	else s_iResolvedClassesGeneration = 0;
+	g_strfreev (pLines);
+}
+
+static gboolean _save_resolved_classes (G_GNUC_UNUSED gpointer data)
+{
+	GString *sContent = g_string_new ("");
+	g_string_printf (sContent, "%d %u\n", CLASS_CACHE_VERSION, s_iResolvedClassesGeneration);
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, s_hResolvedClasses);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_string_append_printf (sContent, "%s\t%s\n", (gchar*)key, (gchar*)value);
+	
+	gchar *cPath = _get_resolved_classes_path ();
+	gchar *cDir = g_path_get_dirname (cPath);
+	g_mkdir_with_parents (cDir, 7*8*8+7*8+5);
+	GError *erreur = NULL;
+	if (!g_file_set_contents (cPath, sContent->str, sContent->len, &erreur))
+	{
+		cd_warning ("couldn't save the classes cache: %s", erreur->message);
+		g_error_free (erreur);
+	}
+	g_free (cDir);
+	g_free (cPath);
+	g_string_free (sContent, TRUE);
+	s_iSidSaveResolvedClasses = 0;
+	return FALSE;
+}
+
+static gchar *_make_resolved_class_key (const gchar *cSearchTerm, const gchar *cFallbackClass, const gchar *cWmClass, gboolean bIsDesktopFile)
+{
+	if (*cSearchTerm == '/'  // a path is not searched in the DB
+	|| strpbrk (cSearchTerm, "\t\n") || (cFallbackClass && strpbrk (cFallbackClass, "\t\n")) || (cWmClass && strpbrk (cWmClass, "\t\n")))
+		return NULL;
+	return g_strdup_printf ("%s\t%s\t%s\t%d", cSearchTerm, cFallbackClass ? cFallbackClass : "", cWmClass ? cWmClass : "", bIsDesktopFile ? 1 : 0);
+}
+
+/* Look for the result of a previous search. Returns TRUE if it was found,
+ * in which case *app is the (referenced) app, or NULL if no desktop file was found. */
+static gboolean _lookup_resolved_class (const gchar *cKey, GDesktopAppInfo **app)
+{
+	*app = NULL;
+	if (!cKey) return FALSE;
+	
+	// forget everything if apps have changed since the cache was made
+	guint iGeneration = gldi_desktop_file_db_get_generation ();
+	if (iGeneration == 0) return FALSE;  // DB not loaded yet
+	if (iGeneration != s_iResolvedClassesGeneration)
+	{
+		g_hash_table_remove_all (s_hResolvedClasses);
+		s_iResolvedClassesGeneration = iGeneration;
+		return FALSE;
+	}
+	
+	const gchar *cResult = g_hash_table_lookup (s_hResolvedClasses, cKey);
+	if (!cResult) return FALSE;
+	if (*cResult == '\0') return TRUE;  // we already know there is no desktop file
+	
+	// exact lookup of the desktop file ID, and check that it's still the same file
+	gchar **pFields = g_strsplit (cResult, "\t", 2);
+	if (pFields[0] && pFields[1])
+	{
+		GDesktopAppInfo *pDesktopAppInfo = gldi_desktop_file_db_lookup (pFields[0], TRUE);
+		if (pDesktopAppInfo && g_strcmp0 (g_desktop_app_info_get_filename (pDesktopAppInfo), pFields[1]) == 0)
+			*app = g_object_ref (pDesktopAppInfo);
+	}
+	g_strfreev (pFields);
+	return (*app != NULL);
+}
+
+static void _remember_resolved_class (gchar *cKey, GDesktopAppInfo *app)
+{
+	if (!cKey) return;
+	// the result is only valid for the generation of the DB at the time of the search
+	guint iGeneration = gldi_desktop_file_db_get_generation ();
+	if (iGeneration == 0 || iGeneration != s_iResolvedClassesGeneration)
+	{
+		g_free (cKey);
+		return;
+	}
+	
+	gchar *cResult = NULL;
+	if (app)
+	{
+		const gchar *cFileName = g_desktop_app_info_get_filename (app);
+		if (!cFileName || strpbrk (cFileName, "\t\n"))
+		{
+			g_free (cKey);
+			return;
+		}
+		gchar *cBaseName = g_path_get_basename (cFileName);
+		gchar *str = g_strrstr (cBaseName, ".desktop");
+		gchar *cDesktopFileID = g_ascii_strdown (cBaseName, str ? str - cBaseName : -1);
+		cResult = g_strdup_printf ("%s\t%s", cDesktopFileID, cFileName);
+		g_free (cDesktopFileID);
+		g_free (cBaseName);
+	}
+	else cResult = g_strdup ("");
+	g_hash_table_insert (s_hResolvedClasses, cKey, cResult);
+	
+	if (s_iSidSaveResolvedClasses == 0)
+		s_iSidSaveResolvedClasses = g_timeout_add_seconds (10, _save_resolved_classes, NULL);
+}
+
+
 /** Register an application class from apps installed on the system -- internal version.
 * @param cSearchTerm class name to search for; can be desktop file path or class name or app-id;
 * 	preprocessed accordingly with cairo_dock_guess_class () or gldi_window_parse_class ()
@@ -2657,10 +2810,18 @@ static gchar *_cairo_dock_register_class_full (const gchar *cSearchTerm, const g
 		}
 	}
 
+	gchar *cResolvedKey = NULL;
+	gboolean bResolved = FALSE;
 	if (app) g_object_ref (app); // will be unrefed later
+	else
+	{
+		//\__________________ see if we already searched it.
+		cResolvedKey = _make_resolved_class_key (cSearchTerm, cFallbackClass, cWmClass, bIsDesktopFile);
+		bResolved = _lookup_resolved_class (cResolvedKey, &app);
+	}
 
 	//\__________________ search the desktop file's path.
-	if (!app && cFallbackClass)
+	if (!app && !bResolved && cFallbackClass)
 	{
 		// in this case, we do a two-stage search: first we try exact matches, then using heuristics
 		// this is to avoid edge cases where cFallbackClass would be an exact match
@@ -2679,7 +2840,7 @@ static gchar *_cairo_dock_register_class_full (const gchar *cSearchTerm, const g
 		}
 	}
 	
-	if (!app)
+	if (!app && !bResolved)
 	{
 		//!! TODO: maybe we should not allow heuristics for .desktop file names?
 		/// (e.g. should "terminal.desktop" match "org.gnome.Terminal.desktop" ?)
@@ -2700,6 +2861,9 @@ static gchar *_cairo_dock_register_class_full (const gchar *cSearchTerm, const g
 		}
 	}
 	
+	if (bResolved) g_free (cResolvedKey);
+	else _remember_resolved_class (cResolvedKey, app);  // takes ownership of the key
+
 	if (!app)  // couldn't find the .desktop
 	{
 		if (bCreateAlways)  // make a class anyway to store the few info we have.
@@ -62,6 +62,8 @@ extern gchar *g_cConfFile;
 extern gboolean g_bUseOpenGL;
 
 static gboolean s_bLoading = FALSE;
+static gboolean s_bPrintLoadingTimes = FALSE;
+static gint64 s_iLoadingStepTime = 0;
 
 
 gboolean cairo_dock_get_boolean_key_value (GKeyFile *pKeyFile, const gchar *cGroupName, const gchar *cKeyName, gboolean *bFlushConfFileNeeded, gboolean bDefaultValue, const gchar *cDefaultGroupName, const gchar *cDefaultKeyName)
@@ -448,13 +450,25 @@ void cairo_dock_get_size_key_value (GKeyFile *pKeyFile, const gchar *cGroupName,
 }
 
 
+static void _end_loading_step (const gchar *cStep)
+{
+	gint64 t = g_get_monotonic_time ();
+	if (s_bPrintLoadingTimes)
+		g_print ("  %s: %.1f ms\n", cStep, (t - s_iLoadingStepTime) / 1000.);
+	s_iLoadingStepTime = t;
+}
+
 void cairo_dock_load_current_theme (void)
 {
 	cd_message ("%s ()", __func__);
 	s_bLoading = TRUE;
+	gint64 iStartTime = s_iLoadingStepTime = g_get_monotonic_time ();
+	if (s_bPrintLoadingTimes)
+		g_print ("Loading the current theme...\n");
 	
 	//\___________________ Free everything.
 	gldi_free_all ();  // do nothing if there is nothing to unload.
+	_end_loading_step ("unload the previous theme");
 		
 	//\___________________ Get all managers config.
 	gldi_managers_get_config (g_cConfFile, GLDI_VERSION);  /// en fait, CAIRO_DOCK_VERSION ...
@@ -462,6 +476,7 @@ void cairo_dock_load_current_theme (void)
 	//\___________________ Load config for auto-loaded modules (these represent core modules,
 	//  including dock-rendering, whose config is needed in the next step).
 	gldi_modules_load_auto_config ();
+	_end_loading_step ("read the config");
 	
 	//\___________________ Create the primary container (needed to have a cairo/opengl context).
 	CairoDock *pMainDock = gldi_dock_new (CAIRO_DOCK_MAIN_DOCK_NAME);
@@ -469,21 +484,32 @@ void cairo_dock_load_current_theme (void)
 	//\___________________ Load all managers data.
 	gldi_managers_load ();
 	gldi_modules_activate_from_list (NULL);  // load auto-loaded modules before loading anything (views, etc)
+	_end_loading_step ("create the main dock and load the managers");
 	
 	//\___________________ Now load the user icons (launchers, etc).
 	gldi_user_icons_new_from_directory (g_cCurrentLaunchersPath);
 	
 	cairo_dock_hide_show_launchers_on_other_desktops ();
+	_end_loading_step ("load the launchers");
 	
 	//\___________________ Load the applets.
 	gldi_modules_activate_from_list (myModulesParam.cActiveModuleList);
+	_end_loading_step ("activate the applets");
 	
 	//\___________________ Start the applications manager (will load the icons if the option is enabled).
 	cairo_dock_start_applications_manager (pMainDock);
+	_end_loading_step ("start the taskbar");
 	
+	if (s_bPrintLoadingTimes)
+		g_print ("Theme loaded in %.1f ms\n", (g_get_monotonic_time () - iStartTime) / 1000.);
 	s_bLoading = FALSE;
 }
 
+void cairo_dock_set_print_loading_times (gboolean bPrint)
+{
+	s_bPrintLoadingTimes = bPrint;
+}
+
 
 gboolean cairo_dock_is_loading (void)
 {
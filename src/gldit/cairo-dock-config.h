@@ -153,6 +153,11 @@ void cairo_dock_get_color_key_value (GKeyFile *pKeyFile, const gchar *cGroupName
 */
 void cairo_dock_load_current_theme (void);
 
+/** Print how long each step of the loading of the current theme takes (launchers, applets, etc).
+*@param bPrint TRUE to print the times
+*/
+void cairo_dock_set_print_loading_times (gboolean bPrint);
+
 
 /** Say if Cairo-Dock is loading.
 *@return TRUE if the global config is being loaded (this happens when a theme is loaded).
@@ -239,6 +239,14 @@ gboolean gldi_container_use_new_positioning_code ();
 
 void cairo_dock_set_default_rgba_visual (GtkWidget *pWidget);
 
+/* Start accumulating the damage of a container, instead of invalidating each area as soon as it is redrawn.
+ */
+void gldi_container_start_collecting_damage (GldiContainer *pContainer);
+
+/* Invalidate the damage accumulated since gldi_container_start_collecting_damage at once, and stop accumulating.
+ */
+void gldi_container_flush_damage (GldiContainer *pContainer);
+
 /** Enable a Container to accept drag-and-drops.
 * @param pContainer a container.
 * @param pCallBack the function that will be called when some data is received.
@@ -59,6 +59,8 @@ extern gboolean g_bUseOpenGL;
 extern CairoDockHidingEffect *g_pHidingBackend;  // cairo_dock_is_hidden
 extern CairoDock *g_pMainDock;  // for the default dock visibility when composite goes off->on
 
+gboolean g_bShowDamage = FALSE;  // paint the redrawn areas of the docks, for debugging only (set with --show-damage)
+
 // private
 static gboolean s_bSticky = TRUE;
 static gboolean s_bInitialOpacity0 = FALSE;  // set initial window opacity to 0, to avoid grey rectangles.
@@ -212,7 +214,12 @@ static inline void _redraw_container_area (GldiContainer *pContainer, GdkRectang
 		pArea->width = pContainer->iHeight - pArea->x;
 	
 	if (pArea->width > 0 && pArea->height > 0)
-		gdk_window_invalidate_rect (gldi_container_get_gdk_window (pContainer), pArea, FALSE);
+	{
+		if (pContainer->pDamage != NULL)  // in an animation frame, it will be redrawn at the end of it
+			cairo_region_union_rectangle (pContainer->pDamage, pArea);
+		else
+			gdk_window_invalidate_rect (gldi_container_get_gdk_window (pContainer), pArea, FALSE);
+	}
 }
 
 void cairo_dock_redraw_container_area (GldiContainer *pContainer, GdkRectangle *pArea)
@@ -228,7 +235,7 @@ void cairo_dock_redraw_icon (Icon *icon)
 	GldiContainer *pContainer = cairo_dock_get_icon_container (icon);
 	g_return_if_fail (pContainer != NULL);
 	GdkRectangle rect;
-	cairo_dock_compute_icon_area (icon, pContainer, &rect);
+	cairo_dock_compute_icon_damage_area (icon, pContainer, &rect);
 	
 	if (CAIRO_DOCK_IS_DOCK (pContainer) &&
 		( (cairo_dock_is_hidden (CAIRO_DOCK (pContainer)) && ! icon->bIsDemandingAttention && ! icon->bAlwaysVisible)
@@ -237,6 +244,45 @@ void cairo_dock_redraw_icon (Icon *icon)
 	_redraw_container_area (pContainer, &rect);
 }
 
+void gldi_container_add_damage (GldiContainer *pContainer, const cairo_region_t *pRegion)
+{
+	g_return_if_fail (pContainer != NULL && pRegion != NULL);
+	if (! gldi_container_is_visible (pContainer))
+		return ;
+	if (pContainer->pDamage != NULL)
+		cairo_region_union (pContainer->pDamage, pRegion);
+	else
+		gdk_window_invalidate_region (gldi_container_get_gdk_window (pContainer), pRegion, FALSE);
+}
+
+void gldi_container_add_damage_area (GldiContainer *pContainer, const GdkRectangle *pArea)
+{
+	g_return_if_fail (pContainer != NULL && pArea != NULL);
+	if (! gldi_container_is_visible (pContainer))
+		return ;
+	if (pContainer->pDamage != NULL)
+		cairo_region_union_rectangle (pContainer->pDamage, pArea);
+	else
+		gdk_window_invalidate_rect (gldi_container_get_gdk_window (pContainer), pArea, FALSE);
+}
+
+void gldi_container_start_collecting_damage (GldiContainer *pContainer)
+{
+	if (pContainer->pDamage == NULL)
+		pContainer->pDamage = cairo_region_create ();
+}
+
+void gldi_container_flush_damage (GldiContainer *pContainer)
+{
+	cairo_region_t *pDamage = pContainer->pDamage;
+	if (pDamage == NULL)
+		return;
+	pContainer->pDamage = NULL;
+	if (! cairo_region_is_empty (pDamage) && gldi_container_is_visible (pContainer))
+		gdk_window_invalidate_region (gldi_container_get_gdk_window (pContainer), pDamage, FALSE);
+	cairo_region_destroy (pDamage);
+}
+
 
 void cairo_dock_allow_widget_to_receive_data (GtkWidget *pWidget, GCallback pCallBack, gpointer data)
 {
@@ -851,22 +897,21 @@ static void reset_object (GldiObject *obj)
 	// destroy the opengl context
 	gldi_gl_container_finish (pContainer);
 	
+	// stop the animation loop
+	cairo_dock_stop_container_animation (pContainer);
+	
 	// destroy the window (will remove all signals)
 	gtk_widget_destroy (pContainer->pWidget);
 	pContainer->pWidget = NULL;
 	
-	// stop the animation loop
-	if (pContainer->iSidGLAnimation != 0)
-	{
-		g_source_remove (pContainer->iSidGLAnimation);
-		pContainer->iSidGLAnimation = 0;
-	}
-	
 	if (g_pPrimaryContainer == pContainer)
 		g_pPrimaryContainer = NULL;
 	
 	if (pContainer->pMoveToRect)
 		free(pContainer->pMoveToRect);
+	
+	if (pContainer->pDamage)
+		cairo_region_destroy (pContainer->pDamage);
 }
 
 void gldi_register_containers_manager (void)
@@ -133,7 +133,7 @@ struct _GldiContainer {
 	CairoDockTypeHorizontality bIsHorizontal;
 	/// TRUE if the container is oriented upwards, FALSE if downwards.
 	gboolean bDirectionUp;
-	/// Source ID of the animation loop.
+	/// non-zero while the container is animated (its animation loop is called by the animation scheduler).
 	guint iSidGLAnimation;
 	/// interval of time between 2 animation steps.
 	gint iAnimationDeltaT;
@@ -167,8 +167,12 @@ struct _GldiContainer {
 	void *pMoveToRect;
 	/// a wl_egl_window (needed on Wayland + EGL)
 	void *eglwindow;
+	/// area to redraw at the end of the current animation frame (NULL outside of a frame).
+	cairo_region_t *pDamage;
+	/// real time elapsed since the previous animation step, in ms (the steps are aligned on the frames of the screen, and it can be larger than iAnimationDeltaT if frames were missed).
+	gint iAnimationRealDeltaT;
 	
-	gpointer reserved[2];
+	gpointer reserved[1];
 };
 
 
@@ -234,6 +238,18 @@ void cairo_dock_redraw_container_area (GldiContainer *pContainer, GdkRectangle *
 */
 void cairo_dock_redraw_icon (Icon *icon);
 
+/** Report a region of a container that has changed and must be redrawn. During an animation frame of a dock, the damaged regions are accumulated and redrawn at once at the end of the frame; otherwise the region is redrawn right away. Unlike cairo_dock_redraw_container_area, it doesn't check if the animation will be visible, so renderers can use it to report exactly what they have changed.
+*@param pContainer the container.
+*@param pRegion the damaged region, in the container's coordinates.
+*/
+void gldi_container_add_damage (GldiContainer *pContainer, const cairo_region_t *pRegion);
+
+/** Same as gldi_container_add_damage, with a rectangle.
+*@param pContainer the container.
+*@param pArea the damaged area, in the container's coordinates.
+*/
+void gldi_container_add_damage_area (GldiContainer *pContainer, const GdkRectangle *pArea);
+
 
 void cairo_dock_allow_widget_to_receive_data (GtkWidget *pWidget, GCallback pCallBack, gpointer data);
 
@@ -49,18 +49,25 @@ extern gboolean g_bUseOpenGL;
 #define cairo_dock_set_data_renderer_on_icon(pIcon, pRenderer) (pIcon)->pDataRenderer = pRenderer
 #define CD_MIN_TEXT_WITH 24
 
+static void _cairo_dock_update_tab_values (CairoDataToRenderer *pData)
+{
+	g_free (pData->pTabValues);
+	pData->pTabValues = g_new (gdouble *, pData->iMemorySize);
+	int i;
+	for (i = 0; i < pData->iMemorySize; i ++)
+	{
+		pData->pTabValues[i] = &pData->pValuesBuffer[i*pData->iNbValues];
+	}
+}
+
 static void _cairo_dock_init_data_renderer (CairoDataRenderer *pRenderer, CairoDataRendererAttribute *pAttribute)
 {
 	//\_______________ On alloue la structure des donnees.
 	pRenderer->data.iNbValues = MAX (1, pAttribute->iNbValues);
 	pRenderer->data.iMemorySize = MAX (2, pAttribute->iMemorySize);  // au moins la derniere valeur et la nouvelle.
-	pRenderer->data.pValuesBuffer = g_new0 (gdouble, pRenderer->data.iNbValues * pRenderer->data.iMemorySize);
-	pRenderer->data.pTabValues = g_new (gdouble *, pRenderer->data.iMemorySize);
+	pRenderer->data.pValuesBuffer = g_new0 (gdouble, pRenderer->data.iNbValues * pRenderer->data.iMemorySize);  // a ring buffer of iMemorySize rows of iNbValues values.
+	_cairo_dock_update_tab_values (&pRenderer->data);
 	int i;
-	for (i = 0; i < pRenderer->data.iMemorySize; i ++)
-	{
-		pRenderer->data.pTabValues[i] = &pRenderer->data.pValuesBuffer[i*pRenderer->data.iNbValues];
-	}
 	pRenderer->data.iCurrentIndex = -1;
 	pRenderer->data.pMinMaxValues = g_new (gdouble, 2 * pRenderer->data.iNbValues);
 	if (pAttribute->pMinMaxValues != NULL)
@@ -566,14 +573,7 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 				{
 					memset (&pData->pValuesBuffer[iOldMemorySize * pData->iNbValues], 0, (pData->iMemorySize - iOldMemorySize) * pData->iNbValues * sizeof (gdouble));
 				}
-				
-				g_free (pData->pTabValues);
-				pData->pTabValues = g_new (gdouble *, pData->iMemorySize);
-				int i;
-				for (i = 0; i < pData->iMemorySize; i ++)
-				{
-					pData->pTabValues[i] = &pData->pValuesBuffer[i*pData->iNbValues];
-				}
+				_cairo_dock_update_tab_values (pData);
 				if (pData->iCurrentIndex >= pData->iMemorySize)
 					pData->iCurrentIndex = pData->iMemorySize - 1;
 			}
@@ -622,6 +622,20 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 }
 
 
+CairoDataRenderer *cairo_dock_new_unbound_data_renderer (CairoDataRendererAttribute *pAttribute, int iWidth, int iHeight)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_new_data_renderer (pAttribute->cModelName);
+	if (pRenderer == NULL)
+		return NULL;
+	
+	_cairo_dock_init_data_renderer (pRenderer, pAttribute);
+	pRenderer->iWidth = iWidth;
+	pRenderer->iHeight = iHeight;
+	pRenderer->interface.load (pRenderer, NULL, pAttribute);  // no emblem, label or overlay, they belong to an icon.
+	return pRenderer;
+}
+
+
 static gboolean _render_delayed (Icon *pIcon)
 {
 	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
@@ -641,16 +655,13 @@ static gboolean _render_delayed (Icon *pIcon)
 	pRenderer->iSidRenderIdle = 0;
 	return FALSE;
 }
-void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext, double *pNewValues)
+void cairo_dock_push_new_data (CairoDataRenderer *pRenderer, double *pNewValues)
 {
-	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
-	g_return_if_fail (pRenderer != NULL);
-	
-	//\___________________ On met a jour les valeurs du renderer.
 	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
 	pData->iCurrentIndex ++;
 	if (pData->iCurrentIndex >= pData->iMemorySize)
 		pData->iCurrentIndex -= pData->iMemorySize;
+	pData->iNbPushedValues ++;
 	double fNewValue;
 	int i;
 	for (i = 0; i < pData->iNbValues; i ++)
@@ -663,9 +674,19 @@ void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer,
 			if (fNewValue > pData->pMinMaxValues[2*i+1])
 				pData->pMinMaxValues[2*i+1] = MAX (fNewValue, pData->pMinMaxValues[2*i]+.1);
 		}
-		pData->pTabValues[pData->iCurrentIndex][i] = fNewValue;
+		cairo_data_renderer_get_current_value (pRenderer, i) = fNewValue;
 	}
 	pData->bHasValue = TRUE;
+}
+
+void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext, double *pNewValues)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+	g_return_if_fail (pRenderer != NULL);
+	
+	//\___________________ On met a jour les valeurs du renderer.
+	cairo_dock_push_new_data (pRenderer, pNewValues);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
 	
 	//\___________________ On met a jour le dessin de l'icone.
 	if (CAIRO_DOCK_CONTAINER_IS_OPENGL (pContainer) && pRenderer->interface.render_opengl)
@@ -829,14 +850,7 @@ void cairo_dock_resize_data_renderer_history (Icon *pIcon, int iNewMemorySize)
 	{
 		memset (&pData->pValuesBuffer[iOldMemorySize * pData->iNbValues], 0, (iNewMemorySize - iOldMemorySize) * pData->iNbValues * sizeof (gdouble));
 	}
-	
-	g_free (pData->pTabValues);
-	pData->pTabValues = g_new (gdouble *, pData->iMemorySize);
-	int i;
-	for (i = 0; i < pData->iMemorySize; i ++)
-	{
-		pData->pTabValues[i] = &pData->pValuesBuffer[i*pData->iNbValues];
-	}
+	_cairo_dock_update_tab_values (pData);
 	if (pData->iCurrentIndex >= pData->iMemorySize)
 		pData->iCurrentIndex = pData->iMemorySize - 1;
 }
@@ -57,11 +57,12 @@ typedef enum _RendererRotateTheme {
 struct _CairoDataToRenderer {
 	gint iNbValues;
 	gint iMemorySize;
-	gdouble *pValuesBuffer;
-	gdouble **pTabValues;
+	gdouble *pValuesBuffer;  // ring buffer of iMemorySize rows of iNbValues values, the current row being at iCurrentIndex.
+	gdouble **pTabValues;  // deprecated: pointers to the rows of pValuesBuffer, only kept for the applets that still index them; use the cairo_data_renderer_get_value() macros instead.
 	gdouble *pMinMaxValues;
 	gint iCurrentIndex;
 	gboolean bHasValue;  // TRUE as soon as a value has been set in the history
+	guint iNbPushedValues;  // number of rows pushed so far (it wraps around); the difference between 2 readings tells how many values arrived in-between, even a whole turn of the ring.
 };
 
 #define CAIRO_DOCK_DATA_FORMAT_MAX_LEN 20
@@ -220,6 +221,22 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 *@param pNewValues a set a new values (must be of the size defined on the creation of the Renderer)*/
 void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext, double *pNewValues);
 
+/**Add a set of new values to the history of a Data Renderer, without drawing it. This is done by /ref cairo_dock_render_new_data_on_icon.
+*@param pRenderer the Data Renderer
+*@param pNewValues a set a new values (must be of the size defined on the creation of the Renderer)*/
+void cairo_dock_push_new_data (CairoDataRenderer *pRenderer, double *pNewValues);
+
+/**Create a Data Renderer that is not bound to any icon, for instance to measure a model. It is drawn with its interface's render function, on a context of the given size; it has no emblem, label or overlay.
+*@param pAttribute attributes defining the Renderer
+*@param iWidth width of the drawing
+*@param iHeight height of the drawing
+*@return the new Data Renderer, to be destroyed with /ref cairo_dock_free_data_renderer, or NULL if the model is unknown.*/
+CairoDataRenderer *cairo_dock_new_unbound_data_renderer (CairoDataRendererAttribute *pAttribute, int iWidth, int iHeight);
+
+/**Destroy a Data Renderer and all its resources. Use /ref cairo_dock_remove_data_renderer_on_icon for the Data Renderer of an icon.
+*@param pRenderer the Data Renderer*/
+void cairo_dock_free_data_renderer (CairoDataRenderer *pRenderer);
+
 /**Remove the Data Renderer of an icon. All the allocated resources will be freed.
 *@param pIcon the icon*/
 void cairo_dock_remove_data_renderer_on_icon (Icon *pIcon);
@@ -293,17 +310,22 @@ void cairo_data_renderer_get_size (CairoDataRenderer *pRenderer, gint *iWidth, g
 *@param i the number of the value
 *@return a double*/
 #define cairo_data_renderer_get_max_value(pRenderer, i) (pRenderer)->data.pMinMaxValues[2*i+1]
+/**Get the index of the row at the time t in the history of the values.
+*@param pRenderer a data renderer
+*@param t the time (in number of steps, between -iMemorySize and iMemorySize)
+*@return an index in [0, iMemorySize[*/
+#define cairo_data_renderer_get_history_index(pRenderer, t) ((pRenderer)->data.iCurrentIndex+(t) >= (pRenderer)->data.iMemorySize ? (pRenderer)->data.iCurrentIndex+(t)-(pRenderer)->data.iMemorySize : (pRenderer)->data.iCurrentIndex+(t) < 0 ? (pRenderer)->data.iCurrentIndex+(t)+(pRenderer)->data.iMemorySize : (pRenderer)->data.iCurrentIndex+(t))
 /**Get the i-th value at the time t.
 *@param pRenderer a data renderer
 *@param i the number of the value
 *@param t the time (in number of steps)
 *@return a double*/
-#define cairo_data_renderer_get_value(pRenderer, i, t) pRenderer->data.pTabValues[pRenderer->data.iCurrentIndex+t > pRenderer->data.iMemorySize ? pRenderer->data.iCurrentIndex+t-pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t < 0 ? pRenderer->data.iCurrentIndex+t+pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t][i]
+#define cairo_data_renderer_get_value(pRenderer, i, t) (pRenderer)->data.pValuesBuffer[cairo_data_renderer_get_history_index (pRenderer, t) * (pRenderer)->data.iNbValues + (i)]
 /**Get the current i-th value.
 *@param pRenderer a data renderer
 *@param i the number of the value
 *@return a double*/
-#define cairo_data_renderer_get_current_value(pRenderer, i) pRenderer->data.pTabValues[pRenderer->data.iCurrentIndex][i]
+#define cairo_data_renderer_get_current_value(pRenderer, i) (pRenderer)->data.pValuesBuffer[(pRenderer)->data.iCurrentIndex * (pRenderer)->data.iNbValues + (i)]
 /**Get the previous i-th value.
 *@param pRenderer a data renderer
 *@param i the number of the value
@@ -93,6 +93,18 @@ struct _CairoDeskletAttr {
 	Icon *pIcon;
 } ;
 
+typedef struct _CairoDeskletHitShape CairoDeskletHitShape;
+
+/// Definition of a shape that can be picked on a desklet. It is a quadrilateral, given in the frame where the desklet's renderer draws with OpenGL: origin at the center of the desklet, X to the right, Y upward, Z toward the viewer, in pixels.
+struct _CairoDeskletHitShape {
+	/// the 4 corners (x,y,z) of the shape, in order around it.
+	gdouble pVertices[12];
+	/// the icon that is picked with this shape, or NULL for the main icon.
+	Icon *pIcon;
+	/// ID of the object picked with this shape, set in iPickedObject (0 if it's just an icon).
+	GLuint iObject;
+	};
+
 typedef gpointer CairoDeskletRendererDataParameter;
 typedef CairoDeskletRendererDataParameter* CairoDeskletRendererDataPtr;
 typedef gpointer CairoDeskletRendererConfigParameter;
@@ -108,6 +120,7 @@ typedef void (* CairoDeskletLoadRendererDataFunc) (CairoDesklet *pDesklet);
 typedef void (* CairoDeskletUpdateRendererDataFunc) (CairoDesklet *pDesklet, CairoDeskletRendererDataPtr pNewData);
 typedef void (* CairoDeskletFreeRendererDataFunc) (CairoDesklet *pDesklet);
 typedef void (* CairoDeskletCalculateIconsFunc) (CairoDesklet *pDesklet);
+typedef void (* CairoDeskletHitShapesFunc) (CairoDesklet *pDesklet);
 /// Definition of a Desklet's renderer.
 struct _CairoDeskletRenderer {
 	/// rendering function with libcairo.
@@ -124,8 +137,10 @@ struct _CairoDeskletRenderer {
 	CairoDeskletCalculateIconsFunc 			calculate_icons;
 	/// function called on each iteration of the rendering loop.
 	CairoDeskletUpdateRendererDataFunc 	update;
-	/// optional rendering function with OpenGL that only draws the bounding boxes of the icons (for picking).
+	/// optional rendering function with OpenGL that only draws the bounding boxes of the icons (for picking). Deprecated, use get_hit_shapes instead.
 	CairoDeskletGLRenderFunc 			render_bounding_box;
+	/// optional function that defines the shapes of the icons with gldi_desklet_add_hit_shape (for picking, both in Cairo and OpenGL). By default the icons are picked inside their rectangle.
+	CairoDeskletHitShapesFunc 			get_hit_shapes;
 	/// An optional list of preset configs.
 	GList *pPreDefinedConfigList;
 };
@@ -146,7 +161,9 @@ struct _CairoDesklet {
 	gpointer pRendererData;
 	// The following function outclasses the corresponding function of the renderer. This is useful if you don't want to pick icons but some elements that you draw yourself on the desklet.
 	CairoDeskletGLRenderFunc render_bounding_box;
-	// ID of the object that was picked in case the previous function is not null.
+	// Same as above, with shapes defined with gldi_desklet_add_hit_shape; it replaces render_bounding_box, which needs an OpenGL rendering.
+	CairoDeskletHitShapesFunc get_hit_shapes;
+	// ID of the object that was picked in case one of the previous functions is not null.
 	GLuint iPickedObject;
 	
 	//\________________ decorations
@@ -182,6 +199,7 @@ struct _CairoDesklet {
 	gboolean bAllowMinimize;  // TRUE to allow the desklet to be minimized once. The flag is reset to FALSE after the desklet has minimized.
 	gint iMouseX2d;  // X position of the pointer taking into account the 2D transformations on the desklet (for an opengl renderer, you'll have to use the picking).
 	gint iMouseY2d;  // Y position of the pointer taking into account the 2D transformations on the desklet (for an opengl renderer, you'll have to use the picking).
+	GArray *pHitShapes;  // shapes that can be picked on the desklet (CairoDeskletHitShape), rebuilt at each picking.
 	GTimer *pUnmapTimer;
 	gdouble fButtonsAlpha;  // pour le fondu des boutons lors de l'entree dans le desklet.
 	gboolean bButtonsApparition;  // si les boutons sont en train d'apparaitre ou de disparaitre.
@@ -268,38 +268,91 @@ static void _render_desklet_cairo (CairoDesklet *pDesklet, cairo_t *pCairoContex
 	cairo_restore (pCairoContext);
 }
 
-static inline void _set_desklet_matrix (CairoDesklet *pDesklet)
+// the matrices are column-major, like in OpenGL; each operation is applied on the right, like glMultMatrix.
+static void _matrix_multiply (double *m, const double *r)
 {
+	double p[16];
+	int i, j;
+	for (i = 0; i < 4; i ++)  // row
+	{
+		for (j = 0; j < 4; j ++)  // column
+			p[4*j+i] = m[i] * r[4*j] + m[4+i] * r[4*j+1] + m[8+i] * r[4*j+2] + m[12+i] * r[4*j+3];
+	}
+	memcpy (m, p, sizeof (p));
+}
+
+static void _matrix_translate (double *m, double x, double y, double z)
+{
+	double r[16] = {1., 0., 0., 0.,  0., 1., 0., 0.,  0., 0., 1., 0.,  x, y, z, 1.};
+	_matrix_multiply (m, r);
+}
+
+static void _matrix_scale (double *m, double x, double y, double z)
+{
+	double r[16] = {x, 0., 0., 0.,  0., y, 0., 0.,  0., 0., z, 0.,  0., 0., 0., 1.};
+	_matrix_multiply (m, r);
+}
+
+static void _matrix_rotate (double *m, double fAngle, double x, double y, double z)  // same as glRotate, but in radians; (x,y,z) is a unit vector.
+{
+	double c = cos (fAngle), s = sin (fAngle), t = 1. - c;
+	double r[16] = {
+		x*x*t + c,   y*x*t + z*s, x*z*t - y*s, 0.,
+		x*y*t - z*s, y*y*t + c,   y*z*t + x*s, 0.,
+		x*z*t + y*s, y*z*t - x*s, z*z*t + c,   0.,
+		0.,          0.,          0.,          1.};
+	_matrix_multiply (m, r);
+}
+
+static inline void _matrix_transform_point (const double *m, const double *p, double *q)
+{
+	int i;
+	for (i = 0; i < 3; i ++)
+		q[i] = m[i] * p[0] + m[4+i] * p[1] + m[8+i] * p[2] + m[12+i];
+}
+
+static void _compute_desklet_matrix (CairoDesklet *pDesklet, double *m)
+{
+	memset (m, 0, 16 * sizeof (double));
+	m[0] = m[5] = m[10] = m[15] = 1.;
+	
 	double fDepthRotationY = (fabs (pDesklet->fDepthRotationY) > ANGLE_MIN ? pDesklet->fDepthRotationY : 0.);
 	double fDepthRotationX = (fabs (pDesklet->fDepthRotationX) > ANGLE_MIN ? pDesklet->fDepthRotationX : 0.);
-	glTranslatef (0., 0., -pDesklet->container.iHeight * sqrt(3)/2 - 
+	_matrix_translate (m, 0., 0., -pDesklet->container.iHeight * sqrt(3)/2 - 
 		.45 * MAX (pDesklet->container.iWidth * fabs (sin (fDepthRotationY)),
 			pDesklet->container.iHeight * fabs (sin (fDepthRotationX)))
 		);  // avec 60 deg de perspective
 	
 	if (pDesklet->container.fRatio != 1)
 	{
-		glScalef (pDesklet->container.fRatio, pDesklet->container.fRatio, 1.);
+		_matrix_scale (m, pDesklet->container.fRatio, pDesklet->container.fRatio, 1.);
 	}
 	
 	if (fabs (pDesklet->fRotation) > ANGLE_MIN)
 	{
 		double fZoom = _compute_zoom_for_rotation (pDesklet);
-		glScalef (fZoom, fZoom, 1.);
-		glRotatef (- pDesklet->fRotation / G_PI * 180., 0., 0., 1.);
+		_matrix_scale (m, fZoom, fZoom, 1.);
+		_matrix_rotate (m, - pDesklet->fRotation, 0., 0., 1.);
 	}
 	
 	if (fDepthRotationY != 0)
 	{
-		glRotatef (- pDesklet->fDepthRotationY / G_PI * 180., 0., 1., 0.);
+		_matrix_rotate (m, - pDesklet->fDepthRotationY, 0., 1., 0.);
 	}
 	
 	if (fDepthRotationX != 0)
 	{
-		glRotatef (- pDesklet->fDepthRotationX / G_PI * 180., 1., 0., 0.);
+		_matrix_rotate (m, - pDesklet->fDepthRotationX, 1., 0., 0.);
 	}
 }
 
+static inline void _set_desklet_matrix (CairoDesklet *pDesklet)
+{
+	double m[16];
+	_compute_desklet_matrix (pDesklet, m);  // computed on our side, so that the picking can use it too.
+	glMultMatrixd (m);
+}
+
 static void _render_desklet_opengl (CairoDesklet *pDesklet)
 {
 	gboolean bUseDefaultColors = pDesklet->bUseDefaultColors;
@@ -464,6 +517,7 @@ static gboolean _on_update_desklet_notification (G_GNUC_UNUSED gpointer data, Ca
 	return GLDI_NOTIFICATION_LET_PASS;
 }
 
+// old-style picking, for the desklets and renderers that still draw their bounding boxes instead of defining hit shapes.
 static Icon *_cairo_dock_pick_icon_on_opengl_desklet (CairoDesklet *pDesklet)
 {
 	GLuint selectBuf[4];
@@ -511,57 +565,10 @@ static Icon *_cairo_dock_pick_icon_on_opengl_desklet (CairoDesklet *pDesklet)
 	{
 		pDesklet->render_bounding_box (pDesklet);
 	}
-	else if (pDesklet->pRenderer && pDesklet->pRenderer->render_bounding_box != NULL)
+	else
 	{
 		pDesklet->pRenderer->render_bounding_box (pDesklet);
 	}
-	else  // on le fait nous-memes a partir des coordonnees des icones.
-	{
-		glTranslatef (-pDesklet->container.iWidth/2, -pDesklet->container.iHeight/2, 0.);
-		
-		double x, y, w, h;
-		Icon *pIcon;
-		
-		pIcon = pDesklet->pIcon;
-		if (pIcon != NULL && pIcon->image.iTexture != 0)
-		{
-			w = pIcon->fWidth/2;
-			h = pIcon->fHeight/2;
-			x = pIcon->fDrawX + w;
-			y = pDesklet->container.iHeight - pIcon->fDrawY - h;
-			
-			glLoadName(pIcon->image.iTexture);
-			
-			glBegin(GL_QUADS);
-			glVertex3f(x-w, y+h, 0.);
-			glVertex3f(x+w, y+h, 0.);
-			glVertex3f(x+w, y-h, 0.);
-			glVertex3f(x-w, y-h, 0.);
-			glEnd();
-		}
-		
-		GList *ic;
-		for (ic = pDesklet->icons; ic != NULL; ic = ic->next)
-		{
-			pIcon = ic->data;
-			if (pIcon->image.iTexture == 0)
-				continue;
-			
-			w = pIcon->fWidth/2;
-			h = pIcon->fHeight/2;
-			x = pIcon->fDrawX + w;
-			y = pDesklet->container.iHeight - pIcon->fDrawY - h;
-			
-			glLoadName(pIcon->image.iTexture);
-			
-			glBegin(GL_QUADS);
-			glVertex3f(x-w, y+h, 0.);
-			glVertex3f(x+w, y+h, 0.);
-			glVertex3f(x+w, y-h, 0.);
-			glVertex3f(x-w, y-h, 0.);
-			glEnd();
-		}
-	}
 	
 	glPopName();
 	
@@ -613,58 +620,186 @@ static Icon *_cairo_dock_pick_icon_on_opengl_desklet (CairoDesklet *pDesklet)
 	
 	return pFoundIcon;
 }
-Icon *gldi_desklet_find_clicked_icon (CairoDesklet *pDesklet)
+
+static inline void _cross (const double *a, const double *b, double *c)
+{
+	c[0] = a[1] * b[2] - a[2] * b[1];
+	c[1] = a[2] * b[0] - a[0] * b[2];
+	c[2] = a[0] * b[1] - a[1] * b[0];
+}
+#define _dot(a, b) ((a)[0] * (b)[0] + (a)[1] * (b)[1] + (a)[2] * (b)[2])
+
+// intersection of the ray (o,d) with the triangle (p0,p1,p2); *s is the position on the ray (Moller-Trumbore).
+static gboolean _intersect_triangle (const double *o, const double *d, const double *p0, const double *p1, const double *p2, double *s)
 {
-	if (g_bUseOpenGL && pDesklet->pRenderer && pDesklet->pRenderer->render_opengl)
+	double e1[3], e2[3], p[3], q[3], tv[3];
+	int i;
+	for (i = 0; i < 3; i ++)
 	{
-		return _cairo_dock_pick_icon_on_opengl_desklet (pDesklet);
+		e1[i] = p1[i] - p0[i];
+		e2[i] = p2[i] - p0[i];
+		tv[i] = o[i] - p0[i];
 	}
-	
-	int iMouseX = pDesklet->container.iMouseX, iMouseY = pDesklet->container.iMouseY;
-	if (fabs (pDesklet->fRotation) > ANGLE_MIN)
+	_cross (d, e2, p);
+	double det = _dot (e1, p);
+	if (fabs (det) < 1e-9)  // the ray is parallel to the triangle.
+		return FALSE;
+	double u = _dot (tv, p) / det;
+	if (u < -1e-6 || u > 1. + 1e-6)  // a small tolerance, so that the diagonal of a quad doesn't fall between its 2 triangles.
+		return FALSE;
+	_cross (tv, e1, q);
+	double v = _dot (d, q) / det;
+	if (v < -1e-6 || u + v > 1. + 1e-6)
+		return FALSE;
+	*s = _dot (e2, q) / det;
+	return TRUE;
+}
+
+static CairoDeskletHitShape *_pick_hit_shape (CairoDesklet *pDesklet, const double *m, const double *o, const double *d)
+{
+	CairoDeskletHitShape *pShape, *pBestShape = NULL;
+	double v[12], s, fBestPosition = 0.;
+	guint i;
+	int k;
+	for (i = 0; i < pDesklet->pHitShapes->len; i ++)
 	{
-		//g_print (" clic en (%d;%d) rotations : %.2frad\n", iMouseX, iMouseY, pDesklet->fRotation);
-		double x, y;  // par rapport au centre du desklet.
-		x = iMouseX - pDesklet->container.iWidth/2;
-		y = pDesklet->container.iHeight/2 - iMouseY;
-		
-		double r, t;  // coordonnees polaires.
-		r = sqrt (x*x + y*y);
-		t = atan2 (y, x);
-		
-		double z = _compute_zoom_for_rotation (pDesklet);
-		r /= z;
-		
-		x = r * cos (t + pDesklet->fRotation);  // la rotation de cairo est dans le sene horaire.
-		y = r * sin (t + pDesklet->fRotation);
-		
-		iMouseX = x + pDesklet->container.iWidth/2;
-		iMouseY = pDesklet->container.iHeight/2 - y;
-		//g_print (" => (%d;%d)\n", iMouseX, iMouseY);
+		pShape = &g_array_index (pDesklet->pHitShapes, CairoDeskletHitShape, i);
+		for (k = 0; k < 4; k ++)
+			_matrix_transform_point (m, &pShape->pVertices[3*k], &v[3*k]);
+		if ((_intersect_triangle (o, d, &v[0], &v[3], &v[6], &s) || _intersect_triangle (o, d, &v[0], &v[6], &v[9], &s))
+		&& (pBestShape == NULL || s < fBestPosition))  // keep the nearest shape, or the first one if several are at the same depth.
+		{
+			pBestShape = pShape;
+			fBestPosition = s;
+		}
 	}
-	pDesklet->iMouseX2d = iMouseX;
-	pDesklet->iMouseY2d = iMouseY;
+	return pBestShape;
+}
+
+static inline void _add_icon_hit_shape (CairoDesklet *pDesklet, Icon *pIcon)
+{
+	double w = pIcon->fWidth * pIcon->fScale, h = pIcon->fHeight * pIcon->fScale;
+	gldi_desklet_add_hit_rectangle (pDesklet,
+		pIcon->fDrawX + w/2 - pDesklet->container.iWidth/2.,
+		pDesklet->container.iHeight/2. - pIcon->fDrawY - h/2,
+		w,
+		h,
+		pIcon,
+		0);
+}
+
+static void _add_icons_hit_shapes (CairoDesklet *pDesklet)
+{
+	g_return_if_fail (pDesklet->pIcon != NULL);  // peut arriver au tout debut, car on associe l'icone au desklet _apres_ l'avoir cree, et on fait tourner la gtk_main entre-temps (pour le redessiner invisible).
+	_add_icon_hit_shape (pDesklet, pDesklet->pIcon);
 	
-	Icon *icon = pDesklet->pIcon;
-	g_return_val_if_fail (icon != NULL, NULL);  // peut arriver au tout debut, car on associe l'icone au desklet _apres_ l'avoir cree, et on fait tourner la gtk_main entre-temps (pour le redessiner invisible).
-	if (icon->fDrawX < iMouseX && icon->fDrawX + icon->fWidth * icon->fScale > iMouseX && icon->fDrawY < iMouseY && icon->fDrawY + icon->fHeight * icon->fScale > iMouseY)
+	GList* ic;
+	for (ic = pDesklet->icons; ic != NULL; ic = ic->next)
 	{
-		return icon;
+		_add_icon_hit_shape (pDesklet, ic->data);
 	}
+}
+
+Icon *gldi_desklet_find_clicked_icon (CairoDesklet *pDesklet)
+{
+	gboolean bOpenGL = (g_bUseOpenGL && pDesklet->pRenderer && pDesklet->pRenderer->render_opengl);
+	CairoDeskletRenderer *pRenderer = pDesklet->pRenderer;
 	
-	if (pDesklet->icons != NULL)
+	//\_______________ On recupere les formes des icones.
+	if (pDesklet->pHitShapes == NULL)
+		pDesklet->pHitShapes = g_array_new (FALSE, FALSE, sizeof (CairoDeskletHitShape));
+	else
+		g_array_set_size (pDesklet->pHitShapes, 0);
+	if (pDesklet->get_hit_shapes != NULL)  // surclasse la fonction du moteur de rendu.
+		pDesklet->get_hit_shapes (pDesklet);
+	else if (pDesklet->render_bounding_box != NULL && bOpenGL)  // old-style picking, with the bounding boxes drawn in OpenGL.
+		return _cairo_dock_pick_icon_on_opengl_desklet (pDesklet);
+	else if (pRenderer && pRenderer->get_hit_shapes != NULL)
+		pRenderer->get_hit_shapes (pDesklet);
+	else if (pRenderer && pRenderer->render_bounding_box != NULL && bOpenGL)
+		return _cairo_dock_pick_icon_on_opengl_desklet (pDesklet);
+	else  // on le fait nous-memes a partir des coordonnees des icones.
+		_add_icons_hit_shapes (pDesklet);
+	
+	//\_______________ On lance un rayon depuis le pointeur.
+	double m[16] = {1., 0., 0., 0.,  0., 1., 0., 0.,  0., 0., 1., 0.,  0., 0., 0., 1.};
+	double o[3] = {0., 0., 0.}, d[3] = {0., 0., -1.};
+	int iMouseX = pDesklet->container.iMouseX, iMouseY = pDesklet->container.iMouseY;
+	if (bOpenGL)
 	{
-		GList* ic;
-		for (ic = pDesklet->icons; ic != NULL; ic = ic->next)
+		// from the camera, with the same transformations as the rendering.
+		_compute_desklet_matrix (pDesklet, m);
+		if (pDesklet->iLeftSurfaceOffset != 0 || pDesklet->iTopSurfaceOffset != 0 || pDesklet->iRightSurfaceOffset != 0 || pDesklet->iBottomSurfaceOffset != 0)
 		{
-			icon = ic->data;
-			if (icon->fDrawX < iMouseX && icon->fDrawX + icon->fWidth * icon->fScale > iMouseX && icon->fDrawY < iMouseY && icon->fDrawY + icon->fHeight * icon->fScale > iMouseY)
-			{
-				return icon;
-			}
+			_matrix_translate (m, (pDesklet->iLeftSurfaceOffset - pDesklet->iRightSurfaceOffset)/2, (pDesklet->iBottomSurfaceOffset - pDesklet->iTopSurfaceOffset)/2, 0.);
+			_matrix_scale (m, 1. - (double)(pDesklet->iLeftSurfaceOffset + pDesklet->iRightSurfaceOffset) / pDesklet->container.iWidth,
+				1. - (double)(pDesklet->iTopSurfaceOffset + pDesklet->iBottomSurfaceOffset) / pDesklet->container.iHeight,
+				1.);
 		}
+		double fAspect = (double)pDesklet->container.iWidth / pDesklet->container.iHeight;
+		d[0] = (2. * iMouseX / pDesklet->container.iWidth - 1.) * fAspect / sqrt (3);  // 60 deg of perspective, so the half-height is seen under tan(30deg) = 1/sqrt(3).
+		d[1] = (1. - 2. * iMouseY / pDesklet->container.iHeight) / sqrt (3);
 	}
-	return NULL;
+	else
+	{
+		if (fabs (pDesklet->fRotation) > ANGLE_MIN)
+		{
+			//g_print (" clic en (%d;%d) rotations : %.2frad\n", iMouseX, iMouseY, pDesklet->fRotation);
+			double x, y;  // par rapport au centre du desklet.
+			x = iMouseX - pDesklet->container.iWidth/2;
+			y = pDesklet->container.iHeight/2 - iMouseY;
+			
+			double r, t;  // coordonnees polaires.
+			r = sqrt (x*x + y*y);
+			t = atan2 (y, x);
+			
+			double z = _compute_zoom_for_rotation (pDesklet);
+			r /= z;
+			
+			x = r * cos (t + pDesklet->fRotation);  // la rotation de cairo est dans le sene horaire.
+			y = r * sin (t + pDesklet->fRotation);
+			
+			iMouseX = x + pDesklet->container.iWidth/2;
+			iMouseY = pDesklet->container.iHeight/2 - y;
+			//g_print (" => (%d;%d)\n", iMouseX, iMouseY);
+		}
+		pDesklet->iMouseX2d = iMouseX;
+		pDesklet->iMouseY2d = iMouseY;
+		
+		// straight from the pointer, in the frame of the shapes.
+		o[0] = iMouseX - pDesklet->container.iWidth/2.;
+		o[1] = pDesklet->container.iHeight/2. - iMouseY;
+	}
+	
+	pDesklet->iPickedObject = 0;
+	CairoDeskletHitShape *pShape = _pick_hit_shape (pDesklet, m, o, d);
+	if (pShape == NULL)
+		return NULL;
+	pDesklet->iPickedObject = pShape->iObject;
+	return (pShape->pIcon != NULL ? pShape->pIcon : pDesklet->pIcon);  // il faut renvoyer qqch pour un objet, sinon la notification est filtree par la macro CD_APPLET_ON_CLICK_BEGIN.
+}
+
+void gldi_desklet_add_hit_shape (CairoDesklet *pDesklet, const gdouble *pVertices, Icon *pIcon, GLuint iObject)
+{
+	g_return_if_fail (pDesklet != NULL && pVertices != NULL);
+	if (pDesklet->pHitShapes == NULL)
+		pDesklet->pHitShapes = g_array_new (FALSE, FALSE, sizeof (CairoDeskletHitShape));
+	CairoDeskletHitShape shape;
+	memcpy (shape.pVertices, pVertices, sizeof (shape.pVertices));
+	shape.pIcon = pIcon;
+	shape.iObject = iObject;
+	g_array_append_val (pDesklet->pHitShapes, shape);
+}
+
+void gldi_desklet_add_hit_rectangle (CairoDesklet *pDesklet, double fCenterX, double fCenterY, double fWidth, double fHeight, Icon *pIcon, GLuint iObject)
+{
+	double w = fWidth/2, h = fHeight/2;
+	gdouble pVertices[12] = {
+		fCenterX - w, fCenterY + h, 0.,
+		fCenterX + w, fCenterY + h, 0.,
+		fCenterX + w, fCenterY - h, 0.,
+		fCenterX - w, fCenterY - h, 0.};
+	gldi_desklet_add_hit_shape (pDesklet, pVertices, pIcon, iObject);
 }
 
 
@@ -1053,6 +1188,9 @@ static void reset_object (GldiObject *obj)
 	cairo_dock_unload_image_buffer (&pDesklet->backGroundImageBuffer);
 	cairo_dock_unload_image_buffer (&pDesklet->foreGroundImageBuffer);
 	
+	if (pDesklet->pHitShapes != NULL)
+		g_array_free (pDesklet->pHitShapes, TRUE);
+	
 	// unregister the desklet
 	s_pDeskletList = g_list_remove (s_pDeskletList, pDesklet);
 }
@@ -101,6 +101,25 @@ gboolean gldi_desklet_manager_is_ready (void);  // internals for the factory
 
 Icon *gldi_desklet_find_clicked_icon (CairoDesklet *pDesklet);  // internals for the factory; placed here because it uses the same code as the rendering
 
+/** Add a shape that can be picked on a desklet. It is meant to be called from the get_hit_shapes function of a desklet or of its renderer.
+*@param pDesklet the desklet.
+*@param pVertices the 4 corners (x,y,z) of the shape, in order around it, in the frame where the renderer draws with OpenGL (origin at the center of the desklet, Y upward).
+*@param pIcon the icon picked with this shape, or NULL for the main icon.
+*@param iObject ID of the object picked with this shape, or 0.
+*/
+void gldi_desklet_add_hit_shape (CairoDesklet *pDesklet, const gdouble *pVertices, Icon *pIcon, GLuint iObject);
+
+/** Add a rectangle that can be picked on a desklet, in the plane of the desklet. See #gldi_desklet_add_hit_shape.
+*@param pDesklet the desklet.
+*@param fCenterX X coordinate of the center of the rectangle, from the center of the desklet.
+*@param fCenterY Y coordinate of the center of the rectangle, from the center of the desklet, upward.
+*@param fWidth width of the rectangle.
+*@param fHeight height of the rectangle.
+*@param pIcon the icon picked with this shape, or NULL for the main icon.
+*@param iObject ID of the object picked with this shape, or 0.
+*/
+void gldi_desklet_add_hit_rectangle (CairoDesklet *pDesklet, double fCenterX, double fCenterY, double fWidth, double fHeight, Icon *pIcon, GLuint iObject);
+
 
 void gldi_register_desklets_manager (void);
 
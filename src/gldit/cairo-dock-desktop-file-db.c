@@ -19,128 +19,459 @@
 
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <gio/gio.h>
 #include <gmodule.h>
 #include "cairo-dock-desktop-file-db.h"
 #include "cairo-dock-class-manager-priv.h" // cairo_dock_guess_class
 #include "cairo-dock-log.h" // cd_error
 
+#define DESKTOP_DB_SNAPSHOT_VERSION 1
+
 static GAppInfoMonitor *monitor = NULL;
+static GFileMonitor **dir_monitors = NULL; // one monitor per applications folder
+static gchar **data_dirs = NULL; // applications folders, by decreasing precedence
+
+typedef struct _desktop_entry {
+	char *id; // desktop file ID, lowercase and without the extension
+	char *alt_id; // class guessed from the StartupWMClass and Exec keys, or NULL
+	char *filename; // full path of the .desktop file
+	int dir; // index of the folder it belongs to in data_dirs (lower wins if several files have the same ID)
+	gboolean hidden; // Hidden=true, the app is masked
+	GDesktopAppInfo *app; // NULL until it is looked up if the entry comes from the snapshot
+} desktop_entry;
 
 typedef struct _desktop_db {
-	// hash tables store GDesktopAppInfo
-	GHashTable *class_table; // main table mapping desktop file IDs (without the extension)
-	GHashTable *alt_class_table; // alternative mapping based on the StartupWMClass (if exists)
+	GHashTable *files; // filename -> desktop_entry, for all the .desktop files found (including masked ones)
+	GHashTable *class_table; // main table: desktop file ID -> list of entries sorted by precedence (the first one is used)
+	GHashTable *alt_class_table; // alternative mapping based on the StartupWMClass / Exec: alt ID -> list of entries
 } desktop_db;
 
-static desktop_db *db_current = NULL; // current database (used for lookups)
-static desktop_db *db_pending = NULL; // pending database (created by our worker thread)
+static desktop_db *db = NULL; // current database, accessed with the mutex held
 
-static GMutex mutex; // mutex for accessing db_pending
-static GCond cond; // condition to signal that db_pending has been updated (only used if db_current == NULL)
+static GMutex mutex; // mutex for accessing db and the pending work
+static GCond cond; // condition to signal that db has been created (only used if we had no snapshot)
 static GThread *thread = NULL; // our worker thread
+static GSList *removed_apps = NULL; // apps of entries removed by the worker, kept until the next lookup
 
 static gboolean update_pending = FALSE; // update of apps is already pending
-static gboolean more_work = FALSE; // more work to do for the worker thread (apps on the system have changed)
+static gboolean full_scan = FALSE; // the worker has to rescan all the folders
+static GHashTable *pending_files = NULL; // files that have changed since the last update (filename -> index of their folder + 1)
+static gboolean *rescan_dirs = NULL; // folders to rescan entirely, because their monitor couldn't tell which files have changed
+static gboolean *unwatched_dirs = NULL; // folders whose changes our monitors may miss (no monitor, or legacy sub-folders), rescanned when GIO reports a change
+static gint generation = 0; // hash of the content of the DB, as written in the snapshot
 static gboolean thread_running = FALSE; // worker thread is running (doing work updating the app DB; set to TRUE in _start_thread())
-static gboolean error = FALSE; // set if the worker cannot retrieve apps
 
-static void _desktop_db_free (desktop_db *db)
+
+  /////////////////
+ /// DATABASE ///
+/////////////////
+
+static void _desktop_entry_free (desktop_entry *e)
 {
-	if (db)
+	// the app may still be used by the caller of the last lookup, so it is released at the next one.
+	if (e->app) removed_apps = g_slist_prepend (removed_apps, e->app);
+	g_free (e->id);
+	g_free (e->alt_id);
+	g_free (e->filename);
+	g_free (e);
+}
+
+static desktop_db *_desktop_db_new (void)
+{
+	desktop_db *pDb = g_new0 (desktop_db, 1);
+	pDb->files = g_hash_table_new_full (g_str_hash, g_str_equal,
+		NULL, (GDestroyNotify)_desktop_entry_free); // the key belongs to the entry
+	// lists are modified in place, so they are freed by hand
+	pDb->class_table = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, NULL);
+	pDb->alt_class_table = g_hash_table_new_full (g_str_hash, g_str_equal,
+		g_free, NULL);
+	return pDb;
+}
+
+static void _free_lists (GHashTable *pTable)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, pTable);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_slist_free (value);
+}
+
+static void _desktop_db_free (desktop_db *pDb)
+{
+	if (pDb)
 	{
-		if (db->alt_class_table) g_hash_table_unref(db->alt_class_table);
-		if (db->class_table) g_hash_table_unref(db->class_table);
-		g_free (db);
+		_free_lists (pDb->alt_class_table);
+		_free_lists (pDb->class_table);
+		g_hash_table_unref (pDb->alt_class_table);
+		g_hash_table_unref (pDb->class_table);
+		g_hash_table_unref (pDb->files);
+		g_free (pDb);
 	}
 }
 
-static void _process_app (gpointer data, gpointer user_data)
+static gint _compare_precedence (gconstpointer a, gconstpointer b)
+{
+	return ((desktop_entry*)a)->dir - ((desktop_entry*)b)->dir;
+}
+
+static void _set_list (GHashTable *pTable, const char *key, GSList *pList)
+{
+	// the old list has been modified in place, only its head may have changed
+	if (pList) g_hash_table_insert (pTable, g_strdup (key), pList);
+	else g_hash_table_remove (pTable, key);
+}
+
+static void _alt_add (desktop_db *pDb, desktop_entry *e)
+{
+	if (!e || !e->alt_id || e->hidden) return;
+	GSList *pList = g_hash_table_lookup (pDb->alt_class_table, e->alt_id);
+	pList = g_slist_append (pList, e);
+	_set_list (pDb->alt_class_table, e->alt_id, pList);
+}
+
+static void _alt_remove (desktop_db *pDb, desktop_entry *e)
 {
-	if (!data) return;
-	desktop_db *db = (desktop_db*)user_data;
-	GAppInfo *app = (GAppInfo*)data;
-	const char *id = g_app_info_get_id (app);
-	if (!id) return;
+	if (!e || !e->alt_id || e->hidden) return;
+	GSList *pList = g_hash_table_lookup (pDb->alt_class_table, e->alt_id);
+	if (!pList) return;
+	pList = g_slist_remove (pList, e);
+	_set_list (pDb->alt_class_table, e->alt_id, pList);
+}
+
+static void _db_remove_file (desktop_db *pDb, const char *filename)
+{
+	desktop_entry *e = g_hash_table_lookup (pDb->files, filename);
+	if (!e) return;
+	
+	GSList *pList = g_hash_table_lookup (pDb->class_table, e->id);
+	gboolean bWasFirst = (pList && pList->data == e);
+	pList = g_slist_remove (pList, e);
+	_set_list (pDb->class_table, e->id, pList);
+	if (bWasFirst)
+	{
+		// the next file with the same ID (if any) is now unmasked
+		_alt_remove (pDb, e);
+		if (pList) _alt_add (pDb, pList->data);
+	}
 	
-	GDesktopAppInfo *desktop_app = G_DESKTOP_APP_INFO(app);
-	if (!desktop_app) return;
+	g_hash_table_remove (pDb->files, e->filename); // frees e
+}
+
+static void _db_add_entry (desktop_db *pDb, desktop_entry *e)
+{
+	_db_remove_file (pDb, e->filename);
+	g_hash_table_insert (pDb->files, e->filename, e);
 	
-	const char *fn = g_desktop_app_info_get_filename (desktop_app);
-	if (!fn) return;
+	GSList *pList = g_hash_table_lookup (pDb->class_table, e->id);
+	desktop_entry *pPrevFirst = (pList ? pList->data : NULL);
+	pList = g_slist_insert_sorted (pList, e, _compare_precedence); // keeps the first one found on ties
+	_set_list (pDb->class_table, e->id, pList);
+	if (pList->data != pPrevFirst)
+	{
+		_alt_remove (pDb, pPrevFirst);
+		_alt_add (pDb, e);
+	}
+}
+
+static desktop_entry *_read_desktop_file (const char *filename, const char *desktop_id, int dir)
+{
+	GDesktopAppInfo *app = g_desktop_app_info_new_from_filename (filename);
+	if (!app) return NULL; // not an app, or its TryExec is missing
 	
-	const char *wmclass = g_desktop_app_info_get_startup_wm_class (desktop_app);
-	const char *cmdline = g_app_info_get_commandline (app);
+	desktop_entry *e = g_new0 (desktop_entry, 1);
+	e->filename = g_strdup (filename);
+	e->dir = dir;
+	e->app = app;
+	e->hidden = g_desktop_app_info_get_is_hidden (app);
 	
 	// process ID: make it lowercase and remove .desktop extension
-	char *id_lower = NULL;
-	const char *tmp = strrchr (id, '.');
+	const char *tmp = strrchr (desktop_id, '.');
 	if (tmp && !strcmp(tmp, ".desktop"))
-		id_lower = g_ascii_strdown (id, tmp - id);
-	else id_lower = g_ascii_strdown (id, -1);
+		e->id = g_ascii_strdown (desktop_id, tmp - desktop_id);
+	else e->id = g_ascii_strdown (desktop_id, -1);
 	
-	// check if this ID exists (desktop file names should be unique, so there is no use adding in that case)
-	if (g_hash_table_contains (db->class_table, id_lower))
+	if (!e->hidden)
 	{
-		g_free (id_lower);
-		return;
+		// process commandline and / or wm class (note: this will always return lower case as well)
+		const char *wmclass = g_desktop_app_info_get_startup_wm_class (app);
+		const char *cmdline = g_app_info_get_commandline (G_APP_INFO (app));
+		e->alt_id = cairo_dock_guess_class (cmdline, wmclass);
+		if (e->alt_id && !strcmp (e->alt_id, e->id))
+		{
+			g_free (e->alt_id);
+			e->alt_id = NULL;
+		}
 	}
+	return e;
+}
+
+static void _scan_dir (desktop_db *pDb, const char *cDirPath, const char *cPrefix, int iDir)
+{
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (!dir) return;
 	
-	// add the app ID to the (main) hash table
-	g_object_ref (desktop_app);
-	g_hash_table_insert (db->class_table, id_lower, desktop_app);
+	const gchar *cName;
+	while ((cName = g_dir_read_name (dir)) != NULL)
+	{
+		gchar *cPath = g_build_filename (cDirPath, cName, NULL);
+		gchar *cId = (cPrefix ? g_strconcat (cPrefix, cName, NULL) : g_strdup (cName));
+		if (g_str_has_suffix (cName, ".desktop"))
+		{
+			desktop_entry *e = _read_desktop_file (cPath, cId, iDir);
+			if (e) _db_add_entry (pDb, e);
+		}
+		else if (g_file_test (cPath, G_FILE_TEST_IS_DIR)) // legacy sub-folders: kde4/foo.desktop has the ID kde4-foo.desktop
+		{
+			g_mutex_lock (&mutex);
+			unwatched_dirs[iDir] = TRUE; // our monitors don't see inside
+			g_mutex_unlock (&mutex);
+			gchar *cSubPrefix = g_strconcat (cId, "-", NULL);
+			_scan_dir (pDb, cPath, cSubPrefix, iDir);
+			g_free (cSubPrefix);
+		}
+		g_free (cId);
+		g_free (cPath);
+	}
+	g_dir_close (dir);
+}
+
+static desktop_db *_scan_all (void)
+{
+	desktop_db *pDb = _desktop_db_new ();
+	int i;
+	for (i = 0; data_dirs[i] != NULL; i++)
+		_scan_dir (pDb, data_dirs[i], NULL, i);
+	return pDb;
+}
+
+static void _rescan_dir (int iDir)
+{
+	// read the folder first, without holding the lock
+	desktop_db *pDirDb = _desktop_db_new ();
+	_scan_dir (pDirDb, data_dirs[iDir], NULL, iDir);
+	GList *pEntries = g_hash_table_get_values (pDirDb->files);
+	g_hash_table_steal_all (pDirDb->files);
+	_desktop_db_free (pDirDb);
 	
-	// process commandline and / or wm class (note: this will always return lower case as well)
-	char *alt_id = cairo_dock_guess_class (cmdline, wmclass);
-	if (!alt_id) return;
-	if (!strcmp (alt_id, id_lower))
+	// then replace the entries of this folder
+	g_mutex_lock (&mutex);
+	GSList *pRemoved = NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, db->files);
+	while (g_hash_table_iter_next (&iter, &key, &value))
 	{
-		g_free (alt_id);
-		return;
+		desktop_entry *e = value;
+		if (e->dir == iDir)
+			pRemoved = g_slist_prepend (pRemoved, g_strdup (e->filename));
+	}
+	GSList *r;
+	for (r = pRemoved; r != NULL; r = r->next)
+		_db_remove_file (db, r->data);
+	GList *l;
+	for (l = pEntries; l != NULL; l = l->next)
+		_db_add_entry (db, l->data);
+	g_mutex_unlock (&mutex);
+	g_slist_free_full (pRemoved, g_free);
+	g_list_free (pEntries);
+}
+
+static void _update_files (GHashTable *pFiles)
+{
+	// read the files first, without holding the lock
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, pFiles);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		const char *filename = key;
+		int iDir = GPOINTER_TO_INT (value) - 1;
+		desktop_entry *e = NULL;
+		if (g_file_test (filename, G_FILE_TEST_EXISTS))
+		{
+			gchar *cId = g_strdup (filename + strlen (data_dirs[iDir]) + 1);
+			g_strdelimit (cId, "/", '-');
+			e = _read_desktop_file (filename, cId, iDir);
+			g_free (cId);
+		}
+		g_hash_table_iter_replace (&iter, e);
 	}
 	
-	// only add the alternate ID if it does not exist yet
-	if (g_hash_table_contains (db->class_table, alt_id) || g_hash_table_contains(db->alt_class_table, alt_id))
+	// then apply the changes
+	g_mutex_lock (&mutex);
+	g_hash_table_iter_init (&iter, pFiles);
+	while (g_hash_table_iter_next (&iter, &key, &value))
 	{
-		g_free (alt_id);
-		return;
+		if (value) _db_add_entry (db, value);
+		else _db_remove_file (db, key);
+	}
+	g_mutex_unlock (&mutex);
+}
+
+
+  /////////////////
+ /// SNAPSHOT ///
+/////////////////
+
+static gchar *_get_snapshot_path (void)
+{
+	return g_build_filename (g_get_user_cache_dir (), "cairo-dock", "desktop-file-db", NULL);
+}
+
+static gchar *_get_snapshot_header (void)
+{
+	// the snapshot is only valid for the same set of folders
+	gchar *cDirs = g_strjoinv (":", data_dirs);
+	gchar *cHeader = g_strdup_printf ("cairo-dock-desktop-file-db %d %s", DESKTOP_DB_SNAPSHOT_VERSION, cDirs);
+	g_free (cDirs);
+	return cHeader;
+}
+
+static gint _compare_lines (gconstpointer a, gconstpointer b)
+{
+	return strcmp (*(const gchar**)a, *(const gchar**)b);
+}
+
+static void _save_snapshot (void)
+{
+	// one line per file: folder, hidden, ID, alt ID, filename
+	GPtrArray *pLines = g_ptr_array_new_with_free_func (g_free);
+	g_mutex_lock (&mutex);
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, db->files);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		desktop_entry *e = value;
+		if (strpbrk (e->filename, "\t\n") || strpbrk (e->id, "\t\n") || (e->alt_id && strpbrk (e->alt_id, "\t\n")))
+			continue;
+		g_ptr_array_add (pLines, g_strdup_printf ("%d\t%d\t%s\t%s\t%s\n", e->dir, e->hidden ? 1 : 0, e->id, e->alt_id ? e->alt_id : "", e->filename));
 	}
-	g_object_ref (desktop_app);
-	g_hash_table_insert (db->alt_class_table, alt_id, desktop_app);
+	g_mutex_unlock (&mutex);
+	
+	// sort the lines, so that the same DB always gives the same content, and thus the same generation
+	g_ptr_array_sort (pLines, _compare_lines);
+	GString *sBody = g_string_new ("");
+	guint i;
+	for (i = 0; i < pLines->len; i++)
+		g_string_append (sBody, g_ptr_array_index (pLines, i));
+	g_ptr_array_free (pLines, TRUE);
+	
+	guint iGeneration = g_str_hash (sBody->str);
+	if ((guint)g_atomic_int_get (&generation) != iGeneration)  // something has changed
+	{
+		g_atomic_int_set (&generation, iGeneration);
+		
+		gchar *cHeader = _get_snapshot_header ();
+		gchar *cContent = g_strconcat (cHeader, "\n", sBody->str, NULL);
+		gchar *cPath = _get_snapshot_path ();
+		gchar *cDir = g_path_get_dirname (cPath);
+		g_mkdir_with_parents (cDir, 7*8*8+7*8+5);
+		GError *erreur = NULL;
+		if (!g_file_set_contents (cPath, cContent, -1, &erreur))
+		{
+			cd_warning ("couldn't save the apps database: %s", erreur->message);
+			g_error_free (erreur);
+		}
+		g_free (cDir);
+		g_free (cPath);
+		g_free (cContent);
+		g_free (cHeader);
+	}
+	g_string_free (sBody, TRUE);
 }
 
+static desktop_db *_load_snapshot (void)
+{
+	gchar *cPath = _get_snapshot_path ();
+	gchar *cContent = NULL;
+	gboolean bRead = g_file_get_contents (cPath, &cContent, NULL, NULL);
+	g_free (cPath);
+	if (!bRead) return NULL;
+	
+	desktop_db *pDb = NULL;
+	gchar *cHeader = _get_snapshot_header ();
+	gchar *cBody = strchr (cContent, '\n');
+	if (cBody) *cBody = '\0';  // cut the header
+	if (cBody && strcmp (cContent, cHeader) == 0)
+	{
+		g_atomic_int_set (&generation, g_str_hash (cBody + 1));
+		int iNbDirs = g_strv_length (data_dirs);
+		pDb = _desktop_db_new ();
+		gchar **pLines = g_strsplit (cBody + 1, "\n", -1);
+		int i;
+		for (i = 0; pLines[i] != NULL; i++)
+		{
+			gchar **pFields = g_strsplit (pLines[i], "\t", 5);
+			if (g_strv_length (pFields) == 5)
+			{
+				desktop_entry *e = g_new0 (desktop_entry, 1);
+				e->dir = CLAMP (atoi (pFields[0]), 0, iNbDirs - 1);
+				e->hidden = (pFields[1][0] == '1');
+				e->id = g_strdup (pFields[2]);
+				e->alt_id = (*pFields[3] != '\0' ? g_strdup (pFields[3]) : NULL);
+				e->filename = g_strdup (pFields[4]);
+				_db_add_entry (pDb, e);
+			}
+			g_strfreev (pFields);
+		}
+		g_strfreev (pLines);
+	}
+	g_free (cContent);
+	g_free (cHeader);
+	return pDb;
+}
+
+
+  ///////////////
+ /// WORKER ///
+///////////////
+
 static gpointer _thread_func (G_GNUC_UNUSED gpointer ptr)
 {
 	while (1)
 	{
-		desktop_db *db = NULL;
-		GList *list = g_app_info_get_all ();
+		g_mutex_lock (&mutex);
+		gboolean bFullScan = (full_scan || db == NULL);
+		GHashTable *pFiles = pending_files;
+		pending_files = NULL;
+		full_scan = FALSE;
+		int i, n = g_strv_length (data_dirs);
+		gboolean *pRescanDirs = g_newa (gboolean, n);
+		memcpy (pRescanDirs, rescan_dirs, n * sizeof (gboolean));
+		memset (rescan_dirs, 0, n * sizeof (gboolean));
+		g_mutex_unlock (&mutex);
 		
-		if (list)
+		if (bFullScan)
 		{
-			db = g_malloc (sizeof(desktop_db));
-			db->class_table = g_hash_table_new_full (g_str_hash, g_str_equal,
-				g_free, g_object_unref);
-			db->alt_class_table = g_hash_table_new_full (g_str_hash, g_str_equal,
-				g_free, g_object_unref);
-			g_list_foreach (list, _process_app, db);
-			// note: apps added to the hash table were ref'd in _process_app ()
-			g_list_free_full (list, g_object_unref);
+			desktop_db *pDb = _scan_all ();
+			g_mutex_lock (&mutex);
+			_desktop_db_free (db);
+			db = pDb;
+			g_cond_broadcast (&cond);
+			g_mutex_unlock (&mutex);
 		}
-		
-		gboolean exit = TRUE;
-		g_mutex_lock (&mutex);
-		if (db)
+		else
 		{
-			_desktop_db_free (db_pending);
-			db_pending = db;
-			if (more_work) exit = FALSE;
+			for (i = 0; i < n; i++)
+				if (pRescanDirs[i]) _rescan_dir (i);
+			if (pFiles)
+				_update_files (pFiles); // a file may have changed again after the folder was read
 		}
-		else error = TRUE;
-		more_work = FALSE;
+		if (pFiles) g_hash_table_destroy (pFiles);
+		
+		_save_snapshot ();
+		
+		g_mutex_lock (&mutex);
+		gboolean exit = (!full_scan && !pending_files);
+		for (i = 0; i < n && exit; i++)
+			if (rescan_dirs[i]) exit = FALSE;
 		if (exit) thread_running = FALSE;
-		g_cond_signal (&cond);
 		g_mutex_unlock (&mutex);
 		if (exit) break;
 	}
@@ -152,8 +483,7 @@ static gboolean _start_thread (G_GNUC_UNUSED gpointer ptr)
 {
 	if (!update_pending) return FALSE;
 	g_mutex_lock (&mutex);
-	if (thread_running) more_work = TRUE;
-	else if (!error)
+	if (!thread_running)
 	{
 		if (thread) g_thread_join (thread);
 		thread_running = TRUE;
@@ -164,19 +494,159 @@ static gboolean _start_thread (G_GNUC_UNUSED gpointer ptr)
 	return FALSE; // needed to remove timeout
 }
 
-static void _on_apps_changed(G_GNUC_UNUSED GAppInfoMonitor* pMonitor, G_GNUC_UNUSED void* dummy) {
+static void _schedule_update (void)
+{
 	if(update_pending) return;
 	update_pending = TRUE;
 	g_timeout_add_seconds (5, _start_thread, NULL);
 }
 
+static void _on_apps_changed(G_GNUC_UNUSED GAppInfoMonitor* pMonitor, G_GNUC_UNUSED void* dummy) {
+	// GIO also reports changes we don't care about (e.g. mimeinfo.cache after each package install), and our monitors see the others;
+	// so only rescan the folders they can't fully see.
+	gboolean bRescan = FALSE;
+	g_mutex_lock (&mutex);
+	int i;
+	for (i = 0; data_dirs[i] != NULL; i++)
+	{
+		if (unwatched_dirs[i])
+		{
+			rescan_dirs[i] = TRUE;
+			bRescan = TRUE;
+		}
+	}
+	g_mutex_unlock (&mutex);
+	if (bRescan) _schedule_update ();
+}
+
+static gboolean _db_has_files_in (const char *cDirPath)
+{
+	gboolean bFound = FALSE;
+	gsize len = strlen (cDirPath);
+	g_mutex_lock (&mutex);
+	if (db)
+	{
+		GHashTableIter iter;
+		gpointer key;
+		g_hash_table_iter_init (&iter, db->files);
+		while (!bFound && g_hash_table_iter_next (&iter, &key, NULL))
+			bFound = (strncmp (key, cDirPath, len) == 0 && ((const char*)key)[len] == '/');
+	}
+	g_mutex_unlock (&mutex);
+	return bFound;
+}
+
+static void _on_dir_changed (G_GNUC_UNUSED GFileMonitor *pMonitor, GFile *pFile, G_GNUC_UNUSED GFile *pOtherFile, GFileMonitorEvent iEventType, gpointer data)
+{
+	int iDir = GPOINTER_TO_INT (data) - 1;
+	gboolean bRescanDir = FALSE;
+	switch (iEventType)
+	{
+		case G_FILE_MONITOR_EVENT_CHANGED:
+		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		case G_FILE_MONITOR_EVENT_DELETED:
+		case G_FILE_MONITOR_EVENT_CREATED:
+		break;
+		case G_FILE_MONITOR_EVENT_UNMOUNTED: // the monitor can't tell what has changed (GIO doesn't report the overflows of inotify as such)
+			bRescanDir = TRUE;
+		break;
+		default:
+		return;
+	}
+	gchar *cPath = g_file_get_path (pFile);
+	if (!bRescanDir && (!cPath || !g_str_has_suffix (cPath, ".desktop")))
+	{
+		// the folder itself, or a legacy sub-folder, has been created or removed: we don't know which files it holds
+		if (cPath && strcmp (cPath, data_dirs[iDir]) == 0)
+			bRescanDir = (iEventType == G_FILE_MONITOR_EVENT_CREATED || iEventType == G_FILE_MONITOR_EVENT_DELETED);
+		else if (cPath && iEventType == G_FILE_MONITOR_EVENT_CREATED)
+			bRescanDir = g_file_test (cPath, G_FILE_TEST_IS_DIR);
+		else if (cPath && iEventType == G_FILE_MONITOR_EVENT_DELETED) // it's gone, so only the DB can tell if it was a folder
+			bRescanDir = _db_has_files_in (cPath);
+		if (!bRescanDir)
+		{
+			g_free (cPath);
+			return;
+		}
+	}
+	
+	g_mutex_lock (&mutex);
+	if (bRescanDir)
+	{
+		rescan_dirs[iDir] = TRUE;
+		g_free (cPath);
+	}
+	else
+	{
+		if (!pending_files)
+			pending_files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		g_hash_table_insert (pending_files, cPath, data); // data = index of the folder + 1
+	}
+	g_mutex_unlock (&mutex);
+	_schedule_update ();
+}
+
+static void _init_data_dirs (void)
+{
+	// same order as g_app_info_get_all(): user folder first, then system folders
+	GPtrArray *pDirs = g_ptr_array_new ();
+	g_ptr_array_add (pDirs, g_build_filename (g_get_user_data_dir (), "applications", NULL));
+	const gchar * const *pSystemDirs = g_get_system_data_dirs ();
+	int i;
+	guint j;
+	for (i = 0; pSystemDirs[i] != NULL; i++)
+	{
+		gchar *cDir = g_build_filename (pSystemDirs[i], "applications", NULL);
+		for (j = 0; j < pDirs->len; j++)
+			if (strcmp (cDir, g_ptr_array_index (pDirs, j)) == 0)
+				break;
+		if (j < pDirs->len) g_free (cDir); // listed twice in XDG_DATA_DIRS
+		else g_ptr_array_add (pDirs, cDir);
+	}
+	rescan_dirs = g_new0 (gboolean, pDirs->len);
+	unwatched_dirs = g_new0 (gboolean, pDirs->len);
+	g_ptr_array_add (pDirs, NULL);
+	data_dirs = (gchar**)g_ptr_array_free (pDirs, FALSE);
+}
+
+static void _start_monitoring (void)
+{
+	int n = g_strv_length (data_dirs);
+	dir_monitors = g_new0 (GFileMonitor*, n + 1);
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		GFile *pFile = g_file_new_for_path (data_dirs[i]);
+		dir_monitors[i] = g_file_monitor_directory (pFile, G_FILE_MONITOR_NONE, NULL, NULL);
+		if (dir_monitors[i])
+			g_signal_connect (dir_monitors[i], "changed", G_CALLBACK (_on_dir_changed), GINT_TO_POINTER (i + 1));
+		else
+		{
+			g_mutex_lock (&mutex);
+			unwatched_dirs[i] = TRUE;
+			g_mutex_unlock (&mutex);
+		}
+		g_object_unref (pFile);
+	}
+	
+	// still listen to GIO, for the folders our monitors don't fully see
+	monitor = g_app_info_monitor_get();
+	g_signal_connect (monitor, "changed", G_CALLBACK(_on_apps_changed), NULL);
+}
+
 
 void gldi_desktop_file_db_init ()
 {
+	_init_data_dirs ();
+	
+	// load the last known state, so that lookups don't have to wait for the first scan
+	db = _load_snapshot ();
+	
+	// but rescan everything anyway, since apps may have changed while we were not running
+	full_scan = TRUE;
 	update_pending = TRUE;
 	_start_thread (NULL);
-	monitor = g_app_info_monitor_get();
-	g_signal_connect (monitor, "changed", G_CALLBACK(_on_apps_changed), NULL);
+	_start_monitoring ();
 }
 
 void gldi_desktop_file_db_stop (void)
@@ -186,10 +656,23 @@ void gldi_desktop_file_db_stop (void)
 		g_object_unref (monitor);
 		monitor = NULL;
 	}
+	if (dir_monitors)
+	{
+		int i;
+		for (i = 0; data_dirs[i] != NULL; i++)
+			if (dir_monitors[i]) g_object_unref (dir_monitors[i]);
+		g_free (dir_monitors);
+		dir_monitors = NULL;
+	}
 	update_pending = FALSE;
 	
 	g_mutex_lock (&mutex);
-	more_work = FALSE;
+	full_scan = FALSE;
+	if (pending_files)
+	{
+		g_hash_table_destroy (pending_files);
+		pending_files = NULL;
+	}
 	g_mutex_unlock (&mutex);
 	
 	if (thread)
@@ -197,52 +680,62 @@ void gldi_desktop_file_db_stop (void)
 		g_thread_join (thread);
 		thread = NULL;
 	}
-	_desktop_db_free (db_current);
-	_desktop_db_free (db_pending);
-	db_current = NULL;
-	db_pending = NULL;
-	error = FALSE;
+	_desktop_db_free (db);
+	db = NULL;
+	g_slist_free_full (removed_apps, g_object_unref);
+	removed_apps = NULL;
+	g_strfreev (data_dirs);
+	data_dirs = NULL;
+	g_free (rescan_dirs);
+	rescan_dirs = NULL;
+	g_free (unwatched_dirs);
+	unwatched_dirs = NULL;
+	g_atomic_int_set (&generation, 0);
+}
+
+guint gldi_desktop_file_db_get_generation (void)
+{
+	return (guint)g_atomic_int_get (&generation);
 }
 
 GDesktopAppInfo *gldi_desktop_file_db_lookup (const char *class, gboolean bOnlyDesktopID)
 {
-	if (!db_current || g_atomic_pointer_get (&db_pending))
+	g_mutex_lock (&mutex);
+	
+	// apps removed since the previous lookup are not used anymore
+	g_slist_free_full (removed_apps, g_object_unref);
+	removed_apps = NULL;
+	
+	if (!db)
 	{
-		// update db_current
-		g_mutex_lock (&mutex);
-		if (!db_pending)
+		// we had no snapshot, we have to wait for the thread (which should be running)
+		while (!db && thread_running)
+			g_cond_wait (&cond, &mutex);
+		if (!db)
 		{
-			// in this case db_current == NULL, we have to wait for the thread (which should be running)
-			if (!thread_running)
-			{
-				g_mutex_unlock (&mutex);
-				cd_error ("no worker thread!\n");
-				return NULL;
-			}
-			
-			while (!(db_pending || error))
-				g_cond_wait (&cond, &mutex);
-			
-			if (error)
-			{
-				g_mutex_unlock (&mutex);
-				cd_error ("cannot get app database!\n");
-				return NULL;
-			}
+			g_mutex_unlock (&mutex);
+			cd_error ("cannot get app database!\n");
+			return NULL;
 		}
-		
-		// here db_pending is valid, we have to swap with db_current
-		_desktop_db_free (db_current);
-		db_current = db_pending;
-		db_pending = NULL;
-		g_mutex_unlock (&mutex);
 	}
 	
-	void *tmp = g_hash_table_lookup (db_current->class_table, class);
-	if (!tmp && !bOnlyDesktopID) tmp = g_hash_table_lookup (db_current->alt_class_table, class);
+	desktop_entry *e = NULL;
+	GSList *pList = g_hash_table_lookup (db->class_table, class);
+	if (pList) e = pList->data; // the first one masks the others
+	if (e && e->hidden) e = NULL;
+	if (!e && !bOnlyDesktopID)
+	{
+		pList = g_hash_table_lookup (db->alt_class_table, class);
+		if (pList) e = pList->data;
+	}
+	
+	GDesktopAppInfo *app = NULL;
+	if (e)
+	{
+		if (!e->app) e->app = g_desktop_app_info_new_from_filename (e->filename); // entry loaded from the snapshot
+		app = e->app;
+	}
+	g_mutex_unlock (&mutex);
 	
-	return (GDesktopAppInfo*)tmp;
+	return app;
 }
-
-
-
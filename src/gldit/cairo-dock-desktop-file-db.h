@@ -33,8 +33,9 @@ G_BEGIN_DECLS
 
 
 /**
- * Start the desktop file DB manager. This will run a background thread to populate the DB with all apps
- * installed on the system. */
+ * Start the desktop file DB manager. The DB is first loaded from the snapshot saved in the user cache folder,
+ * then a background thread populates it with all apps installed on the system. Afterwards, the applications
+ * folders are monitored, and only the .desktop files that have changed are read again. */
 void gldi_desktop_file_db_init (void);
 
 /**
@@ -42,17 +43,24 @@ void gldi_desktop_file_db_init (void);
 void gldi_desktop_file_db_stop (void);
 
 /**
- * Try to look up an installed app. This function can block the first time it's called if the DB has not been
- * fully populated yet.
+ * Try to look up an installed app. This function can block the first time it's called if there was no
+ * snapshot of the DB and it has not been fully populated yet.
  * @param class Desktop file ID, class or app-id of an app to look up (matching is based on the basename of
  * 	its .desktop file, and the content of the StartupWMClass and Exec keys in it).
  * @param bOnlyDesktopID if TRUE, only the .desktop file name is used for matching (can be useful if looking
  * 	for a known .desktop file).
  * @return GDesktopAppInfo corresponding to the app if found. The return value is owned by the DB, the
- *  caller should call g_object_ref () on it if it wants to keep it.
+ *  caller should call g_object_ref () on it if it wants to keep it after the next lookup.
 */
 GDesktopAppInfo *gldi_desktop_file_db_lookup (const char *class, gboolean bOnlyDesktopID);
 
+/**
+ * Get the generation of the DB. It changes each time an app is added, removed or modified, and is kept
+ * between sessions (it is a hash of the content of the DB), so it can be used to validate data derived from it.
+ * @return the generation, or 0 if the DB has not been loaded yet.
+*/
+guint gldi_desktop_file_db_get_generation (void);
+
 G_END_DECLS
 
 #endif
@@ -149,6 +149,8 @@ struct _CairoDialog {
 	gboolean bInAnswer;
 	gchar *cText;
 	gboolean bPendingClose; // used when we should close the dialog on the next button release event
+	gboolean bPositionRequested;  // TRUE once the dialog has been moved by us
+	gint iRequestedPositionX, iRequestedPositionY;  // last position given to the WM (the window position is only updated once the WM has moved it)
 	
 	gpointer reserved[2];
 };
@@ -57,6 +57,17 @@ static GSList *s_pDialogList = NULL;
 static cairo_surface_t *s_pButtonOkSurface = NULL;
 static cairo_surface_t *s_pButtonCancelSurface = NULL;
 static guint s_iSidReplaceDialogs = 0;
+typedef struct {
+	CairoDialog *pDialog;
+	gint x, y, w, h;  // where we placed the dialog
+	gint iAimedX, iAimedY;  // the point it was aiming at when it was placed
+	gboolean bDirectionUp;
+	gboolean bDirty;  // it has to be placed again
+	gboolean bPlaced;  // it has already been placed during the current pass
+	} CDDialogBox;
+static GArray *s_pDialogBoxes = NULL;  // boxes of the placed dialogs, kept from one pass to the next, so that a pass only places again the dialogs affected by a change.
+static gboolean s_bPlacingDialogs = FALSE;  // TRUE during a placement pass.
+static int s_iDesktopWidth = 0, s_iDesktopHeight = 0;  // size of the desktop at the previous pass
 
 static void _set_dialog_orientation (CairoDialog *pDialog, GldiContainer *pContainer);
 static void _place_dialog (CairoDialog *pDialog, GldiContainer *pContainer);
@@ -472,73 +483,145 @@ void gldi_dialogs_remove_on_icon (Icon *icon)  // gldi_icon_remove_dialog ?...
 }
 
 
+static int _find_dialog_box (CairoDialog *pDialog)
+{
+	guint i;
+	for (i = 0; i < s_pDialogBoxes->len; i ++)
+	{
+		if (g_array_index (s_pDialogBoxes, CDDialogBox, i).pDialog == pDialog)
+			return i;
+	}
+	return -1;
+}
+
+static void _invalidate_dialog_boxes_around (const CDDialogBox *pChangedBox)  // the dialogs touching a box that moved, appeared or disappeared may have to move too (to make room, or to get closer to their icon).
+{
+	gboolean bInvalidated = FALSE;
+	CDDialogBox *pBox;
+	guint i;
+	for (i = 0; i < s_pDialogBoxes->len; i ++)
+	{
+		pBox = &g_array_index (s_pDialogBoxes, CDDialogBox, i);
+		if (pBox->pDialog == pChangedBox->pDialog || pBox->bDirty)
+			continue;
+		if (pBox->x <= pChangedBox->x + pChangedBox->w && pChangedBox->x <= pBox->x + pBox->w
+		&& pBox->y <= pChangedBox->y + pChangedBox->h && pChangedBox->y <= pBox->y + pBox->h)  // the 2 boxes intersect or are adjacent (a dialog stacked on top of another one is just next to it).
+		{
+			pBox->bDirty = TRUE;
+			bInvalidated = TRUE;
+		}
+	}
+	if (bInvalidated && ! s_bPlacingDialogs)  // otherwise the current pass will handle them.
+		gldi_dialogs_trigger_replace_all ();
+}
+
+static void _update_dialog_box (CairoDialog *pDialog)  // the window will be moved asynchronously, so the other dialogs have to know where it will be.
+{
+	CDDialogBox box;
+	box.pDialog = pDialog;
+	box.x = pDialog->iComputedPositionX;
+	box.y = pDialog->iComputedPositionY;
+	box.w = pDialog->iComputedWidth;
+	box.h = pDialog->iComputedHeight;
+	box.iAimedX = pDialog->iAimedX;
+	box.iAimedY = pDialog->iAimedY;
+	box.bDirectionUp = pDialog->container.bDirectionUp;
+	box.bDirty = FALSE;
+	box.bPlaced = s_bPlacingDialogs;
+	
+	int i = _find_dialog_box (pDialog);
+	if (i < 0)  // new box
+	{
+		g_array_append_val (s_pDialogBoxes, box);
+		_invalidate_dialog_boxes_around (&box);
+		return;
+	}
+	CDDialogBox *pBox = &g_array_index (s_pDialogBoxes, CDDialogBox, i);
+	CDDialogBox prev = *pBox;
+	box.bPlaced = prev.bPlaced || s_bPlacingDialogs;
+	*pBox = box;
+	if (box.x != prev.x || box.y != prev.y || box.w != prev.w || box.h != prev.h)
+	{
+		_invalidate_dialog_boxes_around (&prev);
+		_invalidate_dialog_boxes_around (&box);
+	}
+}
+
+static void _remove_dialog_box (CairoDialog *pDialog)
+{
+	int i = _find_dialog_box (pDialog);
+	if (i < 0)
+		return;
+	CDDialogBox box = g_array_index (s_pDialogBoxes, CDDialogBox, i);
+	g_array_remove_index (s_pDialogBoxes, i);
+	_invalidate_dialog_boxes_around (&box);
+}
+
 static void _cairo_dock_dialog_find_optimal_placement (CairoDialog *pDialog)
 {
 	//g_print ("%s (Ybulle:%d; %dx%d)\n", __func__, pDialog->iComputedPositionY, pDialog->iComputedWidth, pDialog->iComputedHeight);
-	
 	int iZoneXLeft, iZoneXRight, iY, iWidth, iHeight;  // our available zone.
 	iWidth = pDialog->iComputedWidth;
 	iHeight = pDialog->iComputedHeight;
-	iY = pDialog->iComputedPositionY;
 	iZoneXLeft = MAX (pDialog->iAimedX - iWidth, 0);
 	iZoneXRight = MIN (pDialog->iAimedX + iWidth, gldi_desktop_get_width());
-	CairoDialog *pDialogOnOurWay;
-	int iLimitXLeft = iZoneXLeft;
-	int iLimitXRight = iZoneXRight;  // left and right limits due to other dialogs
-	int iMinYLimit = (pDialog->container.bDirectionUp ? -1e4 : 1e4);  // closest y limit due to other dialogs.
+	CDDialogBox *pBoxOnOurWay;
+	int iLimitXLeft, iLimitXRight;  // left and right limits due to other dialogs
+	int iMinYLimit;  // closest y limit due to other dialogs.
 	int iBottomY, iTopY, iXleft, iXright;  // box of the other dialog.
-	gboolean bDialogOnOurWay = FALSE;
-	GSList *ic;
-	for (ic = s_pDialogList; ic != NULL; ic = ic->next)
+	gboolean bDialogOnOurWay;
+	guint i, iNbTries;
+	for (iNbTries = 0; iNbTries <= s_pDialogBoxes->len; iNbTries ++)  // each try moves us beyond the closest dialog that was disturbing, so we can't need more tries than there are dialogs.
 	{
-		pDialogOnOurWay = ic->data;
-		if (pDialogOnOurWay == NULL)
-			continue ;
-		if (pDialogOnOurWay != pDialog)  // check if this dialog can overlap us.
+		iY = pDialog->iComputedPositionY;
+		iLimitXLeft = iZoneXLeft;
+		iLimitXRight = iZoneXRight;
+		iMinYLimit = (pDialog->container.bDirectionUp ? -1e4 : 1e4);
+		bDialogOnOurWay = FALSE;
+		for (i = 0; i < s_pDialogBoxes->len; i ++)
 		{
-			if (pDialogOnOurWay->container.pWidget && gldi_container_is_visible (CAIRO_CONTAINER (pDialogOnOurWay)) && pDialogOnOurWay->pIcon != NULL)
+			pBoxOnOurWay = &g_array_index (s_pDialogBoxes, CDDialogBox, i);
+			if (pBoxOnOurWay->pDialog == pDialog)
+				continue;
+			// check if this dialog can overlap us.
+			iTopY = pBoxOnOurWay->y;
+			iBottomY = pBoxOnOurWay->y + pBoxOnOurWay->h;
+			iXleft = pBoxOnOurWay->x;
+			iXright = pBoxOnOurWay->x + pBoxOnOurWay->w;
+			if ( ((iTopY < iY && iBottomY > iY) || (iTopY >= iY && iTopY < iY + iHeight))
+				&& ((iXleft < iZoneXLeft && iXright > iZoneXLeft) || (iXleft >= iZoneXLeft && iXleft < iZoneXRight)) )  // intersection of the 2 rectangles.
 			{
-				iTopY = pDialogOnOurWay->container.iWindowPositionY;
-				iBottomY = pDialogOnOurWay->container.iWindowPositionY + pDialogOnOurWay->container.iHeight;
-				iXleft = pDialogOnOurWay->container.iWindowPositionX;
-				iXright = pDialogOnOurWay->container.iWindowPositionX + pDialogOnOurWay->container.iWidth;
-				if ( ((iTopY < iY && iBottomY > iY) || (iTopY >= iY && iTopY < iY + iHeight))
-					&& ((iXleft < iZoneXLeft && iXright > iZoneXLeft) || (iXleft >= iZoneXLeft && iXleft < iZoneXRight)) )  // intersection of the 2 rectangles.
-				{
-					cd_debug ("  dialogue genant:  %d - %d, %d - %d", iTopY, iBottomY, iXleft, iXright);
-					if (pDialogOnOurWay->iAimedX < pDialog->iAimedX)  // this dialog is on our left.
-						iLimitXLeft = MAX (iLimitXLeft, pDialogOnOurWay->container.iWindowPositionX + pDialogOnOurWay->container.iWidth);
-					else
-						iLimitXRight = MIN (iLimitXRight, pDialogOnOurWay->container.iWindowPositionX);
-					iMinYLimit = (pDialog->container.bDirectionUp ? MAX (iMinYLimit, iTopY) : MIN (iMinYLimit, iBottomY));
-					cd_debug ("  iMinYLimit <- %d", iMinYLimit);
-					bDialogOnOurWay = TRUE;
-				}
+				cd_debug ("  dialogue genant:  %d - %d, %d - %d", iTopY, iBottomY, iXleft, iXright);
+				if (pBoxOnOurWay->pDialog->iAimedX < pDialog->iAimedX)  // this dialog is on our left.
+					iLimitXLeft = MAX (iLimitXLeft, iXright);
+				else
+					iLimitXRight = MIN (iLimitXRight, iXleft);
+				iMinYLimit = (pDialog->container.bDirectionUp ? MAX (iMinYLimit, iTopY) : MIN (iMinYLimit, iBottomY));
+				cd_debug ("  iMinYLimit <- %d", iMinYLimit);
+				bDialogOnOurWay = TRUE;
 			}
 		}
-	}
-	//g_print (" -> [%d ; %d], %d, %d\n", iLimitXLeft, iLimitXRight, iWidth, iMinYLimit);
-	if (iLimitXRight - iLimitXLeft >= MIN (gldi_desktop_get_width(), iWidth) || !bDialogOnOurWay)  // there is enough room to place the dialog.
-	{
-		if (pDialog->bRight)
-			pDialog->iComputedPositionX = MAX (0, MIN (pDialog->iAimedX - pDialog->fAlign * (iWidth - pDialog->iIconOffsetX) - pDialog->iIconOffsetX, iLimitXRight - iWidth));
-		else
-			pDialog->iComputedPositionX = MIN (gldi_desktop_get_width() - iWidth, MAX (pDialog->iAimedX - (1. - pDialog->fAlign) * (iWidth - pDialog->iIconOffsetX) - pDialog->iIconOffsetX, iLimitXLeft));
-		if (pDialog->container.bDirectionUp && pDialog->iComputedPositionY < 0)
-			pDialog->iComputedPositionY = 0;
-		else if (!pDialog->container.bDirectionUp && pDialog->iComputedPositionY + iHeight > gldi_desktop_get_height())
-			pDialog->iComputedPositionY = gldi_desktop_get_height() - iHeight;
-		//g_print (" --> %d\n", pDialog->iComputedPositionX);
-	}
-	else  // not enough room, try again above the closest dialog that was disturbing.
-	{
+		//g_print (" -> [%d ; %d], %d, %d\n", iLimitXLeft, iLimitXRight, iWidth, iMinYLimit);
+		if (iLimitXRight - iLimitXLeft >= MIN (gldi_desktop_get_width(), iWidth) || !bDialogOnOurWay)  // there is enough room to place the dialog.
+			break;
+		
+		// not enough room, try again above the closest dialog that was disturbing.
 		if (pDialog->container.bDirectionUp)
 			pDialog->iComputedPositionY = iMinYLimit - iHeight;
 		else
 			pDialog->iComputedPositionY = iMinYLimit;
 		cd_debug (" => re-try with y=%d", pDialog->iComputedPositionY);
-		_cairo_dock_dialog_find_optimal_placement (pDialog);
 	}
+	
+	if (pDialog->bRight)
+		pDialog->iComputedPositionX = MAX (0, MIN (pDialog->iAimedX - pDialog->fAlign * (iWidth - pDialog->iIconOffsetX) - pDialog->iIconOffsetX, iLimitXRight - iWidth));
+	else
+		pDialog->iComputedPositionX = MIN (gldi_desktop_get_width() - iWidth, MAX (pDialog->iAimedX - (1. - pDialog->fAlign) * (iWidth - pDialog->iIconOffsetX) - pDialog->iIconOffsetX, iLimitXLeft));
+	if (pDialog->container.bDirectionUp && pDialog->iComputedPositionY < 0)
+		pDialog->iComputedPositionY = 0;
+	else if (!pDialog->container.bDirectionUp && pDialog->iComputedPositionY + iHeight > gldi_desktop_get_height())
+		pDialog->iComputedPositionY = gldi_desktop_get_height() - iHeight;
+	//g_print (" --> %d\n", pDialog->iComputedPositionX);
 }
 
 static void _cairo_dock_dialog_calculate_aimed_point (Icon *pIcon, GldiContainer *pContainer, int *iX, int *iY, gboolean *bRight, gboolean *bIsHorizontal, gboolean *bDirectionUp, double fAlign)
@@ -758,6 +841,18 @@ static void _place_dialog (CairoDialog *pDialog, GldiContainer *pContainer)
 	}
 	else
 	{
+		if (pDialog->pIcon != NULL && pContainer != NULL)
+			_update_dialog_box (pDialog);
+		
+		// don't bother the WM with dialogs that are already in place; compare with the last position we asked for, since the window position is only updated when the WM has moved it.
+		if (pDialog->bPositionRequested
+		&& pDialog->iRequestedPositionX == pDialog->iComputedPositionX
+		&& pDialog->iRequestedPositionY == pDialog->iComputedPositionY
+		&& gldi_container_is_visible (CAIRO_CONTAINER (pDialog)))
+			return;
+		pDialog->bPositionRequested = TRUE;
+		pDialog->iRequestedPositionX = pDialog->iComputedPositionX;
+		pDialog->iRequestedPositionY = pDialog->iComputedPositionY;
 		gtk_window_move (GTK_WINDOW (pDialog->container.pWidget),
 			pDialog->iComputedPositionX,
 			pDialog->iComputedPositionY);
@@ -821,6 +916,30 @@ static void _refresh_all_dialogs (gboolean bReplace)
 		}
 	}
 
+	if (bReplace)  // all the dialogs are placed in one pass; a pending pass is useless now.
+	{
+		if (s_iSidReplaceDialogs != 0)
+		{
+			g_source_remove (s_iSidReplaceDialogs);
+			s_iSidReplaceDialogs = 0;
+		}
+		s_bPlacingDialogs = TRUE;
+		
+		// forget the dialogs that are not placed any more; the ones around them are invalidated.
+		guint i = 0;
+		while (i < s_pDialogBoxes->len)
+		{
+			CDDialogBox *pBox = &g_array_index (s_pDialogBoxes, CDDialogBox, i);
+			pBox->bPlaced = FALSE;
+			pDialog = pBox->pDialog;
+			if (pDialog->pIcon == NULL || ! gldi_container_is_visible (CAIRO_CONTAINER (pDialog)) || cairo_dock_get_icon_container (pDialog->pIcon) == NULL)
+				_remove_dialog_box (pDialog);
+			else
+				i ++;
+		}
+	}
+	gboolean bDesktopChanged = (s_iDesktopWidth != gldi_desktop_get_width() || s_iDesktopHeight != gldi_desktop_get_height());  // the available room has changed, all the dialogs have to be placed again.
+	
 	for (ic = s_pDialogList; ic != NULL; ic = ic->next)
 	{
 		pDialog = ic->data;
@@ -833,16 +952,61 @@ static void _refresh_all_dialogs (gboolean bReplace)
 			{
 				int iAimedX = pDialog->iAimedX;
 				int iAimedY = pDialog->iAimedY;
-				if (bReplace)
+				if (! bReplace)
+					_set_dialog_orientation (pDialog, pContainer);
+				else if (gldi_container_use_new_positioning_code ())  // the compositor places the dialogs relatively to their icon, there is nothing to solve.
 					_place_dialog (pDialog, pContainer);
-				else
+				else if (! pDialog->container.bInside || pDialog->pInteractiveWidget || pDialog->action_on_answer)  // same as in _place_dialog: a dialog is not moved while the mouse is inside.
+				{
+					// only the dialogs whose icon has moved (or that have been resized) are placed again here; they will invalidate the dialogs around them.
 					_set_dialog_orientation (pDialog, pContainer);
+					int n = _find_dialog_box (pDialog);
+					if (n < 0)
+						_place_dialog (pDialog, pContainer);
+					else
+					{
+						CDDialogBox *pBox = &g_array_index (s_pDialogBoxes, CDDialogBox, n);
+						if (bDesktopChanged
+						|| pBox->iAimedX != pDialog->iAimedX || pBox->iAimedY != pDialog->iAimedY || pBox->bDirectionUp != pDialog->container.bDirectionUp
+						|| pBox->w != pDialog->iComputedWidth || pBox->h != pDialog->iComputedHeight)
+							pBox->bDirty = TRUE;
+					}
+				}
 				
 				if (iAimedX != pDialog->iAimedX || iAimedY != pDialog->iAimedY)
 					gtk_widget_queue_draw (pDialog->container.pWidget);  // on redessine si la pointe change de position.
 			}
 		}
 	}
+	
+	if (bReplace)
+	{
+		// place the invalidated dialogs; each placement that moves a dialog invalidates the ones around it, until nothing changes any more. Each dialog is placed at most once per pass, like when all of them were placed.
+		gboolean bPlacedSome = TRUE;
+		guint i;
+		while (bPlacedSome)
+		{
+			bPlacedSome = FALSE;
+			for (i = 0; i < s_pDialogBoxes->len; i ++)
+			{
+				CDDialogBox *pBox = &g_array_index (s_pDialogBoxes, CDDialogBox, i);
+				if (! pBox->bDirty)
+					continue;
+				pBox->bDirty = FALSE;
+				if (pBox->bPlaced)
+					continue;
+				pBox->bPlaced = TRUE;
+				pDialog = pBox->pDialog;  // note: pBox is not valid after the placement.
+				pContainer = cairo_dock_get_icon_container (pDialog->pIcon);
+				if (pContainer)
+					_place_dialog (pDialog, pContainer);
+				bPlacedSome = TRUE;
+			}
+		}
+		s_iDesktopWidth = gldi_desktop_get_width();
+		s_iDesktopHeight = gldi_desktop_get_height();
+		s_bPlacingDialogs = FALSE;
+	}
 }
 
 void gldi_dialogs_refresh_all (void)
@@ -858,11 +1022,11 @@ void gldi_dialogs_replace_all (void)
 
 static gboolean _replace_all_dialogs_idle (G_GNUC_UNUSED gpointer data)
 {
-	gldi_dialogs_replace_all ();
 	s_iSidReplaceDialogs = 0;
+	gldi_dialogs_replace_all ();
 	return FALSE;
 }
-static void _trigger_replace_all_dialogs (void)
+void gldi_dialogs_trigger_replace_all (void)
 {
 	if (s_iSidReplaceDialogs == 0)
 	{
@@ -905,7 +1069,8 @@ void gldi_dialog_hide (CairoDialog *pDialog)
 		gtk_widget_hide (pDialog->container.pWidget);
 		pDialog->container.bInside = FALSE;
 		
-		_trigger_replace_all_dialogs ();
+		_remove_dialog_box (pDialog);
+		gldi_dialogs_trigger_replace_all ();
 		
 		gldi_dialog_leave (pDialog);
 	}
@@ -1434,6 +1599,7 @@ static gboolean on_style_changed (G_GNUC_UNUSED gpointer data)
 
 static void init (void)
 {
+	s_pDialogBoxes = g_array_new (FALSE, FALSE, sizeof (CDDialogBox));
 	gldi_object_register_notification (&myDialogObjectMgr,
 		NOTIFICATION_RENDER,
 		(GldiNotificationFunc) _cairo_dock_render_dialog_notification,
@@ -1587,12 +1753,13 @@ static void reset_object (GldiObject *obj)
 	if (pDialog->pUserData != NULL && pDialog->pFreeUserDataFunc != NULL)
 		pDialog->pFreeUserDataFunc (pDialog->pUserData);
 	
+	_remove_dialog_box (pDialog);
 	if (!s_bInRefreshDialogs)
 	{
 		// unregister the dialog (note: if this function is called from refresh_dialogs, it was already removed from the list)
 		s_pDialogList = g_slist_remove (s_pDialogList, pDialog);
 		
-		_trigger_replace_all_dialogs ();
+		gldi_dialogs_trigger_replace_all ();
 	}
 }
 
@@ -51,6 +51,10 @@ void gldi_dialogs_refresh_all (void);
 
 void gldi_dialogs_replace_all (void);
 
+/** Replace all the dialogs once the current events have been processed. Use it from frequent events (configure, animations), so that several of them lead to a single placement of the dialogs.
+*/
+void gldi_dialogs_trigger_replace_all (void);
+
 CairoDialog *gldi_dialogs_foreach (GCompareFunc callback, gpointer data);
 /** Notify the dialog's dock that the dialog is hidden or destroyed.
  *  This generates a "leave" event for the mouse and "unfreezes" the
@@ -497,254 +497,368 @@ void cairo_dock_update_input_shape (CairoDock *pDock)
 
 
 
-  ///////////////////
- /// LINEAR DOCK ///
-///////////////////
+  /////////////////////
+ /// ICONS GEOMETRY ///
+/////////////////////
 
-void cairo_dock_calculate_icons_positions_at_rest_linear (CairoDock *pDock)
+static CairoDockIconsGeometry s_scratchGeometry;  // for the layouts that are not bound to a dock (cairo_dock_calculate_wave_with_position_linear)
+
+static void _reserve_icons_geometry (CairoDockIconsGeometry *pGeometry, guint iNbIcons)
 {
-	GList *pIconList = pDock->icons;
-	double fFlatDockWidth = pDock->fFlatDockWidth;
-	double x_cumulated = 0;
-	GList* ic;
+	if (iNbIcons <= pGeometry->iAllocated)
+		return;
+	guint iAllocated = MAX (iNbIcons, 2 * pGeometry->iAllocated);
+	iAllocated = (iAllocated + 3) & ~3u;  // keep each array aligned on 32 bytes inside the block
+	g_free (pGeometry->pIcons);
+	g_free (pGeometry->fXAtRest);
+	pGeometry->pIcons = g_new (Icon*, iAllocated);
+	// all the arrays live in a single block, one after the other
+	gdouble *pBlock = g_new (gdouble, 10 * iAllocated);
+	pGeometry->fXAtRest            = pBlock;
+	pGeometry->fWidth              = pBlock + 1 * iAllocated;
+	pGeometry->fHeight             = pBlock + 2 * iAllocated;
+	pGeometry->fInsertRemoveFactor = pBlock + 3 * iAllocated;
+	pGeometry->fXMin               = pBlock + 4 * iAllocated;
+	pGeometry->fXMax               = pBlock + 5 * iAllocated;
+	pGeometry->fPhase              = pBlock + 6 * iAllocated;
+	pGeometry->fScale              = pBlock + 7 * iAllocated;
+	pGeometry->fX                  = pBlock + 8 * iAllocated;
+	pGeometry->fY                  = pBlock + 9 * iAllocated;
+	pGeometry->iAllocated = iAllocated;
+}
+
+// copy the inputs of the layout from the icons
+static void _gather_icons_geometry (CairoDockIconsGeometry *pGeometry, GList *pIconList)
+{
+	_reserve_icons_geometry (pGeometry, g_list_length (pIconList));
+	guint i = 0;
+	GList *ic;
 	Icon *icon;
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+	for (ic = pIconList; ic != NULL; ic = ic->next, i ++)
 	{
 		icon = ic->data;
-
-		if (x_cumulated + icon->fWidth / 2 < 0)
-			icon->fXAtRest = x_cumulated + fFlatDockWidth;
-		else if (x_cumulated + icon->fWidth / 2 > fFlatDockWidth)
-			icon->fXAtRest = x_cumulated - fFlatDockWidth;
-		else
-			icon->fXAtRest = x_cumulated;
-		//g_print ("%s : fXAtRest = %.2f\n", icon->cName, icon->fXAtRest);
-		// note: fYAtRest only used for setting the minimize position of apps
-		int tmp1 = myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin;
-		icon->fYAtRest = (pDock->container.bDirectionUp ?
-			pDock->iMaxDockHeight - tmp1 - icon->fHeight : tmp1);
-
-		x_cumulated += icon->fWidth + myIconsParam.iIconGap;
+		pGeometry->pIcons[i] = icon;
+		pGeometry->fXAtRest[i] = icon->fXAtRest;
+		pGeometry->fWidth[i] = icon->fWidth;
+		pGeometry->fHeight[i] = icon->fHeight;
+		pGeometry->fInsertRemoveFactor[i] = icon->fInsertRemoveFactor;
+		pGeometry->fXMin[i] = icon->fXMin;
+		pGeometry->fXMax[i] = icon->fXMax;
 	}
+	pGeometry->iNbIcons = i;
+	pGeometry->iPointedIcon = -1;
+	pGeometry->bDirty = FALSE;
 }
 
-double cairo_dock_calculate_max_dock_width (CairoDock *pDock, double fFlatDockWidth, double fWidthConstraintFactor, double fExtraWidth)
+// make sure the inputs are up-to-date. The positions at rest and the sizes only change along with cairo_dock_calculate_icons_positions_at_rest_linear(), which invalidates the arrays, like any change in the list of icons; so most of the time only the insertion/removal factor has to be read.
+static void _sync_icons_geometry (CairoDockIconsGeometry *pGeometry, GList *pIconList)
 {
-	double fMaxDockWidth = 0.;
-	//g_print ("%s (%d)\n", __func__, (int)fFlatDockWidth);
-	GList *pIconList = pDock->icons;
-	if (pIconList == NULL)
-		return 2 * myDocksParam.iDockRadius + myDocksParam.iDockLineWidth + 2 * myDocksParam.iFrameMargin;
-
-	// We reset extreme positions of the icons.
-	GList* ic;
-	Icon *icon;
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+	if (pGeometry->bDirty)
 	{
-		icon = ic->data;
-		icon->fXMax = -1e4;
-		icon->fXMin = 1e4;
+		_gather_icons_geometry (pGeometry, pIconList);
+		return;
 	}
+	guint i;
+	for (i = 0; i < pGeometry->iNbIcons; i ++)
+		pGeometry->fInsertRemoveFactor[i] = pGeometry->pIcons[i]->fInsertRemoveFactor;
+}
 
-	/* We simulate the move of the cursor in all the width of the dock and we
-	 * get the maximum width and the balance position for each icon.
-	 */
-	GList *ic2;
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+// copy the results of the layout back into the icons, in a single pass
+static void _scatter_icons_geometry (CairoDockIconsGeometry *pGeometry, gboolean bExtrema)
+{
+	guint i;
+	Icon *icon;
+	for (i = 0; i < pGeometry->iNbIcons; i ++)
 	{
-		icon = ic->data;
-
-		cairo_dock_calculate_wave_with_position_linear (pIconList, icon->fXAtRest, pDock->fMagnitudeMax, fFlatDockWidth, 0, 0, 0.5, 0, pDock->container.bDirectionUp);
-		
-		for (ic2 = pIconList; ic2 != NULL; ic2 = ic2->next)
+		icon = pGeometry->pIcons[i];
+		icon->fPhase = pGeometry->fPhase[i];
+		icon->fScale = pGeometry->fScale[i];
+		icon->fX = pGeometry->fX[i];
+		icon->fY = pGeometry->fY[i];
+		if (bExtrema)
 		{
-			icon = ic2->data;
-
-			if (icon->fX + icon->fWidth * icon->fScale > icon->fXMax)
-				icon->fXMax = icon->fX + icon->fWidth * icon->fScale;
-			if (icon->fX < icon->fXMin)
-				icon->fXMin = icon->fX;
+			icon->fXMin = pGeometry->fXMin[i];
+			icon->fXMax = pGeometry->fXMax[i];
 		}
+		icon->bPointed = ((gint)i == pGeometry->iPointedIcon && pGeometry->bPointed);
 	}
-	cairo_dock_calculate_wave_with_position_linear (pIconList, fFlatDockWidth - 1, pDock->fMagnitudeMax, fFlatDockWidth, 0, 0, pDock->fAlign, 0, pDock->container.bDirectionUp);  // last calculation at the extreme right of the dock.
-	for (ic = pIconList; ic != NULL; ic = ic->next)
-	{
-		icon = ic->data;
+}
 
-		if (icon->fX + icon->fWidth * icon->fScale > icon->fXMax)
-			icon->fXMax = icon->fX + icon->fWidth * icon->fScale;
-		if (icon->fX < icon->fXMin)
-			icon->fXMin = icon->fX;
+CairoDockIconsGeometry *cairo_dock_get_icons_geometry (CairoDock *pDock)
+{
+	if (pDock->pIconsGeometry == NULL)
+	{
+		pDock->pIconsGeometry = g_new0 (CairoDockIconsGeometry, 1);
+		pDock->pIconsGeometry->bDirty = TRUE;
 	}
+	return pDock->pIconsGeometry;
+}
 
-	fMaxDockWidth = (icon->fXMax - ((Icon *) pIconList->data)->fXMin) * fWidthConstraintFactor + fExtraWidth;
-	fMaxDockWidth = ceil (fMaxDockWidth) + 1;
+void cairo_dock_invalidate_icons_geometry (CairoDock *pDock)
+{
+	if (pDock->pIconsGeometry != NULL)
+		pDock->pIconsGeometry->bDirty = TRUE;
+}
 
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+void cairo_dock_free_icons_geometry (CairoDockIconsGeometry *pGeometry)
+{
+	if (pGeometry == NULL)
+		return;
+	g_free (pGeometry->pIcons);
+	g_free (pGeometry->fXAtRest);
+	g_free (pGeometry);
+}
+
+// sin(x) for x in [0;pi], approximated by its Taylor polynomial around pi/2 (|error| < 5e-7): the scales, and so the positions, are close to what sin() gives, not bit-identical. It has no call, so the loop below can be vectorized (tests/bench/bench-magnification compares it with sin() and the table of cairo_dock_get_magnification_profile).
+static inline gdouble _sin_0_pi (gdouble x)
+{
+	gdouble t = x - G_PI_2;
+	gdouble t2 = t * t;
+	return 1. + t2 * (-1./2 + t2 * (1./24 + t2 * (-1./720 + t2 * (1./40320 + t2 * (-1./3628800)))));
+}
+
+// phase of each icon (pi/2 next to the cursor) and the scale given by the sinusoid; no branch, no dependency between icons.
+static void _compute_phase_and_scale (CairoDockIconsGeometry *pGeometry, gdouble x_abs, gdouble fScaleAmplitude)
+{
+	const gdouble *fXAtRest = pGeometry->fXAtRest;
+	const gdouble *fWidth = pGeometry->fWidth;
+	gdouble *fPhase = pGeometry->fPhase;
+	gdouble *fScale = pGeometry->fScale;
+	const gdouble k = G_PI / myIconsParam.iSinusoidWidth;
+	guint i, n = pGeometry->iNbIcons;
+	for (i = 0; i < n; i ++)
 	{
-		icon = ic->data;
-		icon->fXMin += fMaxDockWidth / 2;
-		icon->fXMax += fMaxDockWidth / 2;
-		//g_print ("%s : [%d;%d]\n", icon->cName, (int) icon->fXMin, (int) icon->fXMax);
-		icon->fX = icon->fXAtRest;
-		icon->fScale = 1;
+		gdouble phase = (fXAtRest[i] + fWidth[i] / 2 - x_abs) * k + G_PI_2;
+		phase = .5 * (phase + fabs (phase));  // max (phase, 0), written without a branch
+		phase = G_PI - .5 * ((G_PI - phase) + fabs (G_PI - phase));  // min (phase, pi)
+		fPhase[i] = phase;
+		fScale[i] = 1. + fScaleAmplitude * _sin_0_pi (phase);
 	}
-
-	return fMaxDockWidth;
 }
 
-Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
+static void _compute_wave_linear (CairoDockIconsGeometry *pGeometry, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
 {
-	//g_print (">>>>>%s (%d/%.2f, %dx%d, %.2f, %.2f)\n", __func__, x_abs, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor);
-	if (pIconList == NULL)
-		return NULL;
+	gint n = pGeometry->iNbIcons;
 	if (x_abs < 0 && iWidth > 0)
 		// to avoid too quick resize when leaving from the edges.
-		///x_abs = -1;
 		x_abs = 0;
 	else if (x_abs > fFlatDockWidth && iWidth > 0)
-		///x_abs = fFlatDockWidth+1;
 		x_abs = (int) fFlatDockWidth;
 	
+	gdouble *fXAtRest = pGeometry->fXAtRest, *fWidth = pGeometry->fWidth, *fHeight = pGeometry->fHeight;
+	gdouble *fXMin = pGeometry->fXMin, *fXMax = pGeometry->fXMax;
+	gdouble *fScale = pGeometry->fScale, *fX = pGeometry->fX, *fY = pGeometry->fY;
+	
+	//\_______________ We compute the phases and deduct the sinusoidal amplitude next to each icon (its scale)
+	_compute_phase_and_scale (pGeometry, x_abs, fMagnitude * myIconsParam.fAmplitude);
 	
 	float x_cumulated = 0, fXMiddle, fDeltaExtremum;
-	GList* ic, *pointed_ic;
-	Icon *icon, *prev_icon;
-	double fScale = 0.;
+	double fScaleBefore = 0.;
 	double offset = 0.;
-	pointed_ic = (x_abs < 0 ? pIconList : NULL);
-	for (ic = pIconList; ic != NULL; ic = ic->next)
+	const int iGap = myIconsParam.iIconGap;
+	const double fMargin = myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin;
+	const double fAmplitude = myIconsParam.fAmplitude;
+	const double fWaveExtent = fAmplitude * fMagnitude;  // how much the icons can go beyond their extrema
+	gint i, iPointed = (x_abs < 0 ? 0 : -1);
+	gboolean bPointed = FALSE;
+	// place the icons; each icon is placed after the previous one, so unlike the phase/scale pass, this loop is serial and has branches.
+	for (i = 0; i < n; i ++)
 	{
-		icon = ic->data;
-		x_cumulated = icon->fXAtRest;
-		fXMiddle = icon->fXAtRest + icon->fWidth / 2;
-
-		//\_______________ We compute its phase (pi/2 next to the cursor).
-		icon->fPhase = (fXMiddle - x_abs) / myIconsParam.iSinusoidWidth * G_PI + G_PI / 2;
-		if (icon->fPhase < 0)
-		{
-			icon->fPhase = 0;
-		}
-		else if (icon->fPhase > G_PI)
-		{
-			icon->fPhase = G_PI;
-		}
+		x_cumulated = fXAtRest[i];
+		fXMiddle = fXAtRest[i] + fWidth[i] / 2;
 		
-		//\_______________ We deduct the sinusoidal amplitude next to the icon (its scale)
-		icon->fScale = 1 + fMagnitude * myIconsParam.fAmplitude * sin (icon->fPhase);
-		if (iWidth > 0 && icon->fInsertRemoveFactor != 0)
+		if (iWidth > 0 && pGeometry->fInsertRemoveFactor[i] != 0)
 		{
-			fScale = icon->fScale;
-			///offset += (icon->fWidth * icon->fScale) * (pointed_ic == NULL ? 1 : -1);
-			if (icon->fInsertRemoveFactor > 0)
-				icon->fScale *= icon->fInsertRemoveFactor;
+			fScaleBefore = fScale[i];
+			if (pGeometry->fInsertRemoveFactor[i] > 0)
+				fScale[i] *= pGeometry->fInsertRemoveFactor[i];
 			else
-				icon->fScale *= (1 + icon->fInsertRemoveFactor);
-			///offset -= (icon->fWidth * icon->fScale) * (pointed_ic == NULL ? 1 : -1);
+				fScale[i] *= (1 + pGeometry->fInsertRemoveFactor[i]);
 		}
 		
-		icon->fY = (bDirectionUp ? iHeight - myDocksParam.iDockLineWidth - myDocksParam.iFrameMargin - icon->fScale * icon->fHeight : myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin);
-		//g_print ("%s fY : %d; %.2f\n", icon->cName, iHeight, icon->fHeight);
+		fY[i] = (bDirectionUp ? iHeight - fMargin - fScale[i] * fHeight[i] : fMargin);
 		
 		/* If we already have defined a pointed icon, we can move the current
 		 * icon compared to the previous one
 		 */
-		if (pointed_ic != NULL)
+		if (iPointed >= 0)
 		{
-			if (ic == pIconList)  // can happen if we are outside from the left of the dock.
+			if (i == 0)  // can happen if we are outside from the left of the dock.
 			{
-				icon->fX = x_cumulated - 1. * (fFlatDockWidth - iWidth) / 2;
-				//g_print ("  outside from the left : icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+				fX[i] = x_cumulated - 1. * (fFlatDockWidth - iWidth) / 2;
 			}
 			else
 			{
-				prev_icon = (ic->prev != NULL ? ic->prev->data : cairo_dock_get_last_icon (pIconList));
-				icon->fX = prev_icon->fX + (prev_icon->fWidth + myIconsParam.iIconGap) * prev_icon->fScale;
-
-				if (icon->fX + icon->fWidth * icon->fScale > icon->fXMax - myIconsParam.fAmplitude * fMagnitude * (icon->fWidth + 1.5*myIconsParam.iIconGap) / 8 && iWidth != 0)
+				fX[i] = fX[i-1] + (fWidth[i-1] + iGap) * fScale[i-1];
+				
+				if (fX[i] + fWidth[i] * fScale[i] > fXMax[i] - fWaveExtent * (fWidth[i] + 1.5*iGap) / 8 && iWidth != 0)
 				{
-					//g_print ("  we constraint %s (fXMax=%.2f , fX=%.2f\n", prev_icon->cName, prev_icon->fXMax, prev_icon->fX);
-					fDeltaExtremum = icon->fX + icon->fWidth * icon->fScale - (icon->fXMax - myIconsParam.fAmplitude * fMagnitude * (icon->fWidth + 1.5*myIconsParam.iIconGap) / 16);
-					if (myIconsParam.fAmplitude != 0)
-						icon->fX -= fDeltaExtremum * (1 - (icon->fScale - 1) / myIconsParam.fAmplitude) * fMagnitude;
+					fDeltaExtremum = fX[i] + fWidth[i] * fScale[i] - (fXMax[i] - fWaveExtent * (fWidth[i] + 1.5*iGap) / 16);
+					if (fAmplitude != 0)
+						fX[i] -= fDeltaExtremum * (1 - (fScale[i] - 1) / fAmplitude) * fMagnitude;
 				}
 			}
-			icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-			//g_print ("  on the right : icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+			fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
 		}
 		
 		//\_______________ We check if we have a pointer on this icon.
-		if (pointed_ic == NULL
-		    && x_cumulated + icon->fWidth + .5*myIconsParam.iIconGap >= x_abs
-		    && x_cumulated - .5*myIconsParam.iIconGap <= x_abs) // we found the pointed icon.
+		if (iPointed < 0
+		    && x_cumulated + fWidth[i] + .5*iGap >= x_abs
+		    && x_cumulated - .5*iGap <= x_abs) // we found the pointed icon.
 		{
-			pointed_ic = ic;
-			///icon->bPointed = TRUE;
-			icon->bPointed = (x_abs != (int) fFlatDockWidth && x_abs != 0);
-			icon->fX = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - icon->fScale) * (x_abs - x_cumulated + .5*myIconsParam.iIconGap);
-			icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-			//g_print ("  pointed icon: fX = %.2f (%.2f, %d)\n", icon->fX, x_cumulated, icon->bPointed);
+			iPointed = i;
+			bPointed = (x_abs != (int) fFlatDockWidth && x_abs != 0);
+			fX[i] = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - fScale[i]) * (x_abs - x_cumulated + .5*iGap);
+			fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
 		}
-		else
-			icon->bPointed = FALSE;
 		
-		if (iWidth > 0 && icon->fInsertRemoveFactor != 0)
+		if (iWidth > 0 && pGeometry->fInsertRemoveFactor[i] != 0)
 		{
-			if (pointed_ic != ic)  // bPointed can be false for the last icon on the right.
-				offset += (icon->fWidth * (fScale - icon->fScale)) * (pointed_ic == NULL ? 1 : -1);
+			if (iPointed != i)  // bPointed can be false for the last icon on the right.
+				offset += (fWidth[i] * (fScaleBefore - fScale[i])) * (iPointed < 0 ? 1 : -1);
 			else
-				offset += (2*(fXMiddle - x_abs) * (fScale - icon->fScale)) * (pointed_ic == NULL ? 1 : -1);
+				offset += (2*(fXMiddle - x_abs) * (fScaleBefore - fScale[i])) * (iPointed < 0 ? 1 : -1);
 		}
 	}
 	
 	//\_______________ We place icons before pointed icon beside this one
-	if (pointed_ic == NULL)  // We are at the right of icons.
+	if (iPointed < 0)  // We are at the right of icons.
 	{
-		pointed_ic = g_list_last (pIconList);
-		icon = pointed_ic->data;
-		icon->fX = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - icon->fScale) * (icon->fWidth + .5*myIconsParam.iIconGap);
-		icon->fX = fAlign * iWidth + (icon->fX - fAlign * iWidth) * (1 - fFoldingFactor);
-		//g_print ("  outside on the right: icon->fX = %.2f (%.2f)\n", icon->fX, x_cumulated);
+		iPointed = n - 1;
+		fX[iPointed] = x_cumulated - (fFlatDockWidth - iWidth) / 2 + (1 - fScale[iPointed]) * (fWidth[iPointed] + .5*iGap);
+		fX[iPointed] = fAlign * iWidth + (fX[iPointed] - fAlign * iWidth) * (1 - fFoldingFactor);
 	}
 	
-	ic = pointed_ic;
-	while (ic != pIconList)
+	for (i = iPointed - 1; i >= 0; i --)
 	{
-		icon = ic->data;
-		
-		ic = ic->prev;  // since ic != pIconList, ic->prev is not NULL
-		prev_icon = ic->data;
-		
-		prev_icon->fX = icon->fX - (prev_icon->fWidth + myIconsParam.iIconGap) * prev_icon->fScale;
-		//g_print ("fX <- %.2f; fXMin : %.2f\n", prev_icon->fX, prev_icon->fXMin);
-		if (prev_icon->fX < prev_icon->fXMin + myIconsParam.fAmplitude * fMagnitude * (prev_icon->fWidth + 1.5*myIconsParam.iIconGap) / 8
-		    && iWidth != 0 && x_abs < iWidth && fMagnitude > 0)  /// && prev_icon->fPhase == 0
+		fX[i] = fX[i+1] - (fWidth[i] + iGap) * fScale[i];
+		if (fX[i] < fXMin[i] + fWaveExtent * (fWidth[i] + 1.5*iGap) / 8
+		    && iWidth != 0 && x_abs < iWidth && fMagnitude > 0)
 		    // We re-add 'fMagnitude > 0' otherwise we have a small jump due to constraints on the left of the pointed icon.
 		{
-			//g_print ("  we constraint %s (fXMin=%.2f , fX=%.2f\n", prev_icon->cName, prev_icon->fXMin, prev_icon->fX);
-			fDeltaExtremum = prev_icon->fX - (prev_icon->fXMin + myIconsParam.fAmplitude * fMagnitude * (prev_icon->fWidth + 1.5*myIconsParam.iIconGap) / 16);
-			if (myIconsParam.fAmplitude != 0)
-				prev_icon->fX -= fDeltaExtremum * (1 - (prev_icon->fScale - 1) / myIconsParam.fAmplitude) * fMagnitude;
+			fDeltaExtremum = fX[i] - (fXMin[i] + fWaveExtent * (fWidth[i] + 1.5*iGap) / 16);
+			if (fAmplitude != 0)
+				fX[i] -= fDeltaExtremum * (1 - (fScale[i] - 1) / fAmplitude) * fMagnitude;
 		}
-		prev_icon->fX = fAlign * iWidth + (prev_icon->fX - fAlign * iWidth) * (1. - fFoldingFactor);
-		//g_print ("  prev_icon->fX : %.2f\n", prev_icon->fX);
+		fX[i] = fAlign * iWidth + (fX[i] - fAlign * iWidth) * (1. - fFoldingFactor);
 	}
 	
 	if (offset != 0)
 	{
 		offset /= 2;
-		//g_print ("offset : %.2f (pointed:%s)\n", offset, pointed_ic?((Icon*)pointed_ic->data)->cName:"none");
-		for (ic = pIconList; ic != NULL; ic = ic->next)
+		for (i = 0; i < n; i ++)
+			fX[i] -= offset;
+	}
+	
+	pGeometry->iPointedIcon = iPointed;
+	pGeometry->bPointed = bPointed;
+}
+
+static Icon *_calculate_wave_linear (CairoDockIconsGeometry *pGeometry, GList *pIconList, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
+{
+	if (pIconList == NULL)
+		return NULL;
+	_sync_icons_geometry (pGeometry, pIconList);
+	_compute_wave_linear (pGeometry, x_abs, fMagnitude, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor, bDirectionUp);
+	_scatter_icons_geometry (pGeometry, FALSE);
+	return (pGeometry->bPointed ? pGeometry->pIcons[pGeometry->iPointedIcon] : NULL);
+}
+
+
+  ///////////////////
+ /// LINEAR DOCK ///
+///////////////////
+
+void cairo_dock_calculate_icons_positions_at_rest_linear (CairoDock *pDock)
+{
+	GList *pIconList = pDock->icons;
+	double fFlatDockWidth = pDock->fFlatDockWidth;
+	double x_cumulated = 0;
+	GList* ic;
+	Icon *icon;
+	for (ic = pIconList; ic != NULL; ic = ic->next)
+	{
+		icon = ic->data;
+
+		if (x_cumulated + icon->fWidth / 2 < 0)
+			icon->fXAtRest = x_cumulated + fFlatDockWidth;
+		else if (x_cumulated + icon->fWidth / 2 > fFlatDockWidth)
+			icon->fXAtRest = x_cumulated - fFlatDockWidth;
+		else
+			icon->fXAtRest = x_cumulated;
+		//g_print ("%s : fXAtRest = %.2f\n", icon->cName, icon->fXAtRest);
+		// note: fYAtRest only used for setting the minimize position of apps
+		int tmp1 = myDocksParam.iDockLineWidth + myDocksParam.iFrameMargin;
+		icon->fYAtRest = (pDock->container.bDirectionUp ?
+			pDock->iMaxDockHeight - tmp1 - icon->fHeight : tmp1);
+
+		x_cumulated += icon->fWidth + myIconsParam.iIconGap;
+	}
+	cairo_dock_invalidate_icons_geometry (pDock);
+}
+
+double cairo_dock_calculate_max_dock_width (CairoDock *pDock, double fFlatDockWidth, double fWidthConstraintFactor, double fExtraWidth)
+{
+	double fMaxDockWidth = 0.;
+	//g_print ("%s (%d)\n", __func__, (int)fFlatDockWidth);
+	GList *pIconList = pDock->icons;
+	if (pIconList == NULL)
+		return 2 * myDocksParam.iDockRadius + myDocksParam.iDockLineWidth + 2 * myDocksParam.iFrameMargin;
+	
+	CairoDockIconsGeometry *pGeometry = cairo_dock_get_icons_geometry (pDock);
+	_gather_icons_geometry (pGeometry, pIconList);
+	guint i, j, n = pGeometry->iNbIcons;
+	gdouble *fXMin = pGeometry->fXMin, *fXMax = pGeometry->fXMax, *fX = pGeometry->fX;
+	
+	// We reset extreme positions of the icons.
+	for (i = 0; i < n; i ++)
+	{
+		fXMax[i] = -1e4;
+		fXMin[i] = 1e4;
+	}
+	
+	/* We simulate the move of the cursor in all the width of the dock and we
+	 * get the maximum width and the balance position for each icon.
+	 * This is done on the packed geometry only, and written back to the icons once at the end.
+	 */
+	for (j = 0; j <= n; j ++)
+	{
+		if (j < n)
+			_compute_wave_linear (pGeometry, pGeometry->fXAtRest[j], pDock->fMagnitudeMax, fFlatDockWidth, 0, 0, 0.5, 0, pDock->container.bDirectionUp);
+		else  // last calculation at the extreme right of the dock.
+			_compute_wave_linear (pGeometry, fFlatDockWidth - 1, pDock->fMagnitudeMax, fFlatDockWidth, 0, 0, pDock->fAlign, 0, pDock->container.bDirectionUp);
+		
+		for (i = 0; i < n; i ++)
 		{
-			icon = ic->data;
-			//if (ic == pIconList)
-			//	cd_debug ("fX : %.2f - %.2f", icon->fX, offset);
-			icon->fX -= offset;
+			gdouble fRight = fX[i] + pGeometry->fWidth[i] * pGeometry->fScale[i];
+			if (fRight > fXMax[i])
+				fXMax[i] = fRight;
+			if (fX[i] < fXMin[i])
+				fXMin[i] = fX[i];
 		}
 	}
 	
-	icon = pointed_ic->data;
-	return (icon->bPointed ? icon : NULL);
+	fMaxDockWidth = (fXMax[n-1] - fXMin[0]) * fWidthConstraintFactor + fExtraWidth;
+	fMaxDockWidth = ceil (fMaxDockWidth) + 1;
+	
+	for (i = 0; i < n; i ++)
+	{
+		fXMin[i] += fMaxDockWidth / 2;
+		fXMax[i] += fMaxDockWidth / 2;
+		//g_print ("%s : [%d;%d]\n", icon->cName, (int) icon->fXMin, (int) icon->fXMax);
+		fX[i] = pGeometry->fXAtRest[i];
+		pGeometry->fScale[i] = 1;
+	}
+	_scatter_icons_geometry (pGeometry, TRUE);
+	
+	return fMaxDockWidth;
+}
+
+Icon * cairo_dock_calculate_wave_with_position_linear (GList *pIconList, int x_abs, gdouble fMagnitude, double fFlatDockWidth, int iWidth, int iHeight, double fAlign, double fFoldingFactor, gboolean bDirectionUp)
+{
+	//g_print (">>>>>%s (%d/%.2f, %dx%d, %.2f, %.2f)\n", __func__, x_abs, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor);
+	s_scratchGeometry.bDirty = TRUE;  // the list can be anything
+	return _calculate_wave_linear (&s_scratchGeometry, pIconList, x_abs, fMagnitude, fFlatDockWidth, iWidth, iHeight, fAlign, fFoldingFactor, bDirectionUp);
 }
 
 Icon *cairo_dock_apply_wave_effect_linear (CairoDock *pDock)
@@ -758,7 +872,7 @@ Icon *cairo_dock_apply_wave_effect_linear (CairoDock *pDock)
 
 	//\_______________ We compute all parameters for the icons.
 	double fMagnitude = cairo_dock_calculate_magnitude (pDock->iMagnitudeIndex);  // * pDock->fMagnitudeMax
-	Icon *pPointedIcon = cairo_dock_calculate_wave_with_position_linear (pDock->icons, x_abs, fMagnitude, pDock->fFlatDockWidth, pDock->container.iWidth, pDock->container.iHeight, pDock->fAlign, pDock->fFoldingFactor, pDock->container.bDirectionUp);  // iMaxDockWidth
+	Icon *pPointedIcon = _calculate_wave_linear (cairo_dock_get_icons_geometry (pDock), pDock->icons, x_abs, fMagnitude, pDock->fFlatDockWidth, pDock->container.iWidth, pDock->container.iHeight, pDock->fAlign, pDock->fFoldingFactor, pDock->container.bDirectionUp);  // iMaxDockWidth
 	return pPointedIcon;
 }
 
@@ -75,6 +75,47 @@ Icon *cairo_dock_calculate_dock_icons (CairoDock *pDock);
 */
 void cairo_dock_show_subdock (Icon *pPointedIcon, CairoDock *pParentDock);
 
+/// Geometry of the icons of a linear dock, packed into arrays (one entry per icon, in the same order as the icons list). The layout works on it rather than on the icons, and copies the result back into them in a single pass.
+struct _CairoDockIconsGeometry {
+	/// number of icons
+	guint iNbIcons;
+	/// allocated size of the arrays
+	guint iAllocated;
+	/// the icons
+	Icon **pIcons;
+	// inputs, copied from the icons before each layout
+	gdouble *fXAtRest;
+	gdouble *fWidth;
+	gdouble *fHeight;
+	gdouble *fInsertRemoveFactor;
+	gdouble *fXMin;
+	gdouble *fXMax;
+	// outputs of the layout
+	gdouble *fPhase;
+	gdouble *fScale;
+	gdouble *fX;
+	gdouble *fY;
+	/// index of the icon under the mouse, or -1
+	gint iPointedIcon;
+	/// whether this icon is really pointed (the mouse could be on the edge of the dock)
+	gboolean bPointed;
+	/// TRUE if the list of icons has changed since the arrays were filled
+	gboolean bDirty;
+};
+
+/** Get the packed geometry of the icons of a dock, as computed by the last layout.
+*@param pDock the dock.
+*@return the geometry, owned by the dock.
+*/
+CairoDockIconsGeometry *cairo_dock_get_icons_geometry (CairoDock *pDock);
+
+/** Tell the layout that icons have been inserted into or removed from a dock.
+*@param pDock the dock.
+*/
+void cairo_dock_invalidate_icons_geometry (CairoDock *pDock);
+
+void cairo_dock_free_icons_geometry (CairoDockIconsGeometry *pGeometry);
+
 /** Calculate the position at rest (when the mouse is outside of the dock and its size is normal) of the icons of a linear dock.
 *@param pDock the dock.
 */
@@ -52,7 +52,7 @@
 #include "cairo-dock-container-priv.h"
 #include "cairo-dock-dock-facility.h"
 #include "cairo-dock-dock-manager.h"
-#include "cairo-dock-dialog-priv.h" //gldi_dialogs_refresh_all, gldi_dialogs_replace_all
+#include "cairo-dock-dialog-priv.h" //gldi_dialogs_refresh_all, gldi_dialogs_replace_all, gldi_dialogs_trigger_replace_all
 #include "cairo-dock-dock-priv.h" // also includes dock-factory
 
 // dependencies
@@ -60,6 +60,7 @@ extern CairoDockHidingEffect *g_pHidingBackend;
 extern CairoDockHidingEffect *g_pKeepingBelowBackend;
 extern gboolean g_bUseOpenGL;
 extern CairoDockGLConfig g_openglConfig;
+extern gboolean g_bShowDamage;
 extern gchar *g_cConfFile;
 extern gchar *g_cCurrentThemePath;
 
@@ -119,6 +120,45 @@ void _dock_size_update_opengl (CairoDock *pDock)
 	pDock->bNeedSizeUpdate = FALSE;
 }
 
+static void _get_damage_color (double *pColor)
+{
+	// change the color at each redraw, so that successive frames can be told apart
+	static int s_iDamageCount = 0;
+	s_iDamageCount = (s_iDamageCount + 1) % 3;
+	pColor[0] = (s_iDamageCount == 0);
+	pColor[1] = (s_iDamageCount == 1);
+	pColor[2] = (s_iDamageCount == 2);
+}
+
+static void _show_damage_cairo (cairo_t *pCairoContext)
+{
+	// the context is clipped to the redrawn area
+	double color[3];
+	_get_damage_color (color);
+	cairo_save (pCairoContext);
+	cairo_set_source_rgba (pCairoContext, color[0], color[1], color[2], .25);
+	cairo_set_operator (pCairoContext, CAIRO_OPERATOR_OVER);
+	cairo_paint (pCairoContext);
+	cairo_restore (pCairoContext);
+}
+
+static void _show_damage_opengl (void)
+{
+	// the scissor box is still set to the redrawn area
+	double color[3];
+	_get_damage_color (color);
+	glPushMatrix ();
+	glLoadIdentity ();
+	glDisable (GL_TEXTURE_2D);
+	glDisable (GL_DEPTH_TEST);
+	glEnable (GL_BLEND);
+	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glColor4f (color[0], color[1], color[2], .25);
+	glRectf (-1e5, -1e5, 1e5, 1e5);
+	glColor4f (1., 1., 1., 1.);
+	glPopMatrix ();
+}
+
 static gboolean _on_expose (G_GNUC_UNUSED GtkWidget *pWidget, cairo_t *pCairoContext, CairoDock *pDock)
 {
 	gboolean bIsLoading = cairo_dock_is_loading ();
@@ -156,6 +196,9 @@ static gboolean _on_expose (G_GNUC_UNUSED GtkWidget *pWidget, cairo_t *pCairoCon
 			gldi_object_notify (pDock, NOTIFICATION_RENDER, pDock, NULL);
 		}
 		
+		if (g_bShowDamage)
+			_show_damage_opengl ();
+		
 		gldi_gl_container_end_draw (CAIRO_CONTAINER (pDock));
 	}
 	else if (! g_bUseOpenGL && pDock->pRenderer->render != NULL)  // cairo rendering
@@ -174,6 +217,9 @@ static gboolean _on_expose (G_GNUC_UNUSED GtkWidget *pWidget, cairo_t *pCairoCon
 		{
 			gldi_object_notify (pDock, NOTIFICATION_RENDER, pDock, pCairoContext);
 		}
+		
+		if (g_bShowDamage)
+			_show_damage_cairo (pCairoContext);
 	}
 	
 	if (!bIsLoading && pDock->bWMIconsNeedUpdate)
@@ -1356,7 +1402,7 @@ static gboolean _on_configure (GtkWidget* pWidget, GdkEventConfigure* pEvent, Ca
 		//g_print ("configure size %s\n", pDock->cDockName);
 		cairo_dock_trigger_set_WM_icons_geometry (pDock);  // changement de position ou de taille du dock => on replace les icones.
 		
-		gldi_dialogs_replace_all ();
+		gldi_dialogs_trigger_replace_all ();
 		
 		if (/**bIsNowSized*/bSizeUpdated && g_bUseOpenGL)  // in OpenGL, the context is linked to the window; now that the window has a correct size, the context is ready -> draw things that couldn't be drawn until now.
 		{
@@ -1405,7 +1451,7 @@ static gboolean _on_configure (GtkWidget* pWidget, GdkEventConfigure* pEvent, Ca
 		//g_print ("configure x,y\n");
 		cairo_dock_trigger_set_WM_icons_geometry (pDock);  // changement de position de la fenetre du dock => on replace les icones.
 		
-		gldi_dialogs_replace_all ();
+		gldi_dialogs_trigger_replace_all ();
 	}
 	
 	if (pDock->iRefCount == 0 && (bSizeUpdated || bPositionUpdated))
@@ -1720,7 +1766,7 @@ static gboolean _cairo_dock_grow_up (CairoDock *pDock)
 
 	if (pDock->fFoldingFactor != 0)
 	{
-		int iAnimationDeltaT = cairo_dock_get_animation_delta_t (pDock);
+		int iAnimationDeltaT = cairo_dock_get_animation_real_delta_t (pDock);
 		pDock->fFoldingFactor -= (double) iAnimationDeltaT / myBackendsParam.iUnfoldingDuration;
 		if (pDock->fFoldingFactor < 0)
 			pDock->fFoldingFactor = 0;
@@ -1784,7 +1830,7 @@ static gboolean _cairo_dock_shrink_down (CairoDock *pDock)
 	//\_________________ On replie le dock.
 	if (pDock->fFoldingFactor != 0 && pDock->fFoldingFactor != 1)
 	{
-		int iAnimationDeltaT = cairo_dock_get_animation_delta_t (pDock);
+		int iAnimationDeltaT = cairo_dock_get_animation_real_delta_t (pDock);
 		pDock->fFoldingFactor += (double) iAnimationDeltaT / myBackendsParam.iUnfoldingDuration;
 		if (pDock->fFoldingFactor > 1)
 			pDock->fFoldingFactor = 1;
@@ -1847,7 +1893,7 @@ static gboolean _cairo_dock_shrink_down (CairoDock *pDock)
 			cairo_dock_calculate_dock_icons (pDock);  // relance le grossissement si on est dedans.
 		}
 		if (!pDock->bIsGrowingUp)
-			gldi_dialogs_replace_all ();
+			gldi_dialogs_trigger_replace_all ();
 		return (!pDock->bIsGrowingUp && (pDock->fDecorationsOffsetX != 0 || (pDock->fFoldingFactor != 0 && pDock->fFoldingFactor != 1)));
 	}
 	else
@@ -1895,7 +1941,7 @@ static gboolean _cairo_dock_hide (CairoDock *pDock)
 			
 			pDock->pRenderer->calculate_icons (pDock);
 			
-			gldi_dialogs_replace_all ();
+			gldi_dialogs_trigger_replace_all ();
 			
 			if (bVisibleIconsPresent)  // il y'a des icones a montrer progressivement, on reste dans la boucle.
 			{
@@ -2005,10 +2051,33 @@ static gboolean _cairo_dock_handle_inserting_removing_icons (CairoDock *pDock)
 	return TRUE;
 }
 
+static void _damage_icon_in_hidden_dock (Icon *icon, CairoDock *pDock)
+{
+	// the animation can be larger than the icon itself, so take the whole thickness of the dock, plus the margin of the hidden background
+	GdkRectangle area;
+	cairo_dock_compute_icon_area (icon, CAIRO_CONTAINER (pDock), &area);
+	if (pDock->container.bIsHorizontal)
+	{
+		area.x -= 2;
+		area.width += 4;
+		area.y = 0;
+		area.height = pDock->container.iHeight;
+	}
+	else
+	{
+		area.y -= 2;
+		area.height += 4;
+		area.x = 0;
+		area.width = pDock->container.iHeight;
+	}
+	gldi_container_add_damage_area (CAIRO_CONTAINER (pDock), &area);
+}
+
 static gboolean _cairo_dock_dock_animation_loop (GldiContainer *pContainer)
 {
 	CairoDock *pDock = CAIRO_DOCK (pContainer);
 	gboolean bContinue = FALSE;
+	gldi_container_start_collecting_damage (pContainer);  // everything redrawn during this frame is invalidated at once at the end
 	gboolean bUpdateSlowAnimation = FALSE;
 	pContainer->iAnimationStep ++;
 	if (pContainer->iAnimationStep * pContainer->iAnimationDeltaT >= CAIRO_DOCK_MIN_SLOW_DELTA_T)
@@ -2071,7 +2140,7 @@ static gboolean _cairo_dock_dock_animation_loop (GldiContainer *pContainer)
 			
 			if ((icon->bIsDemandingAttention || icon->bAlwaysVisible) && cairo_dock_is_hidden (pDock))  // animation d'une icone demandant l'attention dans un dock cache => on force le dessin qui normalement ne se fait pas.
 			{
-				gtk_widget_queue_draw (pContainer->pWidget);
+				_damage_icon_in_hidden_dock (icon, pDock);
 			}
 			
 			bContinue |= bIconIsAnimating;
@@ -2107,7 +2176,7 @@ static gboolean _cairo_dock_dock_animation_loop (GldiContainer *pContainer)
 	if (! _cairo_dock_handle_inserting_removing_icons (pDock))
 	{
 		cd_debug ("ce dock n'a plus de raison d'etre");
-		return FALSE;
+		return FALSE;  // the dock has been destroyed, along with its damage
 	}
 	
 	if (bUpdateSlowAnimation)
@@ -2116,6 +2185,8 @@ static gboolean _cairo_dock_dock_animation_loop (GldiContainer *pContainer)
 	}
 	gldi_object_notify (pDock, NOTIFICATION_UPDATE, pDock, &bContinue);
 	
+	gldi_container_flush_damage (pContainer);
+	
 	if (! bContinue && ! pContainer->bKeepSlowAnimation)
 	{
 		pContainer->iSidGLAnimation = 0;
@@ -2245,6 +2316,7 @@ static void _detach_icon (GldiContainer *pContainer, Icon *icon)
 	//\___________________ On l'enleve de la liste.
 	pDock->icons = g_list_delete_link (pDock->icons, ic);
 	ic = NULL;
+	cairo_dock_invalidate_icons_geometry (pDock);
 	pDock->fFlatDockWidth -= icon->fWidth + myIconsParam.iIconGap;
 	
 	//\___________________ On enleve le separateur si c'est la derniere icone de son type.
@@ -2350,6 +2422,7 @@ static void _insert_icon (GldiContainer *pContainer, Icon *icon, gboolean bAnima
 	pDock->icons = g_list_insert_sorted (pDock->icons,
 		icon,
 		(GCompareFunc)cairo_dock_compare_icons_order);
+	cairo_dock_invalidate_icons_geometry (pDock);
 	
 	//\______________ set the icon size, now that it's inside a container.
 	int wi = icon->image.iWidth, hi = icon->image.iHeight;
@@ -2614,6 +2687,7 @@ void cairo_dock_remove_icons_from_dock (CairoDock *pDock, CairoDock *pReceivingD
 	g_return_if_fail (pReceivingDock != NULL);
 	GList *pIconsList = pDock->icons;
 	pDock->icons = NULL;
+	cairo_dock_invalidate_icons_geometry (pDock);
 	Icon *icon;
 	GList *ic;
 	for (ic = pIconsList; ic != NULL; ic = ic->next)
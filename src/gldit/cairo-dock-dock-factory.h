@@ -302,7 +302,9 @@ struct _CairoDock {
 	/// is then subsequently freed; e.g. Cairo-Penguin or Status-Notifier.
 	GList *applets;
 	
-	gpointer reserved[2];
+	/// packed geometry of the icons, used by the linear layout (see cairo_dock_get_icons_geometry).
+	CairoDockIconsGeometry *pIconsGeometry;
+	gpointer reserved[1];
 };
 
 
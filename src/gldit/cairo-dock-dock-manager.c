@@ -1971,6 +1971,8 @@ static void reset_object (GldiObject *obj)
 		gldi_object_unref (GLDI_OBJECT(pIcon));
 	}
 	g_list_free (icons);
+	cairo_dock_free_icons_geometry (pDock->pIconsGeometry);
+	pDock->pIconsGeometry = NULL;
 	
 	// if it's a sub-dock, ensure the main icon looses its sub-dock
 	if (pDock->iRefCount > 0)
@@ -2043,6 +2045,7 @@ static gboolean delete_object (GldiObject *obj)
 	// delete all the icons
 	GList *icons = pDock->icons;
 	pDock->icons = NULL;  // remove the icons first, to avoid any use of 'icons' in the 'destroy' callbacks.
+	cairo_dock_invalidate_icons_geometry (pDock);
 	GList *ic;
 	for (ic = icons; ic != NULL; ic = ic->next)
 	{
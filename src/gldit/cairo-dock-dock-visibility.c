@@ -17,6 +17,8 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <string.h>  // memcmp
+
 #include "gldi-config.h"
 #include "cairo-dock-dock-facility.h"
 #include "cairo-dock-container.h"
@@ -36,8 +38,10 @@
 static GldiDockVisibilityBackend s_backend = {0};
 
 static inline gboolean _window_overlaps_area (const GldiWindowActor *actor, const GtkAllocation *pArea);
-static inline gboolean _window_overlaps_dock (const GldiWindowActor *actor, const CairoDock *pDock);
-static inline gboolean _dock_has_overlapping_window (GtkAllocation *pArea);
+static gboolean _has_overlap (CairoDock *pDock);
+static void _update_window_overlaps (GldiWindowActor *actor);
+static void _forget_window_overlaps (GldiWindowActor *actor);
+static void _invalidate_overlaps (void);
 
 
 static void _get_dock_geometry (const CairoDock *pDock, GtkAllocation *pArea)
@@ -95,57 +99,6 @@ static void _get_dock_geometry (const CairoDock *pDock, GtkAllocation *pArea)
 	}
 }
 
-static void _show_if_no_overlapping_window (CairoDock *pDock, G_GNUC_UNUSED gpointer data)
-{
-	if (pDock->iVisibility != CAIRO_DOCK_VISI_AUTO_HIDE_ON_OVERLAP_ANY)
-		return ;
-	if (cairo_dock_is_temporary_hidden (pDock))
-	{
-		if (!gldi_dock_has_overlapping_window (pDock))
-		{
-			cairo_dock_deactivate_temporary_auto_hide (pDock);
-		}
-	}
-}
-
-static void _hide_if_overlap (CairoDock *pDock, GldiWindowActor *pAppli)
-{
-	if (pDock->iVisibility != CAIRO_DOCK_VISI_AUTO_HIDE_ON_OVERLAP_ANY)
-		return ;
-	if (! cairo_dock_is_temporary_hidden (pDock))
-	{
-		if (gldi_window_is_on_current_desktop (pAppli) && _window_overlaps_dock (pAppli, pDock))
-		{
-			cairo_dock_activate_temporary_auto_hide (pDock);
-		}
-	}
-}
-
-static void _hide_if_overlap_or_show_if_no_overlapping_window (CairoDock *pDock, GldiWindowActor *pAppli)
-{
-	if (pDock->iVisibility != CAIRO_DOCK_VISI_AUTO_HIDE_ON_OVERLAP_ANY)
-		return ;
-	GtkAllocation area;
-	_get_dock_geometry (pDock, &area);
-	if (_window_overlaps_area (pAppli, &area))  // cette fenetre peut provoquer l'auto-hide.
-	{
-		if (! cairo_dock_is_temporary_hidden (pDock))
-		{
-			cairo_dock_activate_temporary_auto_hide (pDock);
-		}
-	}
-	else  // ne gene pas/plus.
-	{
-		if (cairo_dock_is_temporary_hidden (pDock))
-		{
-			if (!_dock_has_overlapping_window (&area))
-			{
-				cairo_dock_deactivate_temporary_auto_hide (pDock);
-			}
-		}
-	}
-}
-
 static void _hide_show_if_on_our_way (CairoDock *pDock, GldiWindowActor *pCurrentAppli)
 {
 	if (pDock->iVisibility != CAIRO_DOCK_VISI_AUTO_HIDE_ON_OVERLAP)
@@ -192,14 +145,14 @@ static void _hide_if_any_overlap_or_show (CairoDock *pDock, G_GNUC_UNUSED gpoint
 		return ;
 	if (cairo_dock_is_temporary_hidden (pDock))
 	{
-		if (!gldi_dock_has_overlapping_window (pDock))
+		if (!_has_overlap (pDock))
 		{
 			cairo_dock_deactivate_temporary_auto_hide (pDock);
 		}
 	}
 	else
 	{
-		if (gldi_dock_has_overlapping_window (pDock))
+		if (_has_overlap (pDock))
 		{
 			cairo_dock_activate_temporary_auto_hide (pDock);
 		}
@@ -215,7 +168,8 @@ static gboolean _on_window_created (G_GNUC_UNUSED gpointer data, GldiWindowActor
 {
 	// docks visibility on overlap any
 	/// see how to handle modal dialogs ...
-	gldi_docks_foreach_root ((GFunc)_hide_if_overlap, actor);
+	_update_window_overlaps (actor);
+	gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
 	
 	return GLDI_NOTIFICATION_LET_PASS;
 }
@@ -223,9 +177,10 @@ static gboolean _on_window_created (G_GNUC_UNUSED gpointer data, GldiWindowActor
 static gboolean _on_window_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
 	// docks visibility on overlap any
-	gboolean bIsHidden = actor->bIsHidden;  // the window is already destroyed, but the actor is still valid (it represents the last state of the window); temporarily make it hidden so that it doesn't overlap the dock (that's a bit tricky, we could also add an "except-this-window" parameter to 'gldi_dock_has_overlapping_window()')
+	gboolean bIsHidden = actor->bIsHidden;  // the window is already destroyed, but the actor is still valid (it represents the last state of the window); temporarily make it hidden so that it doesn't overlap the dock, even if the overlapping windows are counted again meanwhile.
 	actor->bIsHidden = TRUE;
-	gldi_docks_foreach_root ((GFunc)_show_if_no_overlapping_window, NULL);
+	_forget_window_overlaps (actor);
+	gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
 	actor->bIsHidden = bIsHidden;
 	
 	return GLDI_NOTIFICATION_LET_PASS;
@@ -234,14 +189,8 @@ static gboolean _on_window_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowAct
 static gboolean _on_window_size_position_changed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
 	// docks visibility on overlap any
-	if (! gldi_window_is_on_current_desktop (actor))  // not on this desktop/viewport any more
-	{
-		gldi_docks_foreach_root ((GFunc)_show_if_no_overlapping_window, NULL);
-	}
-	else  // elle est sur le viewport courant.
-	{
-		gldi_docks_foreach_root ((GFunc)_hide_if_overlap_or_show_if_no_overlapping_window, actor);
-	}
+	_update_window_overlaps (actor);  // it may also have left the current desktop/viewport
+	gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
 	
 	// docks visibility on overlap active
 	if (actor == gldi_windows_get_active())  // c'est la fenetre courante qui a change de bureau.
@@ -264,12 +213,10 @@ static gboolean _on_window_state_changed (G_GNUC_UNUSED gpointer data, GldiWindo
 	}
 	
 	// docks visibility on overlap any
-	if (bHiddenChanged)
+	if (bHiddenChanged)  // la fenetre se cache ou reapparait.
 	{
-		if (!actor->bIsHidden)  // la fenetre reapparait.
-			gldi_docks_foreach_root ((GFunc)_hide_if_overlap, actor);
-		else  // la fenetre se cache.
-			gldi_docks_foreach_root ((GFunc)_show_if_no_overlapping_window, NULL);
+		_update_window_overlaps (actor);
+		gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
 	}
 	
 	return GLDI_NOTIFICATION_LET_PASS;
@@ -284,20 +231,17 @@ static gboolean _on_window_desktop_changed (G_GNUC_UNUSED gpointer data, GldiWin
 	}
 	
 	// docks visibility on overlap any
-	if (gldi_window_is_on_current_desktop (actor))  // petite optimisation : si l'appli arrive sur le bureau courant, on peut se contenter de ne verifier qu'elle.
-	{
-		gldi_docks_foreach_root ((GFunc)_hide_if_overlap, actor);
-	}
-	else  // la fenetre n'est plus sur le bureau courant.
-	{
-		gldi_docks_foreach_root ((GFunc)_show_if_no_overlapping_window, NULL);
-	}
+	_update_window_overlaps (actor);
+	gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
 	
 	return GLDI_NOTIFICATION_LET_PASS;
 }
 
 static gboolean _on_desktop_changed (G_GNUC_UNUSED gpointer data)
 {
+	// the windows on the current desktop are not the same any more
+	_invalidate_overlaps ();
+	
 	// docks visibility on overlap active
 	GldiWindowActor *pCurrentAppli = gldi_windows_get_active ();
 	gldi_docks_foreach_root ((GFunc)_hide_show_if_on_our_way, pCurrentAppli);
@@ -308,6 +252,13 @@ static gboolean _on_desktop_changed (G_GNUC_UNUSED gpointer data)
 	return GLDI_NOTIFICATION_LET_PASS;
 }
 
+static gboolean _on_desktop_geometry_changed (G_GNUC_UNUSED gpointer data)
+{
+	_invalidate_overlaps ();
+	gldi_docks_foreach_root ((GFunc)_hide_if_any_overlap_or_show, NULL);
+	
+	return GLDI_NOTIFICATION_LET_PASS;
+}
 
 static gboolean _on_active_window_changed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
 {
@@ -330,35 +281,112 @@ static inline gboolean _window_overlaps_area (const GldiWindowActor *actor, cons
 		pWindowGeometry->y + pWindowGeometry->height > pArea->y);
 }
 
-static inline gboolean _window_overlaps_dock (const GldiWindowActor *actor, const CairoDock *pDock)
+static gboolean _window_can_overlap (const GldiWindowActor *actor)
 {
-	if (actor->bIsHidden || !actor->bDisplayed) return FALSE;
-	GtkAllocation area;
-	_get_dock_geometry (pDock, &area);
-	return _window_overlaps_area (actor, &area);
+	return (! actor->bIsHidden && actor->bDisplayed && gldi_window_is_on_current_desktop ((GldiWindowActor*)actor));
+}
+
+
+  /////////////////////////
+ // Overlapping windows //
+/////////////////////////
+
+// For each dock that has been queried, the set of the windows that overlap it. It is updated window by window from the notifications, so that an event only costs a test per dock; the set is rebuilt from all the windows only when the dock's geometry or the current desktop has changed.
+typedef struct {
+	GtkAllocation area;  // geometry of the dock the set has been built for
+	gboolean bValid;  // FALSE when the set has to be rebuilt
+	GHashTable *pWindows;  // set of the windows overlapping 'area'
+	} CDDockOverlaps;
+
+static GHashTable *s_pDockOverlaps = NULL;  // dock -> CDDockOverlaps
+
+static void _free_dock_overlaps (CDDockOverlaps *pOverlaps)
+{
+	g_hash_table_destroy (pOverlaps->pWindows);
+	g_free (pOverlaps);
 }
 
-static gboolean _window_is_overlapping_dock (GldiWindowActor *actor, gpointer data)
+static void _add_if_overlapping (GldiWindowActor *actor, CDDockOverlaps *pOverlaps)
 {
-	const GtkAllocation *pArea = (const GtkAllocation*)data;
-	if (gldi_window_is_on_current_desktop (actor) && ! actor->bIsHidden && actor->bDisplayed)
+	if (_window_can_overlap (actor) && _window_overlaps_area (actor, &pOverlaps->area))
+		g_hash_table_add (pOverlaps->pWindows, actor);
+}
+
+static CDDockOverlaps *_get_dock_overlaps (CairoDock *pDock)
+{
+	if (s_pDockOverlaps == NULL)
+		s_pDockOverlaps = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)_free_dock_overlaps);
+	CDDockOverlaps *pOverlaps = g_hash_table_lookup (s_pDockOverlaps, pDock);
+	if (pOverlaps == NULL)
 	{
-		return _window_overlaps_area (actor, pArea);
+		pOverlaps = g_new0 (CDDockOverlaps, 1);
+		pOverlaps->pWindows = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (s_pDockOverlaps, pDock, pOverlaps);
 	}
-	return FALSE;
+	
+	GtkAllocation area;
+	_get_dock_geometry (pDock, &area);
+	if (! pOverlaps->bValid || memcmp (&area, &pOverlaps->area, sizeof (GtkAllocation)) != 0)  // the dock has moved or has been resized, or the current desktop has changed -> check all the windows
+	{
+		pOverlaps->area = area;
+		g_hash_table_remove_all (pOverlaps->pWindows);
+		gldi_windows_foreach_unordered ((GFunc)_add_if_overlapping, pOverlaps);
+		pOverlaps->bValid = TRUE;
+	}
+	return pOverlaps;
+}
+
+static void _update_window_in_dock_overlaps (G_GNUC_UNUSED CairoDock *pDock, CDDockOverlaps *pOverlaps, GldiWindowActor *actor)
+{
+	if (! pOverlaps->bValid)  // will be rebuilt anyway
+		return;
+	if (_window_can_overlap (actor) && _window_overlaps_area (actor, &pOverlaps->area))
+		g_hash_table_add (pOverlaps->pWindows, actor);
+	else
+		g_hash_table_remove (pOverlaps->pWindows, actor);
+}
+static void _update_window_overlaps (GldiWindowActor *actor)
+{
+	if (s_pDockOverlaps != NULL)
+		g_hash_table_foreach (s_pDockOverlaps, (GHFunc)_update_window_in_dock_overlaps, actor);
+}
+
+static void _forget_window_in_dock_overlaps (G_GNUC_UNUSED CairoDock *pDock, CDDockOverlaps *pOverlaps, GldiWindowActor *actor)
+{
+	g_hash_table_remove (pOverlaps->pWindows, actor);
+}
+static void _forget_window_overlaps (GldiWindowActor *actor)
+{
+	if (s_pDockOverlaps != NULL)
+		g_hash_table_foreach (s_pDockOverlaps, (GHFunc)_forget_window_in_dock_overlaps, actor);
+}
+
+static void _invalidate_dock_overlaps (G_GNUC_UNUSED CairoDock *pDock, CDDockOverlaps *pOverlaps, G_GNUC_UNUSED gpointer data)
+{
+	pOverlaps->bValid = FALSE;
+}
+static void _invalidate_overlaps (void)
+{
+	if (s_pDockOverlaps != NULL)
+		g_hash_table_foreach (s_pDockOverlaps, (GHFunc)_invalidate_dock_overlaps, NULL);
 }
 
-static inline gboolean _dock_has_overlapping_window (GtkAllocation *pArea)
+static gboolean _on_dock_destroyed (G_GNUC_UNUSED gpointer data, CairoDock *pDock)
 {
-	return (gldi_windows_find (_window_is_overlapping_dock, pArea) != NULL);
+	if (s_pDockOverlaps != NULL)
+		g_hash_table_remove (s_pDockOverlaps, pDock);
+	return GLDI_NOTIFICATION_LET_PASS;
 }
 
+static gboolean _on_window_actor_destroyed (G_GNUC_UNUSED gpointer data, GldiWindowActor *actor)
+{
+	_forget_window_overlaps (actor);  // the actor is about to be freed
+	return GLDI_NOTIFICATION_LET_PASS;
+}
 
 static gboolean _has_overlap (CairoDock *pDock)
 {
-	GtkAllocation area;
-	_get_dock_geometry (pDock, &area);
-	return (gldi_windows_find (_window_is_overlapping_dock, &area) != NULL);
+	return (g_hash_table_size (_get_dock_overlaps (pDock)->pWindows) != 0);
 }
 
 gboolean gldi_dock_has_overlapping_window (CairoDock *pDock)
@@ -436,6 +464,18 @@ static void _start_default_backend (void)
 			NOTIFICATION_WINDOW_ACTIVATED,
 			(GldiNotificationFunc) _on_active_window_changed,
 			GLDI_RUN_FIRST, NULL);
+		gldi_object_register_notification (&myDesktopMgr,
+			NOTIFICATION_DESKTOP_GEOMETRY_CHANGED,
+			(GldiNotificationFunc) _on_desktop_geometry_changed,
+			GLDI_RUN_FIRST, NULL);
+		gldi_object_register_notification (&myWindowObjectMgr,
+			NOTIFICATION_DESTROY,
+			(GldiNotificationFunc) _on_window_actor_destroyed,
+			GLDI_RUN_FIRST, NULL);
+		gldi_object_register_notification (&myDockObjectMgr,
+			NOTIFICATION_DESTROY,
+			(GldiNotificationFunc) _on_dock_destroyed,
+			GLDI_RUN_FIRST, NULL);
 	}
 }
 
@@ -32,6 +32,7 @@
 #include "cairo-dock-overlay.h"
 #include "cairo-dock-style-manager.h"
 #include "cairo-dock-opengl-path.h"
+#include "cairo-dock-icon-manager.h"  // cairo_dock_get_magnification_profile
 
 #include "cairo-dock-draw-opengl.h"
 
@@ -256,15 +257,7 @@ static inline void _compute_icon_coordinate (Icon *icon, GldiContainer *pContain
 	if (icon->fGlideOffset != 0)
 	{
 		double fPhase =  icon->fPhase + icon->fGlideOffset * icon->fWidth / fRatio / myIconsParam.iSinusoidWidth * G_PI;
-		if (fPhase < 0)
-		{
-			fPhase = 0;
-		}
-		else if (fPhase > G_PI)
-		{
-			fPhase = G_PI;
-		}
-		fGlideScale = (1 + fDockMagnitude * myIconsParam.fAmplitude * sin (fPhase)) / icon->fScale;  // c'est un peu hacky ... il faudrait passer l'icone precedente en parametre ...
+		fGlideScale = (1 + fDockMagnitude * cairo_dock_get_magnification_profile (fPhase)) / icon->fScale;  // c'est un peu hacky ... il faudrait passer l'icone precedente en parametre ...
 		if (! pContainer->bDirectionUp)
 		{
 			if (pContainer->bIsHorizontal)
@@ -35,6 +35,7 @@
 #include "cairo-dock-windows-manager.h"
 #include "cairo-dock-style-manager.h"
 #include "cairo-dock-draw-opengl.h"  // pour cairo_dock_render_one_icon
+#include "cairo-dock-icon-manager.h"  // cairo_dock_get_magnification_profile
 #include "cairo-dock-overlay.h"  // cairo_dock_draw_icon_overlays_cairo
 #include "cairo-dock-draw.h"
 
@@ -546,15 +547,7 @@ void cairo_dock_render_one_icon (Icon *icon, CairoDock *pDock, cairo_t *pCairoCo
 	if (icon->fGlideOffset != 0 && (! myIconsParam.bConstantSeparatorSize || ! CAIRO_DOCK_ICON_TYPE_IS_SEPARATOR (icon)))
 	{
 		double fPhase =  icon->fPhase + icon->fGlideOffset * icon->fWidth / fRatio / myIconsParam.iSinusoidWidth * G_PI;
-		if (fPhase < 0)
-		{
-			fPhase = 0;
-		}
-		else if (fPhase > G_PI)
-		{
-			fPhase = G_PI;
-		}
-		fGlideScale = (1 + fDockMagnitude * pDock->fMagnitudeMax * myIconsParam.fAmplitude * sin (fPhase)) / icon->fScale;  // c'est un peu hacky ... il faudrait passer l'icone precedente en parametre ...
+		fGlideScale = (1 + fDockMagnitude * pDock->fMagnitudeMax * cairo_dock_get_magnification_profile (fPhase)) / icon->fScale;  // c'est un peu hacky ... il faudrait passer l'icone precedente en parametre ...
 		if (bDirectionUp)
 		{
 			if (bIsHorizontal)
@@ -461,6 +461,45 @@ void cairo_dock_compute_icon_area (Icon *icon, GldiContainer *pContainer, GdkRec
 	//g_print ("redraw : %d;%d %dx%d (%s)\n", pArea->x, pArea->y, pArea->width,pArea->height, icon->cName);
 }
 
+void cairo_dock_compute_icon_damage_area (Icon *icon, GldiContainer *pContainer, GdkRectangle *pArea)
+{
+	cairo_dock_compute_icon_area (icon, pContainer, pArea);
+	if (! CAIRO_DOCK_IS_DOCK (pContainer))
+		return;
+	
+	// the label is drawn between the icon and the edge of the dock (see cairo_dock_render_one_icon)
+	if (icon->label.pSurface != NULL && icon->iHideLabel == 0
+	&& (icon->bPointed || (icon->fScale > 1.01 && ! myIconsParam.bLabelForPointedIconOnly)))
+	{
+		GdkRectangle label;
+		if (pContainer->bIsHorizontal)  // centered on the icon, but kept inside the dock
+		{
+			label.x = floor (icon->fDrawX + (icon->fWidth * icon->fScale - icon->label.iWidth) / 2);
+			label.x = MAX (0, MIN (label.x, pContainer->iWidth - icon->label.iWidth));
+			label.width = icon->label.iWidth;
+			label.y = 0;
+			label.height = pContainer->iHeight;
+		}
+		else  // next to the icon, vertically centered
+		{
+			label.x = 0;
+			label.width = pContainer->iHeight;
+			label.y = floor (icon->fDrawX + (icon->fWidth * icon->fScale - icon->label.iHeight) / 2);
+			label.height = icon->label.iHeight;
+		}
+		gdk_rectangle_union (pArea, &label, pArea);
+	}
+	
+	// overlays are inside the icon, but can be placed on half-pixels
+	if (icon->pOverlays != NULL)
+	{
+		pArea->x --;
+		pArea->y --;
+		pArea->width += 2;
+		pArea->height += 2;
+	}
+}
+
 
 
 void cairo_dock_normalize_icons_order (GList *pIconList, CairoDockIconGroup iGroup)
@@ -532,6 +571,7 @@ void cairo_dock_move_icon_after_icon (CairoDock *pDock, Icon *icon1, Icon *icon2
 	pDock->icons = g_list_insert_sorted (pDock->icons,
 		icon1,
 		(GCompareFunc) cairo_dock_compare_icons_order);
+	cairo_dock_invalidate_icons_geometry (pDock);
 
 	//\_________________ On recalcule la largeur max, qui peut avoir ete influencee par le changement d'ordre.
 	cairo_dock_trigger_update_dock_size (pDock);
@@ -258,6 +258,13 @@ void cairo_dock_get_current_icon_size (Icon *pIcon, GldiContainer *pContainer, d
 */
 void cairo_dock_compute_icon_area (Icon *icon, GldiContainer *pContainer, GdkRectangle *pArea);
 
+/** Get the zone that must be redrawn when an icon changes: its area (see cairo_dock_compute_icon_area), plus its label and overlays if they are drawn outside of it.
+@param icon the icon
+@param pContainer its container
+@param pArea a rectangle filled with the zone to redraw.
+*/
+void cairo_dock_compute_icon_damage_area (Icon *icon, GldiContainer *pContainer, GdkRectangle *pArea);
+
 
 
 void cairo_dock_normalize_icons_order (GList *pIconList, CairoDockIconGroup iGroup);
@@ -37,10 +37,15 @@
 #include "cairo-dock-icon-facility.h"
 #include "cairo-dock-data-renderer.h"
 #include "cairo-dock-overlay.h"
+#include "cairo-dock-task.h"  // gldi_task_new_full
+#include "cairo-dock-container.h"  // gldi_container_get_gdk_window
+#include "cairo-dock-dock-factory.h"  // CAIRO_DOCK_IS_DOCK
+#include "cairo-dock-dock-priv.h"  // cairo_dock_trigger_redraw_subdock_content
 #include "cairo-dock-icon-factory.h"
 
 extern CairoDockImageBuffer g_pIconBackgroundBuffer;
-//extern gboolean g_bUseOpenGL;
+extern GldiContainer *g_pPrimaryContainer;
+extern gboolean g_bUseOpenGL;
 
 const gchar *s_cRendererNames[4] = {NULL, "Emblem", "Stack", "Box"};  // c'est juste pour realiser la transition entre le chiffre en conf, et un nom (limitation du panneau de conf). On garde le numero pour savoir rapidement sur laquelle on set.
 
@@ -90,6 +95,65 @@ gboolean cairo_dock_apply_icon_background_opengl (Icon *icon)
 	return FALSE;
 }
 
+static cairo_surface_t *_create_default_icon_surface (int w, int h)
+{
+	gchar *cIconPath = cairo_dock_search_image_s_path (CAIRO_DOCK_DEFAULT_ICON_NAME);
+	if (cIconPath == NULL)  // fichier non trouve.
+	{
+		cIconPath = g_strdup (GLDI_SHARE_DATA_DIR"/icons/"CAIRO_DOCK_DEFAULT_ICON_NAME);
+	}
+	cairo_surface_t *pSurface = cairo_dock_create_surface_from_image_simple (cIconPath,
+		w,
+		h);
+	g_free (cIconPath);
+	return pSurface;
+}
+
+// apply the background on the new image of the icon, free the previous one, and let the applet draw on the new one.
+static void _finish_icon_image (Icon *icon, cairo_surface_t *pPrevSurface, GLuint iPrevTexture)
+{
+	GldiModuleInstance *pInstance = icon->pModuleInstance;
+	
+	//\_____________ set the background if needed.
+	icon->bNeedApplyBackground = FALSE;
+	if (g_pIconBackgroundBuffer.pSurface != NULL && ! GLDI_OBJECT_IS_SEPARATOR_ICON (icon))
+	{
+		if (icon->image.iTexture != 0 && g_pIconBackgroundBuffer.iTexture != 0)
+		{
+			if (! cairo_dock_apply_icon_background_opengl (icon))  // couldn't draw on the texture
+			{
+				icon->bDamaged = FALSE;  // it's not a big deal, since we can draw under the existing image easily; so we don't need to damage the icon (it's expensive especially if it's an applet).
+				icon->bNeedApplyBackground = TRUE;  // just postpone it until drawing is possible.
+			}
+		}
+		else if (icon->image.pSurface != NULL)
+		{
+			cairo_t *pCairoIconBGContext = cairo_create (icon->image.pSurface);
+			cairo_set_operator (pCairoIconBGContext, CAIRO_OPERATOR_DEST_OVER);
+			cairo_dock_apply_image_buffer_surface_at_size (&g_pIconBackgroundBuffer, pCairoIconBGContext,
+				icon->image.iWidth, icon->image.iHeight,
+				0, 0, 1);
+			cairo_destroy (pCairoIconBGContext);
+		}
+	}
+	
+	//\______________ free the previous buffers.
+	if (pPrevSurface != NULL)
+		cairo_surface_destroy (pPrevSurface);
+	if (iPrevTexture != 0)
+		_cairo_dock_delete_texture (iPrevTexture);
+	
+	if (pInstance && icon->image.pSurface != NULL)
+	{
+		pInstance->pDrawContext = cairo_create (icon->image.pSurface);
+		if (!pInstance->pDrawContext || cairo_status (pInstance->pDrawContext) != CAIRO_STATUS_SUCCESS)
+		{
+			cd_warning ("couldn't initialize drawing context, applet won't be able to draw itself !");
+			pInstance->pDrawContext = NULL;
+		}
+	}
+}
+
 void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pContainer)
 {
 	if (icon->pContainer == NULL)
@@ -97,6 +161,8 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 		cd_warning ("/!\\ Icon %s is not inside a container !!!", icon->cName);  // it's ok if this happens, but it should be rare, and I'd like to know when, so be noisy.
 		return;
 	}
+	cairo_dock_cancel_icon_image_loading (icon);  // we're about to replace the image, so a pending one is obsolete.
+	
 	GldiModuleInstance *pInstance = icon->pModuleInstance;  // this is the only function where we destroy/create the icon's surface, so we must handle the cairo-context here.
 	if (pInstance && pInstance->pDrawContext != NULL)
 	{
@@ -128,60 +194,134 @@ void cairo_dock_load_icon_image (Icon *icon, G_GNUC_UNUSED GldiContainer *pConta
 		// if the reason is that the icon is already being removed, we don't care
 		if (cairo_dock_icon_is_being_removed (icon)) return;
 		
-		gchar *cIconPath = cairo_dock_search_image_s_path (CAIRO_DOCK_DEFAULT_ICON_NAME);
-		if (cIconPath == NULL)  // fichier non trouve.
-		{
-			cIconPath = g_strdup (GLDI_SHARE_DATA_DIR"/icons/"CAIRO_DOCK_DEFAULT_ICON_NAME);
-		}
 		int w = cairo_dock_icon_get_allocated_width (icon);
 		int h = cairo_dock_icon_get_allocated_height (icon);
-		cairo_surface_t *pSurface = cairo_dock_create_surface_from_image_simple (cIconPath,
-			w,
-			h);
+		cairo_surface_t *pSurface = _create_default_icon_surface (w, h);
 		cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, w, h);
-		g_free (cIconPath);
 	}
 	
-	//\_____________ set the background if needed.
-	icon->bNeedApplyBackground = FALSE;
-	if (g_pIconBackgroundBuffer.pSurface != NULL && ! GLDI_OBJECT_IS_SEPARATOR_ICON (icon))
+	//\_____________ set the background, and free the previous buffers.
+	_finish_icon_image (icon, pPrevSurface, iPrevTexture);
+}
+
+
+  /////////////////////
+ /// ASYNC LOADING ///
+/////////////////////
+
+typedef struct {
+	Icon *pIcon;  // only accessed in the main thread.
+	gchar *cImagePath;
+	int iWidth, iHeight;
+	double fScale;
+	cairo_surface_t *pSurface;  // the decoded image.
+} CairoIconImageLoader;
+
+static void _decode_icon_image (CairoIconImageLoader *pLoader)
+{
+	pLoader->pSurface = cairo_dock_create_surface_from_image_in_thread (pLoader->cImagePath,
+		pLoader->iWidth,
+		pLoader->iHeight,
+		pLoader->fScale);
+}
+
+static gboolean _swap_icon_image (CairoIconImageLoader *pLoader)
+{
+	Icon *icon = pLoader->pIcon;
+	if (icon->image.iWidth == pLoader->iWidth && icon->image.iHeight == pLoader->iHeight)  // the placeholder is still there (otherwise the icon has been loaded in the meantime by other means).
 	{
-		if (icon->image.iTexture != 0 && g_pIconBackgroundBuffer.iTexture != 0)
+		cairo_surface_t *pSurface = pLoader->pSurface;
+		pLoader->pSurface = NULL;
+		if (pSurface == NULL)  // the image couldn't be loaded, use the default one like the synchronous loading does.
 		{
-			if (! cairo_dock_apply_icon_background_opengl (icon))  // couldn't draw on the texture
-			{
-				icon->bDamaged = FALSE;  // it's not a big deal, since we can draw under the existing image easily; so we don't need to damage the icon (it's expensive especially if it's an applet).
-				icon->bNeedApplyBackground = TRUE;  // just postpone it until drawing is possible.
-			}
+			pSurface = _create_default_icon_surface (pLoader->iWidth, pLoader->iHeight);
 		}
-		else if (icon->image.pSurface != NULL)
+		else if (! g_bUseOpenGL)  // make it similar to the window, so that it's as fast to draw as any other icon.
 		{
-			cairo_t *pCairoIconBGContext = cairo_create (icon->image.pSurface);
-			cairo_set_operator (pCairoIconBGContext, CAIRO_OPERATOR_DEST_OVER);
-			cairo_dock_apply_image_buffer_surface_at_size (&g_pIconBackgroundBuffer, pCairoIconBGContext,
-				icon->image.iWidth, icon->image.iHeight,
-				0, 0, 1);
-			cairo_destroy (pCairoIconBGContext);
+			cairo_surface_t *pImageSurface = pSurface;
+			pSurface = cairo_dock_duplicate_surface (pImageSurface,
+				pLoader->iWidth, pLoader->iHeight,
+				pLoader->iWidth, pLoader->iHeight);
+			cairo_surface_destroy (pImageSurface);
+		}
+		
+		GldiModuleInstance *pInstance = icon->pModuleInstance;
+		if (pInstance && pInstance->pDrawContext != NULL)
+		{
+			cairo_destroy (pInstance->pDrawContext);
+			pInstance->pDrawContext = NULL;
+		}
+		cairo_surface_t *pPrevSurface = icon->image.pSurface;
+		GLuint iPrevTexture = icon->image.iTexture;
+		cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, pLoader->iWidth, pLoader->iHeight);
+		_finish_icon_image (icon, pPrevSurface, iPrevTexture);
+		
+		if (icon->pContainer != NULL)
+		{
+			cairo_dock_redraw_icon (icon);
+			if (CAIRO_DOCK_IS_DOCK (icon->pContainer) && CAIRO_DOCK (icon->pContainer)->iRefCount > 0)  // the icon may be drawn on the icon pointing on its sub-dock.
+				cairo_dock_trigger_redraw_subdock_content (CAIRO_DOCK (icon->pContainer));
 		}
 	}
 	
-	//\______________ free the previous buffers.
-	if (pPrevSurface != NULL)
-		cairo_surface_destroy (pPrevSurface);
-	if (iPrevTexture != 0)
-		_cairo_dock_delete_texture (iPrevTexture);
+	cairo_dock_cancel_icon_image_loading (icon);  // we're done; the task will be destroyed once we return.
+	return FALSE;
+}
+
+static void _free_icon_image_loader (CairoIconImageLoader *pLoader)
+{
+	if (pLoader->pSurface != NULL)
+		cairo_surface_destroy (pLoader->pSurface);
+	g_free (pLoader->cImagePath);
+	g_free (pLoader);
+}
+
+void cairo_dock_load_icon_image_from_file_async (Icon *icon, const gchar *cImagePath, int iWidth, int iHeight)
+{
+	g_return_if_fail (cImagePath != NULL && iWidth > 0 && iHeight > 0);
+	cairo_dock_cancel_icon_image_loading (icon);
 	
-	if (pInstance && icon->image.pSurface != NULL)
+	//\______________ set a placeholder until the image is decoded.
+	cairo_surface_t *pPlaceholder;
+	if (icon->image.pSurface != NULL)  // the icon is being reloaded (new size, new theme), so just stretch its current image; it's a mere copy and it avoids any blinking.
+		pPlaceholder = cairo_dock_duplicate_surface (icon->image.pSurface,
+			icon->image.iWidth, icon->image.iHeight,
+			iWidth, iHeight);
+	else
+		pPlaceholder = cairo_dock_create_blank_surface (iWidth, iHeight);
+	cairo_dock_load_image_buffer_from_surface (&icon->image, pPlaceholder, iWidth, iHeight);
+	
+	//\______________ decode the image in the background.
+	CairoIconImageLoader *pLoader = g_new0 (CairoIconImageLoader, 1);
+	pLoader->pIcon = icon;
+	pLoader->cImagePath = g_strdup (cImagePath);
+	pLoader->iWidth = iWidth;
+	pLoader->iHeight = iHeight;
+	pLoader->fScale = 1.;
+	if (g_pPrimaryContainer != NULL)  // same as cairo_dock_create_blank_surface
 	{
-		pInstance->pDrawContext = cairo_create (icon->image.pSurface);
-		if (!pInstance->pDrawContext || cairo_status (pInstance->pDrawContext) != CAIRO_STATUS_SUCCESS)
-		{
-			cd_warning ("couldn't initialize drawing context, applet won't be able to draw itself !");
-			pInstance->pDrawContext = NULL;
-		}
+		GdkWindow* gdkwindow = gldi_container_get_gdk_window (g_pPrimaryContainer);
+		pLoader->fScale = gdk_window_get_scale_factor (gdkwindow);
 	}
+	icon->pLoadImageTask = gldi_task_new_full (0,
+		(GldiGetDataAsyncFunc) _decode_icon_image,
+		(GldiUpdateSyncFunc) _swap_icon_image,
+		(GFreeFunc) _free_icon_image_loader,
+		pLoader);
+	gldi_task_set_priority (icon->pLoadImageTask, GLDI_TASK_PRIORITY_HIGH);  // the user is waiting for it
+	gldi_task_launch (icon->pLoadImageTask);
 }
 
+void cairo_dock_cancel_icon_image_loading (Icon *icon)
+{
+	if (icon->pLoadImageTask != NULL)
+	{
+		gldi_task_discard (icon->pLoadImageTask);
+		icon->pLoadImageTask = NULL;
+	}
+}
+
+
 void cairo_dock_load_icon_text (Icon *icon)
 {
 	cairo_dock_unload_image_buffer (&icon->label);
@@ -196,10 +336,12 @@ void cairo_dock_load_icon_text (Icon *icon)
 	}
 	
 	int iWidth, iHeight;
-	cairo_surface_t *pSurface = cairo_dock_create_surface_from_text ((cTruncatedName != NULL ? cTruncatedName : icon->cName),
+	cairo_surface_t *pSurface = cairo_dock_get_text_surface ((cTruncatedName != NULL ? cTruncatedName : icon->cName),
 		&myIconsParam.iconTextDescription,
+		1.,
+		0,
 		&iWidth,
-		&iHeight);
+		&iHeight);  // the label is never drawn on, so it can be shared
 	cairo_dock_load_image_buffer_from_surface (&icon->label, pSurface, iWidth, iHeight);
 	g_free (cTruncatedName);
 }
@@ -218,7 +360,7 @@ void cairo_dock_load_icon_quickinfo (Icon *icon)
 		if (iHeight / (myIconsParam.quickInfoTextDescription.iSize * fMaxScale) > 5)  // if the icon is very height (the text occupies less than 20% of the icon)
 			fMaxScale = MIN ((double)iHeight / (myIconsParam.quickInfoTextDescription.iSize * 5), MAX (1., 16./myIconsParam.quickInfoTextDescription.iSize) * fMaxScale);  // let's make it use 20% of the icon's height, limited to 16px
 		int w, h;
-		cairo_surface_t *pSurface = cairo_dock_create_surface_from_text_full (icon->cQuickInfo,
+		cairo_surface_t *pSurface = cairo_dock_get_text_surface (icon->cQuickInfo,
 			&myIconsParam.quickInfoTextDescription,
 			fMaxScale,
 			iWidth,  // limit the text to the width of the icon
@@ -172,6 +172,7 @@ struct _Icon {
 	//\____________ Other dynamic parameters.
 	guint iSidRedrawSubdockContent;
 	guint iSidLoadImage;
+	GldiTask *pLoadImageTask;  // pending asynchronous loading of the image, see cairo_dock_load_icon_image_from_file_async.
 	guint iSidDoubleClickDelay;
 	gint iNbDoubleClickListeners;
 	gint iHideLabel;
@@ -281,6 +282,19 @@ gboolean cairo_dock_apply_icon_background_opengl (Icon *icon);
 void cairo_dock_load_icon_image (Icon *icon, GldiContainer *pContainer);
 #define cairo_dock_reload_icon_image cairo_dock_load_icon_image
 
+/**Load the image of an icon from a file in the background. A placeholder is set on the icon immediately (its current image stretched to the new size, or a transparent image), and the decoded image is swapped in once it's ready. It is meant to be used inside the 'load_image' method of an icon; any previous pending loading is cancelled.
+*@param icon the icon.
+*@param cImagePath complete path to the image.
+*@param iWidth width of the image.
+*@param iHeight height of the image.
+*/
+void cairo_dock_load_icon_image_from_file_async (Icon *icon, const gchar *cImagePath, int iWidth, int iHeight);
+
+/**Cancel the pending asynchronous loading of the image of an icon, if any.
+*@param icon the icon.
+*/
+void cairo_dock_cancel_icon_image_loading (Icon *icon);
+
 /**Fill the label buffer (surface & texture) of a given icon, according to a text description.
 *@param icon the icon.
 */
@@ -74,6 +74,11 @@ static GtkIconTheme *s_pIconTheme = NULL;
 static gboolean s_bUseLocalIcons = FALSE;
 static gboolean s_bUseDefaultTheme = TRUE;
 static guint s_iSidReloadTheme = 0;
+static GHashTable *s_pIconPathCache = NULL;  // "name|size|scale" -> path of the icon, or NULL if it doesn't exist.
+static guint s_iNbIconPathCacheHits = 0;
+static guint s_iNbIconPathCacheMisses = 0;
+static gint64 s_iLastIconThemeRescan = 0;  // last time we checked if the icon theme's folders have changed, for the icons we couldn't find
+static gdouble s_fMagnificationProfile[CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE + 2];  // fAmplitude * sin(phase), sampled on [0;pi]; one more sample so that the interpolation of the last interval never reads outside.
 
 static void _cairo_dock_unload_icon_textures (void);
 static void _cairo_dock_unload_icon_theme (void);
@@ -225,24 +230,9 @@ gint cairo_dock_search_icon_size (GtkIconSize iIconSize)
 
 extern GldiContainer *g_pPrimaryContainer;
 
-gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconSize)
+static gchar *_search_icon_s_path (const gchar *cFileName, gint iDesiredIconSize, gint scale)
 {
-	g_return_val_if_fail (cFileName != NULL, NULL);
-	
-	//\_______________________ easy cases: we receive a path.
-	if (*cFileName == '~')
-	{
-		return g_strdup_printf ("%s%s", g_getenv ("HOME"), cFileName+1);
-	}
-	
-	if (*cFileName == '/')
-	{
-		return g_strdup (cFileName);
-	}
-	
 	//\_______________________ check for the presence of suffix and version number.
-	g_return_val_if_fail (s_pIconTheme != NULL, NULL);
-	
 	GString *sIconPath = g_string_new ("");
 	const gchar *cSuffixTab[4] = {".svg", ".png", ".xpm", NULL};
 	gboolean bHasSuffix=FALSE, bFileFound=FALSE, bHasVersion=FALSE;
@@ -298,13 +288,6 @@ gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconS
 				*str = '\0';
 		}
 
-		gint scale = 1;
-		if (g_pPrimaryContainer != NULL)
-		{
-			// TODO: better way to determine the scale factor based on which screen this icon will appear !!
-			GdkWindow* gdkwindow = gldi_container_get_gdk_window (g_pPrimaryContainer);
-			scale = gdk_window_get_scale_factor (gdkwindow);
-		}
 		pIconInfo = gtk_icon_theme_lookup_icon_for_scale (s_pIconTheme,
 			sIconPath->str,
 			iDesiredIconSize, // GTK_ICON_LOOKUP_FORCE_SIZE if size < 30 ?? -> icons can be different // a lot of themes now use only svg files.
@@ -360,8 +343,101 @@ gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconS
 	return g_string_free (sIconPath, FALSE);
 }
 
+static gboolean _rescan_icon_theme_if_needed (void)
+{
+	// GTK only checks its folders again when it looks up an icon, which the cache avoids; so check them ourselves, at most every 5s like GTK does.
+	gint64 iNow = g_get_monotonic_time ();
+	if (iNow - s_iLastIconThemeRescan < 5 * G_USEC_PER_SEC)
+		return FALSE;
+	s_iLastIconThemeRescan = iNow;
+	return gtk_icon_theme_rescan_if_needed (s_pIconTheme);  // emits "changed" if something was installed or removed
+}
+
+gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconSize)
+{
+	g_return_val_if_fail (cFileName != NULL, NULL);
+	
+	//\_______________________ easy cases: we receive a path.
+	if (*cFileName == '~')
+	{
+		return g_strdup_printf ("%s%s", g_getenv ("HOME"), cFileName+1);
+	}
+	
+	if (*cFileName == '/')
+	{
+		return g_strdup (cFileName);
+	}
+	
+	g_return_val_if_fail (s_pIconTheme != NULL, NULL);
+	
+	gint scale = 1;
+	if (g_pPrimaryContainer != NULL)
+	{
+		// TODO: better way to determine the scale factor based on which screen this icon will appear !!
+		GdkWindow* gdkwindow = gldi_container_get_gdk_window (g_pPrimaryContainer);
+		scale = gdk_window_get_scale_factor (gdkwindow);
+	}
+	
+	//\_______________________ look in the cache of previous results (including the icons that were not found).
+	if (s_pIconPathCache == NULL)
+		s_pIconPathCache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	gchar *cKey = g_strdup_printf ("%s|%d|%d", cFileName, iDesiredIconSize, scale);
+	gchar *cIconPath = NULL;
+	if (g_hash_table_lookup_extended (s_pIconPathCache, cKey, NULL, (gpointer*)&cIconPath))
+	{
+		if (cIconPath != NULL || ! _rescan_icon_theme_if_needed ())
+		{
+			s_iNbIconPathCacheHits ++;
+			g_free (cKey);
+			return g_strdup (cIconPath);
+		}
+		cairo_dock_reset_icon_path_cache ();  // the icon may have been installed since we looked for it (the "changed" signal has already done it, unless it is blocked).
+	}
+	s_iNbIconPathCacheMisses ++;
+	
+	//\_______________________ search it in the themes, and remember the result.
+	cIconPath = _search_icon_s_path (cFileName, iDesiredIconSize, scale);
+	g_hash_table_insert (s_pIconPathCache, cKey, g_strdup (cIconPath));  // the key is taken by the table.
+	return cIconPath;
+}
+
+void cairo_dock_reset_icon_path_cache (void)
+{
+	if (s_pIconPathCache != NULL && g_hash_table_size (s_pIconPathCache) != 0)
+	{
+		cd_debug ("icon paths cache: %u hits, %u misses, %u entries", s_iNbIconPathCacheHits, s_iNbIconPathCacheMisses, g_hash_table_size (s_pIconPathCache));
+		g_hash_table_remove_all (s_pIconPathCache);
+	}
+}
+
+void cairo_dock_get_icon_path_cache_stats (guint *iNbHits, guint *iNbMisses)
+{
+	*iNbHits = s_iNbIconPathCacheHits;
+	*iNbMisses = s_iNbIconPathCacheMisses;
+}
+
+void cairo_dock_build_magnification_profile (gdouble fAmplitude)
+{
+	int i;
+	for (i = 0; i < CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE + 2; i ++)
+		s_fMagnificationProfile[i] = fAmplitude * sin (MIN (i, CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE) * G_PI / CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE);
+}
+
+gdouble cairo_dock_get_magnification_profile (gdouble fPhase)
+{
+	if (fPhase <= 0)
+		return 0.;
+	if (fPhase >= G_PI)
+		fPhase = G_PI;
+	gdouble u = fPhase * (CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE / G_PI);
+	int i = (int) u;
+	gdouble f = u - i;
+	return s_fMagnificationProfile[i] + f * (s_fMagnificationProfile[i+1] - s_fMagnificationProfile[i]);
+}
+
 void cairo_dock_add_path_to_icon_theme (const gchar *cThemePath)
 {
+	cairo_dock_reset_icon_path_cache ();  // the "changed" signal is blocked, and the new path may hold some icons we couldn't find before.
 	if (s_bUseDefaultTheme)
 	{
 		g_signal_handlers_block_matched (s_pIconTheme,
@@ -383,6 +459,7 @@ void cairo_dock_remove_path_from_icon_theme (const gchar *cThemePath)
 {
 	if (! GTK_IS_ICON_THEME (s_pIconTheme))
 		return;
+	cairo_dock_reset_icon_path_cache ();  // the "changed" signal is blocked.
 	g_signal_handlers_block_matched (s_pIconTheme,
 		(GSignalMatchType) G_SIGNAL_MATCH_FUNC,
 		0, 0, NULL, _on_icon_theme_changed, NULL);
@@ -694,6 +771,7 @@ static gboolean _on_icon_theme_changed_idle (G_GNUC_UNUSED gpointer data)
 static void _on_icon_theme_changed (G_GNUC_UNUSED GtkIconTheme *pIconTheme, G_GNUC_UNUSED gpointer data)
 {
 	cd_message ("theme has changed");
+	cairo_dock_reset_icon_path_cache ();  // do it now, an icon may be loaded before the idle.
 	// Reload the icons in idle, because this signal is triggered directly by 'gtk_icon_theme_set_search_path()'; so we may end reloading an applet in the middle of its work (ex.: Status-Notifier when the watcher terminates)
 	if (s_iSidReloadTheme == 0)
 		s_iSidReloadTheme = g_idle_add (_on_icon_theme_changed_idle, NULL);
@@ -701,6 +779,7 @@ static void _on_icon_theme_changed (G_GNUC_UNUSED GtkIconTheme *pIconTheme, G_GN
 static void _cairo_dock_load_icon_theme (void)
 {
 	g_return_if_fail (s_pIconTheme == NULL);
+	cairo_dock_reset_icon_path_cache ();  // new theme, and 's_bUseLocalIcons' may change.
 	if (myIconsParam.cIconTheme == NULL  // no icon theme defined => use the default one.
 	|| strcmp (myIconsParam.cIconTheme, "_Custom Icons_") == 0)  // use custom icons and default theme as fallback
 	{
@@ -720,6 +799,8 @@ static void _cairo_dock_load_icon_theme (void)
 
 static void load (void)
 {
+	cairo_dock_build_magnification_profile (myIconsParam.fAmplitude);
+	
 	cairo_dock_create_icon_fbo ();
 	
 	_cairo_dock_load_icon_theme ();
@@ -802,6 +883,9 @@ static void reload (CairoIconsParam *pPrevIcons, CairoIconsParam *pIcons)
 		_cairo_dock_load_icon_theme ();
 	}
 	
+	if (pPrevIcons->fAmplitude != pIcons->fAmplitude)
+		cairo_dock_build_magnification_profile (pIcons->fAmplitude);
+	
 	gboolean bIconBackgroundImagesChanged = FALSE;
 	// if background images are different, reload them and trigger the reload of all icons
 	if (g_strcmp0 (pPrevIcons->cBackgroundImagePath, pIcons->cBackgroundImagePath) != 0
@@ -871,6 +955,7 @@ static void _cairo_dock_unload_icon_textures (void)
 }
 static void _cairo_dock_unload_icon_theme (void)
 {
+	cairo_dock_reset_icon_path_cache ();
 	if (s_bUseDefaultTheme)
 		g_signal_handlers_disconnect_by_func (G_OBJECT(s_pIconTheme), G_CALLBACK(_on_icon_theme_changed), NULL);
 	else
@@ -961,18 +1046,19 @@ static void _load_image (Icon *icon)
 	int iWidth = cairo_dock_icon_get_allocated_width (icon);
 	int iHeight = cairo_dock_icon_get_allocated_height (icon);
 	if (iWidth <= 0 || iHeight <= 0) return;
-	cairo_surface_t *pSurface = NULL;
 	
 	if (icon->cFileName)
 	{
 		gchar *cIconPath = cairo_dock_search_icon_s_path (icon->cFileName, MAX (iWidth, iHeight));
-		if (cIconPath != NULL && *cIconPath != '\0')
-			pSurface = cairo_dock_create_surface_from_image_simple (cIconPath,
-				iWidth,
-				iHeight);
+		if (cIconPath != NULL && *cIconPath != '\0')  // decode it in the background, a placeholder is set in the meantime.
+		{
+			cairo_dock_load_icon_image_from_file_async (icon, cIconPath, iWidth, iHeight);
+			g_free (cIconPath);
+			return;
+		}
 		g_free (cIconPath);
 	}
-	cairo_dock_load_image_buffer_from_surface (&icon->image, pSurface, iWidth, iHeight);
+	cairo_dock_load_image_buffer_from_surface (&icon->image, NULL, iWidth, iHeight);
 }
 static void init_object (GldiObject *obj, G_GNUC_UNUSED gpointer attr)
 {
@@ -1011,6 +1097,7 @@ static void reset_object (GldiObject *obj)
 		g_source_remove (icon->iSidRedrawSubdockContent);
 	if (icon->iSidLoadImage != 0)  // remove timers after any function that could trigger one (for instance, cairo_dock_deinhibite_class calls cairo_dock_trigger_load_icon_buffers)
 		g_source_remove (icon->iSidLoadImage);
+	cairo_dock_cancel_icon_image_loading (icon);
 	if (icon->iSidDoubleClickDelay != 0)
 		g_source_remove (icon->iSidDoubleClickDelay);
 	
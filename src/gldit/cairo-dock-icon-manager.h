@@ -44,6 +44,9 @@ extern GldiObjectManager myIconObjectMgr;
 
 #define CAIRO_DOCK_DEFAULT_ICON_SIZE 128
 
+/// number of intervals of the tabulated magnification profile (see cairo_dock_get_magnification_profile).
+#define CAIRO_DOCK_MAGNIFICATION_PROFILE_SIZE 1024
+
 // params
 typedef enum {
 	CAIRO_DOCK_NORMAL_SEPARATOR,
@@ -125,13 +128,34 @@ void cairo_dock_set_specified_desktop_for_icon (Icon *pIcon, int iSpecificDeskto
  */
 gint cairo_dock_search_icon_size (GtkIconSize iIconSize);
 
-/** Search the path of an icon into the defined icons themes. It also handles the '~' character in paths.
+/** Search the path of an icon into the defined icons themes. It also handles the '~' character in paths. The results are cached until the icons theme changes.
  * @param cFileName name of the icon file.
  * @param iDesiredIconSize desired icon size if we use icons from user icons theme.
  * @return the complete path of the icon, or NULL if not found.
  */
 gchar *cairo_dock_search_icon_s_path (const gchar *cFileName, gint iDesiredIconSize);
 
+/** Forget all the paths found by \ref cairo_dock_search_icon_s_path. It is done automatically when the icons theme changes; call it if you add or remove an icon in the local icons folder of the current theme.
+ */
+void cairo_dock_reset_icon_path_cache (void);
+
+/** Get the number of times \ref cairo_dock_search_icon_s_path found its result in the cache, or had to search it.
+ * @param iNbHits filled with the number of hits.
+ * @param iNbMisses filled with the number of misses.
+ */
+void cairo_dock_get_icon_path_cache_stats (guint *iNbHits, guint *iNbMisses);
+
+/** Build the table of the magnification profile, ie fAmplitude * sin(phase) sampled over [0;pi]. It is done when the config is loaded or when the amplitude changes.
+ * @param fAmplitude amplitude of the wave (myIconsParam.fAmplitude).
+ */
+void cairo_dock_build_magnification_profile (gdouble fAmplitude);
+
+/** Get the magnification of an icon on the wave, ie fAmplitude * sin(fPhase), interpolated in a table that is built when the config is loaded. Multiply it by the current magnitude of the dock to get the zoom of the icon minus 1.
+ * @param fPhase phase of the icon on the wave; it is clamped to [0;pi].
+ * @return the magnification, between 0 and myIconsParam.fAmplitude.
+ */
+gdouble cairo_dock_get_magnification_profile (gdouble fPhase);
+
 void cairo_dock_add_path_to_icon_theme (const gchar *cPath);
 
 void cairo_dock_remove_path_from_icon_theme (const gchar *cPath);
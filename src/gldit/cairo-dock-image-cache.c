@@ -0,0 +1,267 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>  // close
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+
+#include "cairo-dock-log.h"
+#include "cairo-dock-image-cache.h"
+
+#define CD_IMAGE_CACHE_MAGIC 0x43444943  // "CDIC"
+#define CD_IMAGE_CACHE_VERSION 1
+#define CD_IMAGE_CACHE_MAX_PIXELS (512 * 512)  // bigger images (backgrounds, etc) are not worth the disk space.
+#define CD_IMAGE_CACHE_MAX_BYTES (64 * 1024 * 1024)  // beyond that, the least recently used entries are removed.
+
+// header of a cache file; the pixels follow it.
+typedef struct {
+	guint32 iMagic;
+	guint32 iVersion;
+	gint64 iMTime;  // modification time and size of the image file, to know if the entry is still valid.
+	gint64 iSize;
+	gint32 iWidth;  // size of the pixels buffer
+	gint32 iHeight;
+	gint32 iStride;
+	gint32 iUnused;
+	gdouble fImageWidth;  // what cairo_dock_create_surface_from_image returned.
+	gdouble fImageHeight;
+	gdouble fZoomX;
+	gdouble fZoomY;
+	gdouble fScale;  // device scale of the surface.
+	guint8 reserved[48];
+} CairoDockImageCacheHeader;  // 128 bytes, so that the pixels are well aligned.
+
+G_STATIC_ASSERT (sizeof (CairoDockImageCacheHeader) == 128);
+
+static gchar *s_cCacheDir = NULL;  // NULL if the cache can't be used.
+static cairo_user_data_key_t s_mappedFileKey;
+static gint64 s_iCacheBytes = 0;  // size of the entries, protected by s_cacheMutex
+static GMutex s_cacheMutex;
+
+typedef struct {
+	gchar *cFile;
+	gint64 iSize;
+	gint64 iLastUse;  // the modification time of an entry is updated each time it's used, so the oldest ones are the least recently used.
+} CDCacheEntryInfo;
+
+static gint _compare_last_use (const CDCacheEntryInfo *a, const CDCacheEntryInfo *b)
+{
+	return (a->iLastUse < b->iLastUse ? -1 : a->iLastUse > b->iLastUse ? 1 : 0);
+}
+
+// compute the size of the cache, and remove the least recently used entries if it's too big; called with s_cacheMutex held.
+static void _trim_cache_dir (const gchar *cDir)
+{
+	GDir *dir = g_dir_open (cDir, 0, NULL);
+	if (dir == NULL)
+		return;
+	GArray *pEntries = g_array_new (FALSE, FALSE, sizeof (CDCacheEntryInfo));
+	CDCacheEntryInfo info;
+	GStatBuf st;
+	gint64 iTotalBytes = 0;
+	const gchar *cFileName;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		info.cFile = g_build_filename (cDir, cFileName, NULL);
+		if (g_stat (info.cFile, &st) != 0)
+		{
+			g_free (info.cFile);
+			continue;
+		}
+		info.iSize = st.st_size;
+		info.iLastUse = st.st_mtime;
+		iTotalBytes += info.iSize;
+		g_array_append_val (pEntries, info);
+	}
+	g_dir_close (dir);
+	
+	if (iTotalBytes > CD_IMAGE_CACHE_MAX_BYTES)  // remove the least recently used entries, with some margin so that we don't do it again at the next store.
+	{
+		cd_message ("%" G_GINT64_FORMAT " bytes in the images cache, remove the oldest entries", iTotalBytes);
+		g_array_sort (pEntries, (GCompareFunc)_compare_last_use);
+		guint i;
+		for (i = 0; i < pEntries->len && iTotalBytes > CD_IMAGE_CACHE_MAX_BYTES * 3 / 4; i ++)
+		{
+			CDCacheEntryInfo *pInfo = &g_array_index (pEntries, CDCacheEntryInfo, i);
+			if (g_remove (pInfo->cFile) == 0)  // an entry in use stays mapped until its surface is destroyed.
+				iTotalBytes -= pInfo->iSize;
+		}
+	}
+	s_iCacheBytes = iTotalBytes;
+	
+	guint i;
+	for (i = 0; i < pEntries->len; i ++)
+		g_free (g_array_index (pEntries, CDCacheEntryInfo, i).cFile);
+	g_array_free (pEntries, TRUE);
+}
+
+static const gchar *_get_cache_dir (void)
+{
+	static gsize s_bInit = 0;
+	if (g_once_init_enter (&s_bInit))
+	{
+		gchar *cDir = g_build_filename (g_get_user_cache_dir (), "cairo-dock", "images", NULL);
+		if (g_mkdir_with_parents (cDir, 0700) == 0)
+		{
+			g_mutex_lock (&s_cacheMutex);
+			_trim_cache_dir (cDir);
+			g_mutex_unlock (&s_cacheMutex);
+			s_cCacheDir = cDir;
+		}
+		else
+		{
+			cd_warning ("couldn't create the images cache in '%s'", cDir);
+			g_free (cDir);
+		}
+		g_once_init_leave (&s_bInit, 1);
+	}
+	return s_cCacheDir;
+}
+
+cairo_surface_t *cairo_dock_image_cache_lookup (CairoDockImageCacheKey *pKey, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+{
+	pKey->bCacheable = FALSE;
+	const gchar *cDir = _get_cache_dir ();
+	if (cDir == NULL)
+		return NULL;
+	
+	//\_______________ identify the image.
+	GStatBuf st;
+	if (g_stat (pKey->cImagePath, &st) != 0 || ! S_ISREG (st.st_mode))  // not a file (a resource, etc), it can't be cached.
+		return NULL;
+	pKey->iMTime = st.st_mtime;
+	pKey->iSize = st.st_size;
+	pKey->bCacheable = TRUE;
+	
+	gchar *cKey = g_strdup_printf ("%s|%g|%d|%d|%d|%g", pKey->cImagePath,
+		pKey->fMaxScale,
+		pKey->iWidthConstraint,
+		pKey->iHeightConstraint,
+		pKey->iLoadingModifier,
+		pKey->fScale);
+	gchar *cHash = g_compute_checksum_for_string (G_CHECKSUM_SHA1, cKey, -1);
+	g_strlcpy (pKey->cHash, cHash, sizeof (pKey->cHash));
+	g_free (cHash);
+	g_free (cKey);
+	
+	//\_______________ map the entry, if any.
+	gchar *cFile = g_build_filename (cDir, pKey->cHash, NULL);
+	GMappedFile *pMappedFile = g_mapped_file_new (cFile, TRUE, NULL);  // writable: the pages are private, so the surface can be drawn on without altering the cache.
+	if (pMappedFile == NULL)  // not in the cache
+	{
+		g_free (cFile);
+		return NULL;
+	}
+	
+	const CairoDockImageCacheHeader *pHeader = (const CairoDockImageCacheHeader*) g_mapped_file_get_contents (pMappedFile);
+	gsize iLength = g_mapped_file_get_length (pMappedFile);
+	if (iLength < sizeof (CairoDockImageCacheHeader)
+	|| pHeader->iMagic != CD_IMAGE_CACHE_MAGIC
+	|| pHeader->iVersion != CD_IMAGE_CACHE_VERSION
+	|| pHeader->iMTime != pKey->iMTime || pHeader->iSize != pKey->iSize  // the image has changed since it was cached.
+	|| pHeader->iWidth <= 0 || pHeader->iHeight <= 0
+	|| pHeader->iStride != cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, pHeader->iWidth)
+	|| iLength != sizeof (CairoDockImageCacheHeader) + (gsize)pHeader->iStride * pHeader->iHeight)
+	{
+		g_mapped_file_unref (pMappedFile);
+		g_free (cFile);
+		return NULL;
+	}
+	g_utime (cFile, NULL);  // mark it as recently used.
+	g_free (cFile);
+	
+	//\_______________ make a surface on top of the pixels.
+	cairo_surface_t *pSurface = cairo_image_surface_create_for_data ((guchar*)pHeader + sizeof (CairoDockImageCacheHeader),
+		CAIRO_FORMAT_ARGB32,
+		pHeader->iWidth,
+		pHeader->iHeight,
+		pHeader->iStride);
+	cairo_surface_set_device_scale (pSurface, pHeader->fScale, pHeader->fScale);
+	*fImageWidth = pHeader->fImageWidth;
+	*fImageHeight = pHeader->fImageHeight;
+	*fZoomX = pHeader->fZoomX;
+	*fZoomY = pHeader->fZoomY;
+	cairo_surface_set_user_data (pSurface, &s_mappedFileKey, pMappedFile, (cairo_destroy_func_t) g_mapped_file_unref);  // the mapping lives as long as the surface.
+	return pSurface;
+}
+
+void cairo_dock_image_cache_store (CairoDockImageCacheKey *pKey, cairo_surface_t *pSurface, double fImageWidth, double fImageHeight, double fZoomX, double fZoomY)
+{
+	if (! pKey->bCacheable || s_cCacheDir == NULL)  // the image can't be cached.
+		return;
+	if (cairo_surface_get_type (pSurface) != CAIRO_SURFACE_TYPE_IMAGE
+	|| cairo_image_surface_get_format (pSurface) != CAIRO_FORMAT_ARGB32)
+		return;
+	int w = cairo_image_surface_get_width (pSurface);
+	int h = cairo_image_surface_get_height (pSurface);
+	if (w <= 0 || h <= 0 || w * h > CD_IMAGE_CACHE_MAX_PIXELS)
+		return;
+	
+	CairoDockImageCacheHeader header;
+	memset (&header, 0, sizeof (CairoDockImageCacheHeader));
+	header.iMagic = CD_IMAGE_CACHE_MAGIC;
+	header.iVersion = CD_IMAGE_CACHE_VERSION;
+	header.iMTime = pKey->iMTime;
+	header.iSize = pKey->iSize;
+	header.iWidth = w;
+	header.iHeight = h;
+	header.iStride = cairo_image_surface_get_stride (pSurface);
+	header.fImageWidth = fImageWidth;
+	header.fImageHeight = fImageHeight;
+	header.fZoomX = fZoomX;
+	header.fZoomY = fZoomY;
+	double ys;
+	cairo_surface_get_device_scale (pSurface, &header.fScale, &ys);
+	if (header.iStride != cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, w))
+		return;
+	
+	// write it in a temporary file first, so that a reader never sees an incomplete entry.
+	cairo_surface_flush (pSurface);
+	gchar *cFile = g_build_filename (s_cCacheDir, pKey->cHash, NULL);
+	gchar *cTmpFile = g_strdup_printf ("%s.XXXXXX", cFile);
+	int fd = g_mkstemp (cTmpFile);
+	if (fd >= 0)
+	{
+		FILE *f = fdopen (fd, "wb");
+		gboolean bSuccess = (f != NULL
+			&& fwrite (&header, sizeof (CairoDockImageCacheHeader), 1, f) == 1
+			&& fwrite (cairo_image_surface_get_data (pSurface), header.iStride, h, f) == (size_t)h);
+		if (f != NULL)
+			bSuccess = (fclose (f) == 0 && bSuccess);  // will close fd as well
+		else
+			close (fd);
+		if (! bSuccess || g_rename (cTmpFile, cFile) != 0)
+		{
+			cd_debug ("couldn't write '%s' in the images cache", pKey->cImagePath);
+			g_remove (cTmpFile);
+		}
+		else
+		{
+			g_mutex_lock (&s_cacheMutex);
+			s_iCacheBytes += sizeof (CairoDockImageCacheHeader) + (gint64)header.iStride * h;  // an entry that is replaced is counted twice, until the next trim.
+			if (s_iCacheBytes > CD_IMAGE_CACHE_MAX_BYTES)
+				_trim_cache_dir (s_cCacheDir);
+			g_mutex_unlock (&s_cacheMutex);
+		}
+	}
+	g_free (cTmpFile);
+	g_free (cFile);
+}
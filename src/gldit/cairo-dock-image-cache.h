@@ -0,0 +1,73 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CAIRO_DOCK_IMAGE_CACHE_H
+#define CAIRO_DOCK_IMAGE_CACHE_H
+
+#include <glib.h>
+#include "cairo-dock-surface-factory.h"  // CairoDockLoadImageModifier
+
+G_BEGIN_DECLS
+
+/**
+*@file cairo-dock-image-cache.h A persistent cache of rasterized images, stored in the user's cache dir.
+* Each entry holds the pixels of an image surface, and is mapped in memory when it's loaded, so that the surface doesn't need any copy nor any decoding.
+* An entry is identified by the path of the image and the parameters it was loaded with, and is valid as long as the image file is not modified. The cache is limited in size, and the least recently used entries are removed first.
+* All the functions can be called from any thread.
+*/
+
+/// Identifies an image in the cache.
+typedef struct {
+	const gchar *cImagePath;
+	double fMaxScale;
+	int iWidthConstraint;
+	int iHeightConstraint;
+	CairoDockLoadImageModifier iLoadingModifier;
+	double fScale;  // scale factor of the surface.
+	// filled by cairo_dock_image_cache_lookup
+	gboolean bCacheable;  // FALSE if the image is not a file, or the cache can't be used.
+	gint64 iMTime;  // modification time of the image file (it can be 0, e.g. in OSTree or Flatpak trees).
+	gint64 iSize;  // size of the image file.
+	gchar cHash[41];  // name of the entry in the cache.
+} CairoDockImageCacheKey;
+
+/** Look for an image in the cache.
+*@param pKey key of the image; its last fields are filled, so that it can be used to store the image if it's not found.
+*@param fImageWidth filled with the width of the image, as returned by cairo_dock_create_surface_from_image.
+*@param fImageHeight filled with the height of the image.
+*@param fZoomX filled with the zoom applied on the width.
+*@param fZoomY filled with the zoom applied on the height.
+*@return an image surface whose pixels are mapped from the cache, or NULL if the image is not in the cache or is outdated.
+*/
+cairo_surface_t *cairo_dock_image_cache_lookup (CairoDockImageCacheKey *pKey, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY);
+
+/** Store an image in the cache. Nothing is done if the surface is not an ARGB image surface, or is too big.
+*@param pKey key of the image, previously used with cairo_dock_image_cache_lookup.
+*@param pSurface the surface of the image.
+*@param fImageWidth width of the image, as returned by cairo_dock_create_surface_from_image.
+*@param fImageHeight height of the image.
+*@param fZoomX zoom applied on the width.
+*@param fZoomY zoom applied on the height.
+*/
+void cairo_dock_image_cache_store (CairoDockImageCacheKey *pKey, cairo_surface_t *pSurface, double fImageWidth, double fImageHeight, double fZoomX, double fZoomY);
+
+G_END_DECLS
+
+#endif
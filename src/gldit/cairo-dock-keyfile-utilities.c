@@ -19,18 +19,317 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <glib/gstdio.h>
 #include <gio/gunixoutputstream.h>
 
 #include "cairo-dock-log.h"
+#include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
 #include "cairo-dock-keyfile-utilities.h"
 
 
+  ////////////////////
+ /// WRITE-BEHIND ///
+////////////////////
+
+// Updates of a few keys (cairo_dock_update_keyfile, cairo_dock_add_remove_element_to_key) are applied on a key-file kept in memory, and the file is written a little later, from a thread; so that moving a desklet or reordering a bunch of launchers doesn't load and write the same files again and again on the main thread.
+// The content of a file is always its latest version, whether it is still in memory, waiting to be written, or on the disk, for cairo_dock_open_key_file and cairo_dock_write_keys_to_file.
+
+#define CD_KEYFILE_WRITE_DELAY 500  // ms
+
+typedef struct {
+	GKeyFile *pKeyFile;
+	} CDPendingKeyFile;
+
+typedef struct {
+	gchar *cConfFilePath;
+	gchar *cContent;
+	gsize length;
+	} CDKeyFileWrite;
+
+static GHashTable *s_hPendingKeyFiles = NULL;  // path -> CDPendingKeyFile, modified but not yet given to the writer (main thread only)
+static guint s_iSidWritePendingKeyFiles = 0;
+static GThreadPool *s_pKeyFileWriter = NULL;  // a single thread, so the files are written in order
+static GHashTable *s_hWritingKeyFiles = NULL;  // path -> latest CDKeyFileWrite given to the writer, protected by s_writingMutex
+static GMutex s_writingMutex;  // also held while a written file is renamed or a file is deleted, so that a deleted file is never brought back
+
+static void _free_pending_key_file (CDPendingKeyFile *pPending)
+{
+	g_key_file_free (pPending->pKeyFile);
+	g_free (pPending);
+}
+
+static void _free_key_file_write (CDKeyFileWrite *pWrite)
+{
+	g_free (pWrite->cConfFilePath);
+	g_free (pWrite->cContent);
+	g_free (pWrite);
+}
+
+static void _write_content_to_file (const gchar *cConfFilePath, const gchar *cContent, gsize length)
+{
+	gchar *cDirectory = g_path_get_dirname (cConfFilePath);
+	if (! g_file_test (cDirectory, G_FILE_TEST_EXISTS | G_FILE_TEST_IS_EXECUTABLE))
+	{
+		g_mkdir_with_parents (cDirectory, 7*8*8+7*8+5);
+	}
+	g_free (cDirectory);
+	
+	GError *erreur = NULL;
+	g_file_set_contents (cConfFilePath, cContent, length, &erreur);  // writes a temporary file and renames it, so the file is never half-written
+	if (erreur != NULL)
+	{
+		cd_warning ("Error while writing data to %s : %s", cConfFilePath, erreur->message);
+		g_error_free (erreur);
+	}
+}
+
+// write a content in a temporary file next to the final one; returns its path, or NULL.
+static gchar *_write_content_to_temp_file (const gchar *cConfFilePath, const gchar *cContent, gsize length)
+{
+	gchar *cDirectory = g_path_get_dirname (cConfFilePath);
+	if (! g_file_test (cDirectory, G_FILE_TEST_EXISTS | G_FILE_TEST_IS_EXECUTABLE))
+	{
+		g_mkdir_with_parents (cDirectory, 7*8*8+7*8+5);
+	}
+	g_free (cDirectory);
+	
+	gchar *cTmpPath = g_strdup_printf ("%s.XXXXXX", cConfFilePath);
+	int fd = g_mkstemp_full (cTmpPath, O_WRONLY, 6*8*8+6*8+6);  // the umask applies, like for g_file_set_contents
+	if (fd == -1)
+	{
+		cd_warning ("Error while writing data to %s : %s", cConfFilePath, g_strerror (errno));
+		g_free (cTmpPath);
+		return NULL;
+	}
+	gboolean bSuccess = TRUE;
+	gssize n;
+	while (length > 0)
+	{
+		n = write (fd, cContent, length);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			cd_warning ("Error while writing data to %s : %s", cConfFilePath, g_strerror (errno));
+			bSuccess = FALSE;
+			break;
+		}
+		cContent += n;
+		length -= n;
+	}
+	if (bSuccess && fsync (fd) != 0)
+		bSuccess = FALSE;
+	if (close (fd) != 0)
+		bSuccess = FALSE;
+	if (! bSuccess)
+	{
+		g_remove (cTmpPath);
+		g_free (cTmpPath);
+		return NULL;
+	}
+	return cTmpPath;
+}
+
+static void _write_key_file_in_thread (CDKeyFileWrite *pWrite, G_GNUC_UNUSED gpointer data)
+{
+	// the content is written outside of the lock, the main thread is only blocked for the rename.
+	gchar *cTmpPath = _write_content_to_temp_file (pWrite->cConfFilePath, pWrite->cContent, pWrite->length);
+	
+	g_mutex_lock (&s_writingMutex);
+	gboolean bLatest = (g_hash_table_lookup (s_hWritingKeyFiles, pWrite->cConfFilePath) == pWrite);  // else a newer content has been given since, or the file has been written directly, deleted or replaced
+	if (cTmpPath != NULL)
+	{
+		if (bLatest && g_file_test (pWrite->cConfFilePath, G_FILE_TEST_EXISTS))  // if the file has been removed behind our back, don't create it again
+		{
+			if (g_rename (cTmpPath, pWrite->cConfFilePath) != 0)
+			{
+				cd_warning ("Error while writing data to %s : %s", pWrite->cConfFilePath, g_strerror (errno));
+				g_remove (cTmpPath);
+			}
+		}
+		else
+			g_remove (cTmpPath);
+	}
+	if (bLatest)
+		g_hash_table_remove (s_hWritingKeyFiles, pWrite->cConfFilePath);
+	g_mutex_unlock (&s_writingMutex);
+	
+	g_free (cTmpPath);
+	_free_key_file_write (pWrite);
+}
+
+static void _give_to_writer (const gchar *cConfFilePath, GKeyFile *pKeyFile)
+{
+	gsize length = 0;
+	gchar *cContent = g_key_file_to_data (pKeyFile, &length, NULL);
+	if (cContent == NULL || *cContent == '\0')
+	{
+		cd_warning ("empty content for %s, it will not be written", cConfFilePath);
+		g_free (cContent);
+		return;
+	}
+	CDKeyFileWrite *pWrite = g_new0 (CDKeyFileWrite, 1);
+	pWrite->cConfFilePath = g_strdup (cConfFilePath);
+	pWrite->cContent = cContent;
+	pWrite->length = length;
+	
+	if (s_pKeyFileWriter == NULL)
+		s_pKeyFileWriter = g_thread_pool_new ((GFunc)_write_key_file_in_thread, NULL, 1, FALSE, NULL);
+	g_mutex_lock (&s_writingMutex);
+	g_hash_table_insert (s_hWritingKeyFiles, g_strdup (cConfFilePath), pWrite);  // the previous one, if any, is still in the queue, and will be skipped
+	g_mutex_unlock (&s_writingMutex);
+	g_thread_pool_push (s_pKeyFileWriter, pWrite, NULL);
+}
+
+static gboolean _give_to_writer_pending (gchar *cConfFilePath, CDPendingKeyFile *pPending, G_GNUC_UNUSED gpointer data)
+{
+	_give_to_writer (cConfFilePath, pPending->pKeyFile);
+	return TRUE;
+}
+
+static gboolean _write_pending_key_files (G_GNUC_UNUSED gpointer data)
+{
+	g_hash_table_foreach_remove (s_hPendingKeyFiles, (GHRFunc)_give_to_writer_pending, NULL);
+	s_iSidWritePendingKeyFiles = 0;
+	return FALSE;
+}
+
+static void _init_write_behind (void)
+{
+	if (s_hPendingKeyFiles != NULL)
+		return;
+	s_hPendingKeyFiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)_free_pending_key_file);
+	s_hWritingKeyFiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);  // the writes belong to the writer
+}
+
+static CDPendingKeyFile *_get_pending_key_file (const gchar *cConfFilePath)
+{
+	if (s_hPendingKeyFiles == NULL)
+		return NULL;
+	CDPendingKeyFile *pPending = g_hash_table_lookup (s_hPendingKeyFiles, cConfFilePath);
+	if (pPending != NULL && ! g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))  // the file has been deleted, forget about it
+	{
+		g_hash_table_remove (s_hPendingKeyFiles, cConfFilePath);
+		pPending = NULL;
+	}
+	return pPending;
+}
+
+// drop any content of a file that is waiting to be written; must be called with s_writingMutex held.
+static void _forget_key_file_locked (const gchar *cConfFilePath)
+{
+	if (s_hPendingKeyFiles != NULL)
+		g_hash_table_remove (s_hPendingKeyFiles, cConfFilePath);
+	if (s_hWritingKeyFiles != NULL)
+		g_hash_table_remove (s_hWritingKeyFiles, cConfFilePath);  // a write still in the queue will see it's not the latest any more, and will be skipped
+}
+
+// get a copy of the latest content of a file if it's not yet on the disk.
+static gchar *_get_content_not_on_disk (const gchar *cConfFilePath, gsize *length)
+{
+	gchar *cContent = NULL;
+	CDPendingKeyFile *pPending = _get_pending_key_file (cConfFilePath);
+	if (pPending != NULL)
+	{
+		cContent = g_key_file_to_data (pPending->pKeyFile, length, NULL);
+	}
+	else if (s_hWritingKeyFiles != NULL)
+	{
+		g_mutex_lock (&s_writingMutex);
+		CDKeyFileWrite *pWrite = g_hash_table_lookup (s_hWritingKeyFiles, cConfFilePath);
+		if (pWrite != NULL)
+		{
+			cContent = g_memdup2 (pWrite->cContent, pWrite->length + 1);
+			*length = pWrite->length;
+		}
+		g_mutex_unlock (&s_writingMutex);
+	}
+	return cContent;
+}
+
+// load the latest content of a file, wherever it is.
+static gboolean _load_key_file (GKeyFile *pKeyFile, const gchar *cConfFilePath, GError **erreur)
+{
+	GKeyFileFlags flags = G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS;
+	CDPendingKeyFile *pPending = _get_pending_key_file (cConfFilePath);
+	if (pPending != NULL)
+	{
+		gsize length = 0;
+		gchar *cContent = g_key_file_to_data (pPending->pKeyFile, &length, NULL);
+		gboolean r = g_key_file_load_from_data (pKeyFile, cContent, length, flags, erreur);
+		g_free (cContent);
+		return r;
+	}
+	if (s_hWritingKeyFiles != NULL)
+	{
+		g_mutex_lock (&s_writingMutex);
+		CDKeyFileWrite *pWrite = g_hash_table_lookup (s_hWritingKeyFiles, cConfFilePath);
+		if (pWrite != NULL)
+		{
+			gboolean r = g_key_file_load_from_data (pKeyFile, pWrite->cContent, pWrite->length, flags, erreur);
+			g_mutex_unlock (&s_writingMutex);
+			return r;
+		}
+		g_mutex_unlock (&s_writingMutex);
+	}
+	return g_key_file_load_from_file (pKeyFile, cConfFilePath, flags, erreur);
+}
+
+// get the key-file of a file to update it; it will be written later by _schedule_key_file_write.
+static GKeyFile *_get_key_file_to_update (const gchar *cConfFilePath)
+{
+	_init_write_behind ();
+	CDPendingKeyFile *pPending = _get_pending_key_file (cConfFilePath);
+	if (pPending == NULL)
+	{
+		pPending = g_new0 (CDPendingKeyFile, 1);
+		pPending->pKeyFile = g_key_file_new ();
+		_load_key_file (pPending->pKeyFile, cConfFilePath, NULL);  // if the key-file doesn't exist, it will be created.
+		g_hash_table_insert (s_hPendingKeyFiles, g_strdup (cConfFilePath), pPending);
+	}
+	return pPending->pKeyFile;
+}
+
+static void _schedule_key_file_write (const gchar *cConfFilePath)
+{
+	if (! g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))  // a new file: create it now, the writer only updates existing files.
+	{
+		CDPendingKeyFile *pPending = g_hash_table_lookup (s_hPendingKeyFiles, cConfFilePath);
+		if (pPending != NULL)
+		{
+			cairo_dock_write_keys_to_file (pPending->pKeyFile, cConfFilePath);  // will drop the pending key-file
+		}
+		return;
+	}
+	if (s_iSidWritePendingKeyFiles == 0)
+		s_iSidWritePendingKeyFiles = g_timeout_add (CD_KEYFILE_WRITE_DELAY, _write_pending_key_files, NULL);
+}
+
+void cairo_dock_sync_key_files (void)
+{
+	if (s_hPendingKeyFiles == NULL)
+		return;
+	if (s_iSidWritePendingKeyFiles != 0)
+	{
+		g_source_remove (s_iSidWritePendingKeyFiles);
+		_write_pending_key_files (NULL);
+	}
+	if (s_pKeyFileWriter != NULL)
+	{
+		g_thread_pool_free (s_pKeyFileWriter, FALSE, TRUE);  // wait for all the writes to be done
+		s_pKeyFileWriter = NULL;
+	}
+}
+
+
 GKeyFile *cairo_dock_open_key_file (const gchar *cConfFilePath)
 {
 	GKeyFile *pKeyFile = g_key_file_new ();
 	GError *erreur = NULL;
-	g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &erreur);
+	_load_key_file (pKeyFile, cConfFilePath, &erreur);
 	if (erreur != NULL)
 	{
 		cd_debug ("while trying to load %s : %s", cConfFilePath, erreur->message);  // on ne met pas de warning car un fichier de conf peut ne pas exister la 1ere fois.
@@ -46,14 +345,6 @@ void cairo_dock_write_keys_to_file_full (GKeyFile *pKeyFile, const gchar *cConfF
 	cd_debug ("%s (%s)", __func__, cConfFilePath);
 	GError *erreur = NULL;
 
-	gchar *cDirectory = g_path_get_dirname (cConfFilePath);
-	if (! g_file_test (cDirectory, G_FILE_TEST_EXISTS | G_FILE_TEST_IS_EXECUTABLE))
-	{
-		g_mkdir_with_parents (cDirectory, 7*8*8+7*8+5);
-	}
-	g_free (cDirectory);
-
-
 	gsize length=0;
 	gchar *cNewConfFileContent = g_key_file_to_data (pKeyFile, &length, &erreur);
 	if (erreur != NULL)
@@ -63,15 +354,48 @@ void cairo_dock_write_keys_to_file_full (GKeyFile *pKeyFile, const gchar *cConfF
 		return ;
 	}
 	if (! bAllowEmpty) g_return_if_fail (cNewConfFileContent != NULL && *cNewConfFileContent != '\0');
+	
+	// this content replaces any previous one that is still waiting to be written (pKeyFile may be the pending one, so only drop it now)
+	g_mutex_lock (&s_writingMutex);
+	_forget_key_file_locked (cConfFilePath);
+	g_mutex_unlock (&s_writingMutex);
+	
+	_write_content_to_file (cConfFilePath, cNewConfFileContent, length);
+	g_free (cNewConfFileContent);
+}
 
-	g_file_set_contents (cConfFilePath, cNewConfFileContent, length, &erreur);
-	if (erreur != NULL)
+void cairo_dock_remove_key_file (const gchar *cConfFilePath)
+{
+	g_mutex_lock (&s_writingMutex);
+	_forget_key_file_locked (cConfFilePath);
+	g_remove (cConfFilePath);
+	g_mutex_unlock (&s_writingMutex);
+}
+
+gboolean cairo_dock_copy_key_file (const gchar *cOriginalConfFilePath, const gchar *cConfFilePath)
+{
+	gsize length = 0;
+	gchar *cContent = _get_content_not_on_disk (cOriginalConfFilePath, &length);  // take the changes of the original file that are not yet written
+	
+	g_mutex_lock (&s_writingMutex);
+	_forget_key_file_locked (cConfFilePath);  // the destination may have had the same name as a file removed before, don't let its old content come back
+	g_mutex_unlock (&s_writingMutex);
+	
+	gboolean r;
+	if (cContent != NULL)
 	{
-		cd_warning ("Error while writing data to %s : %s", cConfFilePath, erreur->message);
-		g_error_free (erreur);
-		return ;
+		GError *erreur = NULL;
+		r = g_file_set_contents (cConfFilePath, cContent, length, &erreur);
+		if (erreur != NULL)
+		{
+			cd_warning ("Error while writing data to %s : %s", cConfFilePath, erreur->message);
+			g_error_free (erreur);
+		}
+		g_free (cContent);
 	}
-	g_free (cNewConfFileContent);
+	else
+		r = cairo_dock_copy_file (cOriginalConfFilePath, cConfFilePath);
+	return r;
 }
 
 gchar *cairo_dock_write_keys_to_new_file (GKeyFile *pKeyFile, const gchar *cConfFilePath)
@@ -96,6 +420,10 @@ gchar *cairo_dock_write_keys_to_new_file (GKeyFile *pKeyFile, const gchar *cConf
 	}
 	g_free (cDirectory);
 
+	g_mutex_lock (&s_writingMutex);
+	_forget_key_file_locked (cConfFilePath);  // in case a removed file had the same name
+	g_mutex_unlock (&s_writingMutex);
+	
 	GFile *file = g_file_new_for_path (cConfFilePath);
 	out = G_OUTPUT_STREAM (g_file_create (file, G_FILE_CREATE_NONE, NULL, NULL));
 	g_object_unref (file);
@@ -117,6 +445,9 @@ gchar *cairo_dock_write_keys_to_new_file (GKeyFile *pKeyFile, const gchar *cConf
 			g_free (cNewConfFileContent);
 			return NULL; // cannot create new file
 		}
+		g_mutex_lock (&s_writingMutex);
+		_forget_key_file_locked (cTemplate);
+		g_mutex_unlock (&s_writingMutex);
 		out = g_unix_output_stream_new (fd, TRUE);
 		if (!out)
 		{
@@ -385,9 +716,9 @@ gboolean cairo_dock_conf_file_needs_update (GKeyFile *pKeyFile, const gchar *cVe
 
 void cairo_dock_add_remove_element_to_key (const gchar *cConfFilePath, const gchar *cGroupName, const gchar *cKeyName, gchar *cElementName, gboolean bAdd)
 {
-	GKeyFile *pKeyFile = cairo_dock_open_key_file (cConfFilePath);
-	if (pKeyFile == NULL)
+	if (! g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))
 		return ;
+	GKeyFile *pKeyFile = _get_key_file_to_update (cConfFilePath);
 	
 	gchar *cElementList = g_key_file_get_string (pKeyFile, cGroupName, cKeyName, NULL), *cNewElementList = NULL;
 	if (cElementList != NULL && *cElementList == '\0')
@@ -426,10 +757,9 @@ void cairo_dock_add_remove_element_to_key (const gchar *cConfFilePath, const gch
 		}
 	}
 	g_key_file_set_string (pKeyFile, cGroupName, cKeyName, cNewElementList);
-	cairo_dock_write_keys_to_file (pKeyFile, cConfFilePath);
+	_schedule_key_file_write (cConfFilePath);
 	g_free (cElementList);
 	g_free (cNewElementList);
-	g_key_file_free (pKeyFile);
 }
 
 
@@ -487,8 +817,7 @@ void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirst
 {
 	cd_message ("%s (%s)", __func__, cConfFilePath);
 	
-	GKeyFile *pKeyFile = g_key_file_new ();  // if the key-file doesn't exist, it will be created.
-	g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
+	GKeyFile *pKeyFile = _get_key_file_to_update (cConfFilePath);  // the changes will be written later.
 	
 	GType iType = iFirstDataType;
 	gboolean bValue;
@@ -526,8 +855,7 @@ void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirst
 		iType = va_arg (args, GType);
 	}
 
-	cairo_dock_write_keys_to_file (pKeyFile, cConfFilePath);
-	g_key_file_free (pKeyFile);
+	_schedule_key_file_write (cConfFilePath);
 }
 
 void cairo_dock_update_keyfile (const gchar *cConfFilePath, GType iFirstDataType, ...)  // type, groupe, cle, valeur, etc. finir par G_TYPE_INVALID.
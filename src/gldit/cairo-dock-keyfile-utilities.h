@@ -36,7 +36,7 @@ G_BEGIN_DECLS
 */
 GKeyFile *cairo_dock_open_key_file (const gchar *cConfFilePath);
 
-/** Write a key file on the disk.
+/** Write a key file on the disk, immediately. It replaces any content of this file that is still waiting to be written (see cairo_dock_update_keyfile).
 */
 void cairo_dock_write_keys_to_file_full (GKeyFile *pKeyFile, const gchar *cConfFilePath, gboolean bAllowEmpty);
 #define cairo_dock_write_keys_to_file(pKeyFile, cConfFilePath) cairo_dock_write_keys_to_file_full (pKeyFile, cConfFilePath, FALSE)
@@ -50,6 +50,18 @@ void cairo_dock_write_keys_to_file_full (GKeyFile *pKeyFile, const gchar *cConfF
 */
 gchar *cairo_dock_write_keys_to_new_file (GKeyFile *pKeyFile, const gchar *cConfFilePath);
 
+/** Delete a conf file, along with any change of it that is still waiting to be written.
+*@param cConfFilePath path to the conf file.
+*/
+void cairo_dock_remove_key_file (const gchar *cConfFilePath);
+
+/** Copy a conf file, with its latest content, over another one. Any change of the destination that is still waiting to be written is dropped.
+*@param cOriginalConfFilePath path to the conf file to copy.
+*@param cConfFilePath path to the new conf file.
+*@return TRUE on success.
+*/
+gboolean cairo_dock_copy_key_file (const gchar *cOriginalConfFilePath, const gchar *cConfFilePath);
+
 /** Merge the values of a conf-file into another one. Keys are filtered by an identifier on the original conf-file.
 *@param cConfFilePath an up-to-date conf-file with old values, that will be updated.
 *@param cReplacementConfFilePath an old conf-file containing values we want to use
@@ -74,7 +86,7 @@ void cairo_dock_get_conf_file_version (GKeyFile *pKeyFile, gchar **cConfFileVers
 */
 gboolean cairo_dock_conf_file_needs_update (GKeyFile *pKeyFile, const gchar *cVersion);
 
-/** Add or remove a value in a list of values to a given (group,key) pair of a conf file.
+/** Add or remove a value in a list of values to a given (group,key) pair of a conf file. Like cairo_dock_update_keyfile, the file is written a little later.
 */
 void cairo_dock_add_remove_element_to_key (const gchar *cConfFilePath, const gchar *cGroupName, const gchar *cKeyName, gchar *cElementName, gboolean bAdd);
 
@@ -98,10 +110,15 @@ gchar * cairo_dock_get_locale_string_from_conf_file (GKeyFile *pKeyFile, const g
 void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirstDataType, va_list args);
 
 /** Update a conf file with a list of values of the form : {type, name of the group, name of the key, value}. Must end with G_TYPE_INVALID.
+*The changes are kept in memory, and the file is written a little later from a thread, along with the next changes; cairo_dock_open_key_file always gets the latest content. Must be called from the main thread.
 *@param cConfFilePath path to the conf file.
 *@param iFirstDataType type of the first value.
 */
 void cairo_dock_update_keyfile (const gchar *cConfFilePath, GType iFirstDataType, ...);
 
+/** Write on the disk all the changes made by cairo_dock_update_keyfile and cairo_dock_add_remove_element_to_key, and wait until they are written. Call it before copying conf files or quitting.
+*/
+void cairo_dock_sync_key_files (void);
+
 G_END_DECLS
 #endif
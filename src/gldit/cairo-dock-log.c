@@ -25,6 +25,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>  // atexit
 #include <string.h>
 #include <stdarg.h>
 #include <unistd.h>
@@ -97,6 +98,208 @@ const char *_cd_log_level_to_string (const GLogLevelFlags loglevel)
   return "";
 }
 
+  ////////////////////////
+ /// ASYNCHRONOUS LOG ///
+////////////////////////
+
+// Each thread formats its messages into its own ring of entries, without any lock (it is the only one to write into it), and a dedicated thread writes them on the output. So a thread never waits for the terminal or the file the output is redirected to, which makes the debug level usable without slowing down the dock.
+// Only the messages, infos and debug messages go there. Warnings, criticals and errors are still written synchronously through g_logv (after the pending messages), since they are rare, may be made fatal (G_DEBUG=fatal-warnings, g_log_set_always_fatal), and may be caught by a log handler.
+// So with the default verbosity (warning), no ring is ever allocated, and the flusher thread, which is started with the first ring, doesn't exist.
+
+#define CD_LOG_RING_SIZE 64  // number of entries per thread (a power of 2); a ring takes ~40KB, and a thread keeps it until it exits
+#define CD_LOG_LOCATION_SIZE 96
+#define CD_LOG_MESSAGE_SIZE 512
+
+typedef struct {
+	gint64 iTime;
+	GLogLevelFlags iLevel;
+	gchar cLocation[CD_LOG_LOCATION_SIZE];  // copied, since the file may belong to a module that can be unloaded before the entry is written
+	gchar cMessage[CD_LOG_MESSAGE_SIZE];
+	} CDLogEntry;
+
+typedef struct {
+	CDLogEntry entries[CD_LOG_RING_SIZE];
+	guint iHead;  // number of entries written by the owner thread (only it modifies it); it can wrap around
+	guint iTail;  // number of entries written on the output (only the flusher modifies it)
+	gint iNbLost;  // number of entries that couldn't be stored because the ring was full
+	gint bOwnerExited;
+	} CDLogRing;
+
+static GPtrArray *s_pLogRings = NULL;  // all the rings, protected by s_ringsMutex
+static GMutex s_ringsMutex;
+static GMutex s_flushMutex;  // only one thread writes the entries at a time
+static GMutex s_wakeMutex;
+static GCond s_wakeCond;
+static gint s_bFlushScheduled = 0;
+static gboolean s_bAsyncLog = FALSE;  // TRUE once the rings can be used
+static gboolean s_bFlusherStarted = FALSE;  // protected by s_ringsMutex
+
+static gpointer _flusher_thread (gpointer data);
+static void _schedule_flush (void);
+
+static void _on_thread_exit (CDLogRing *pRing)
+{
+	g_atomic_int_set (&pRing->bOwnerExited, TRUE);  // the flusher will free it once it's empty
+	_schedule_flush ();
+}
+static GPrivate s_threadRing = G_PRIVATE_INIT ((GDestroyNotify)_on_thread_exit);
+
+static CDLogRing *_get_thread_ring (void)
+{
+	CDLogRing *pRing = g_private_get (&s_threadRing);
+	if (pRing == NULL)
+	{
+		pRing = g_new0 (CDLogRing, 1);
+		g_private_set (&s_threadRing, pRing);
+		g_mutex_lock (&s_ringsMutex);
+		g_ptr_array_add (s_pLogRings, pRing);
+		if (! s_bFlusherStarted)
+		{
+			s_bFlusherStarted = TRUE;
+			g_thread_unref (g_thread_new ("cd-log", _flusher_thread, NULL));
+		}
+		g_mutex_unlock (&s_ringsMutex);
+	}
+	return pRing;
+}
+
+static void _write_entry (CDLogEntry *pEntry)
+{
+	if (s_bUseColors)
+		g_print ("%s\033[0;37m(%s) \033[%cm \n  %s\n", _cd_log_level_to_string (pEntry->iLevel), pEntry->cLocation, s_iLogColor, pEntry->cMessage);
+	else
+		g_print ("%s(%s)\n  %s\n", _cd_log_level_to_string (pEntry->iLevel), pEntry->cLocation, pEntry->cMessage);
+}
+
+void cd_log_flush (void)
+{
+	if (s_pLogRings == NULL)
+		return;
+	g_mutex_lock (&s_flushMutex);
+	g_mutex_lock (&s_ringsMutex);
+	guint i, n = s_pLogRings->len;
+	CDLogRing **pRings = g_newa (CDLogRing*, n + 1);
+	memcpy (pRings, s_pLogRings->pdata, n * sizeof (CDLogRing*));  // the rings can't be freed meanwhile, since only the flusher does it
+	g_mutex_unlock (&s_ringsMutex);
+	
+	// write the entries of all the threads in chronological order
+	CDLogRing *pRing, *pOldestRing;
+	CDLogEntry *pEntry;
+	guint iHead;
+	gint iNbLost;
+	do
+	{
+		pOldestRing = NULL;
+		for (i = 0; i < n; i ++)
+		{
+			pRing = pRings[i];
+			iHead = g_atomic_int_get (&pRing->iHead);  // the entries before the head are complete
+			if (pRing->iTail != iHead && (pOldestRing == NULL
+			|| pRing->entries[pRing->iTail % CD_LOG_RING_SIZE].iTime < pOldestRing->entries[pOldestRing->iTail % CD_LOG_RING_SIZE].iTime))
+				pOldestRing = pRing;
+		}
+		if (pOldestRing != NULL)
+		{
+			pEntry = &pOldestRing->entries[pOldestRing->iTail % CD_LOG_RING_SIZE];
+			_write_entry (pEntry);
+			g_atomic_int_set (&pOldestRing->iTail, pOldestRing->iTail + 1);  // release the entry to its thread
+		}
+	}
+	while (pOldestRing != NULL);
+	
+	for (i = 0; i < n; i ++)
+	{
+		pRing = pRings[i];
+		iNbLost = g_atomic_int_and ((guint*)&pRing->iNbLost, 0);
+		if (iNbLost != 0)
+			g_print ("%s%d log messages were lost (too many messages at once)\n", _cd_log_level_to_string (G_LOG_LEVEL_WARNING), iNbLost);
+		if (g_atomic_int_get (&pRing->bOwnerExited) && pRing->iTail == g_atomic_int_get (&pRing->iHead))
+		{
+			g_mutex_lock (&s_ringsMutex);
+			g_ptr_array_remove_fast (s_pLogRings, pRing);
+			g_mutex_unlock (&s_ringsMutex);
+			g_free (pRing);
+		}
+	}
+	fflush (stdout);
+	g_mutex_unlock (&s_flushMutex);
+}
+
+static gpointer _flusher_thread (G_GNUC_UNUSED gpointer data)
+{
+	while (TRUE)
+	{
+		g_mutex_lock (&s_wakeMutex);
+		while (! g_atomic_int_get (&s_bFlushScheduled))
+			g_cond_wait (&s_wakeCond, &s_wakeMutex);  // _schedule_flush signals under the mutex, so the wakeup can't be missed
+		g_atomic_int_set (&s_bFlushScheduled, 0);
+		g_mutex_unlock (&s_wakeMutex);
+		
+		cd_log_flush ();
+	}
+	return NULL;
+}
+
+static void _schedule_flush (void)
+{
+	if (g_atomic_int_compare_and_exchange (&s_bFlushScheduled, 0, 1))  // only the first message of a batch wakes up the flusher
+	{
+		g_mutex_lock (&s_wakeMutex);
+		g_cond_signal (&s_wakeCond);
+		g_mutex_unlock (&s_wakeMutex);
+	}
+}
+
+static void _write_uint (int fd, guint n)
+{
+	char buf[12];
+	int i = sizeof (buf);
+	do
+	{
+		buf[--i] = '0' + n % 10;
+		n /= 10;
+	} while (n != 0);
+	if (write (fd, buf + i, sizeof (buf) - i) < 0) return;
+}
+static void _write_str (int fd, const char *str)
+{
+	if (write (fd, str, strlen (str)) < 0) return;
+}
+
+void cd_log_dump_last_entries (int fd, int iNbEntries)
+{
+	if (s_pLogRings == NULL)
+		return;
+	// no lock and no stdio here: we're probably in a signal handler, maybe in the middle of a flush.
+	CDLogRing *pRing;
+	CDLogEntry *pEntry;
+	guint iHead, iTail, iNb, j, i;
+	for (i = 0; i < s_pLogRings->len; i ++)
+	{
+		pRing = g_ptr_array_index (s_pLogRings, i);
+		iHead = g_atomic_int_get (&pRing->iHead);
+		iTail = g_atomic_int_get (&pRing->iTail);
+		iNb = MIN (iHead, (guint)MIN (iNbEntries, CD_LOG_RING_SIZE));
+		if (iNb == 0)
+			continue;
+		_write_str (fd, "last log messages of thread #");
+		_write_uint (fd, i);
+		_write_str (fd, ":\n");
+		for (j = iHead - iNb; j != iHead; j ++)
+		{
+			pEntry = &pRing->entries[j % CD_LOG_RING_SIZE];
+			_write_str (fd, j - iTail < iHead - iTail ? "* " : "  ");  // mark the entries that hadn't been written yet
+			_write_str (fd, _cd_log_level_to_string (pEntry->iLevel));
+			_write_str (fd, "(");
+			_write_str (fd, pEntry->cLocation);
+			_write_str (fd, ") ");
+			_write_str (fd, pEntry->cMessage);
+			_write_str (fd, "\n");
+		}
+	}
+}
+
+
 void cd_log_location(const GLogLevelFlags loglevel,
                      const char *file,
                      const char *func,
@@ -108,6 +311,28 @@ void cd_log_location(const GLogLevelFlags loglevel,
 
   if (loglevel > s_gLogLevel)
     return;
+  if (s_bAsyncLog && loglevel > G_LOG_LEVEL_WARNING)
+  {
+    CDLogRing *pRing = _get_thread_ring ();
+    guint iHead = pRing->iHead;
+    if (iHead - (guint)g_atomic_int_get (&pRing->iTail) >= CD_LOG_RING_SIZE)  // full, the flusher is late
+    {
+      g_atomic_int_inc (&pRing->iNbLost);
+      _schedule_flush ();
+      return;
+    }
+    CDLogEntry *pEntry = &pRing->entries[iHead % CD_LOG_RING_SIZE];
+    pEntry->iTime = g_get_monotonic_time ();
+    pEntry->iLevel = loglevel;
+    g_snprintf (pEntry->cLocation, CD_LOG_LOCATION_SIZE, "%s:%s:%d", file, func, line);
+    va_start(args, format);
+    g_vsnprintf (pEntry->cMessage, CD_LOG_MESSAGE_SIZE, format, args);  // longer messages are truncated
+    va_end(args);
+    g_atomic_int_set (&pRing->iHead, iHead + 1);  // publish the entry
+    _schedule_flush ();
+    return;
+  }
+  cd_log_flush ();  // keep the order with the pending messages
   g_print("%s", _cd_log_level_to_string (loglevel));
   if (s_bUseColors)
     g_print("\033[0;37m(%s:%s:%d) \033[%cm \n  ", file, func, line, s_iLogColor);
@@ -134,6 +359,13 @@ void cd_log_init (gboolean bBlackTerminal)
 	g_log_set_default_handler(cairo_dock_log_handler, NULL);
 	s_iLogColor = (bBlackTerminal ? '1' : '0');
 	s_bUseColors = isatty (1);  // use colors iif our output is associated with a terminal (otherwise it's probably redirected into log file, color characters will be annoying).
+	
+	if (s_pLogRings == NULL)
+	{
+		s_pLogRings = g_ptr_array_new ();
+		s_bAsyncLog = TRUE;  // the flusher thread is started with the first ring
+		atexit (cd_log_flush);  // write the last messages when the program exits normally
+	}
 }
 
 void cd_log_set_level (GLogLevelFlags loglevel)
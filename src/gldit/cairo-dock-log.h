@@ -55,6 +55,18 @@ void cd_log_set_level(GLogLevelFlags loglevel);
  */
 void cd_log_set_level_from_name (const gchar *cVerbosity);
 
+/**
+ * Write the messages that are still waiting to be written. Messages are stored by the thread that emits them, and written by a dedicated thread, so that logging doesn't slow down the dock; warnings, errors and critical messages are written immediately.
+ */
+void cd_log_flush (void);
+
+/**
+ * Write the last messages of each thread on a file descriptor, including the ones that have not been written yet. It doesn't take any lock nor use stdio, so that it can be called from a signal handler after a crash.
+ *@param fd the file descriptor
+ *@param iNbEntries maximum number of messages per thread
+ */
+void cd_log_dump_last_entries (int fd, int iNbEntries);
+
 /**
  * Force the use of colors in the log messages even if these messages are not displayed into a tty.
  */
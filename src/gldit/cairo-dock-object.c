@@ -17,6 +17,8 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <string.h>  // memcpy
+
 #include "cairo-dock-struct.h"
 #include "cairo-dock-manager.h"
 #include "cairo-dock-log.h"
@@ -28,6 +30,8 @@
  * GLDI_OBJECT_IS_xxx obj->mgr == pMgr || mgr->parent->mrg == pMgr || ...
  * */
 
+static GHashTable *s_pObjectsWithNotifications = NULL;  // set of the objects that have had a callback registered on them, for the profiling
+
 
 void gldi_object_set_manager (GldiObject *pObject, GldiObjectManager *pMgr)
 {
@@ -67,6 +71,8 @@ void gldi_object_ref (GldiObject *pObject)
 	pObject->ref ++;
 }
 
+static void _clear_notifications (GldiObject *pObject);
+
 void gldi_object_unref (GldiObject *pObject)
 {
 	if (pObject == NULL)
@@ -87,14 +93,7 @@ void gldi_object_unref (GldiObject *pObject)
 		}
 		
 		// clear notifications
-		GPtrArray *pNotificationsTab = pObject->pNotificationsTab;
-		guint i;
-		for (i = 0; i < pNotificationsTab->len; i ++)
-		{
-			GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, i);
-			g_slist_free_full (pNotificationRecordList, g_free);
-		}
-		g_ptr_array_free (pNotificationsTab, TRUE);
+		_clear_notifications (pObject);
 		
 		// free memory
 		g_free (pObject);
@@ -149,24 +148,108 @@ gboolean gldi_object_is_manager_child (GldiObject *pObject, GldiObjectManager *p
 }
 
 
+  /////////////////////
+ /// NOTIFICATIONS ///
+/////////////////////
+
+static GldiNotificationRecords *_new_records (guint iNbRecords)
+{
+	GldiNotificationRecords *pRecords = g_malloc (sizeof (GldiNotificationRecords) + iNbRecords * sizeof (GldiNotificationRecord));
+	pRecords->ref = 1;
+	pRecords->bStale = FALSE;
+	pRecords->pNewer = NULL;
+	pRecords->iNbRecords = iNbRecords;
+	return pRecords;
+}
+
+void gldi_notification_records_unref (GldiNotificationRecords *pRecords)
+{
+	while (pRecords != NULL)
+	{
+		pRecords->ref --;
+		if (pRecords->ref > 0)
+			break;
+		GldiNotificationRecords *pNewer = pRecords->pNewer;
+		g_free (pRecords);
+		pRecords = pNewer;  // a stale array holds a reference on its successor
+	}
+}
+
+static void _install_records (GPtrArray *pNotificationsTab, GldiNotificationType iNotifType, GldiNotificationRecords *pRecords)
+{
+	GldiNotificationRecords *pPrevRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+	pNotificationsTab->pdata[iNotifType] = pRecords;
+	if (pPrevRecords != NULL)
+	{
+		// the previous array may still be iterated by a broadcast in progress; let it know where the current callbacks are.
+		pPrevRecords->bStale = TRUE;
+		pPrevRecords->pNewer = pRecords;
+		if (pRecords)
+			pRecords->ref ++;
+		gldi_notification_records_unref (pPrevRecords);
+	}
+}
+
+gboolean gldi_notification_record_is_registered (GldiNotificationRecords *pRecords, GldiNotificationRecord *pRecord)
+{
+	while (pRecords->bStale)  // go to the array currently installed
+	{
+		pRecords = pRecords->pNewer;
+		if (pRecords == NULL)  // no more callbacks, or the object is being destroyed
+			return FALSE;
+	}
+	guint i;
+	for (i = 0; i < pRecords->iNbRecords; i ++)
+	{
+		if (pRecords->pRecords[i].pFunction == pRecord->pFunction && pRecords->pRecords[i].pUserData == pRecord->pUserData)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void _clear_notifications (GldiObject *pObject)
+{
+	GPtrArray *pNotificationsTab = pObject->pNotificationsTab;
+	guint i;
+	for (i = 0; i < pNotificationsTab->len; i ++)
+	{
+		_install_records (pNotificationsTab, i, NULL);
+	}
+	g_ptr_array_free (pNotificationsTab, TRUE);
+	pObject->pNotificationsTab = NULL;
+	if (s_pObjectsWithNotifications != NULL)
+		g_hash_table_remove (s_pObjectsWithNotifications, pObject);
+}
+
 void gldi_object_register_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gboolean bRunFirst, gpointer pUserData)
 {
 	g_return_if_fail (pObject != NULL);
 	// grab the notifications tab
 	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
-	if (!pNotificationsTab || pNotificationsTab->len < iNotifType)
+	if (!pNotificationsTab || pNotificationsTab->len <= iNotifType)
 	{
 		cd_warning ("someone tried to register to an inexisting notification (%d) on an object of type '%s'", iNotifType, gldi_object_get_type(pObject));
 		return ;  // don't try to create/resize the notifications tab, since noone will emit this notification.
 	}
 	
 	// add a record
-	GldiNotificationRecord *pNotificationRecord = g_new (GldiNotificationRecord, 1);
+	GldiNotificationRecords *pPrevRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+	guint n = (pPrevRecords ? pPrevRecords->iNbRecords : 0);
+	GldiNotificationRecords *pRecords = _new_records (n + 1);
+	GldiNotificationRecord *pNotificationRecord = &pRecords->pRecords[bRunFirst ? 0 : n];
 	pNotificationRecord->pFunction = pFunction;
 	pNotificationRecord->pUserData = pUserData;
+	pNotificationRecord->iNbCalls = 0;
+	pNotificationRecord->iTime = 0;
+	pNotificationRecord->iCpuTime = 0;
+	if (n != 0)
+		memcpy (&pRecords->pRecords[bRunFirst ? 1 : 0], pPrevRecords->pRecords, n * sizeof (GldiNotificationRecord));
 	
-	GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);
-	pNotificationsTab->pdata[iNotifType] = (bRunFirst ? g_slist_prepend : g_slist_append) (pNotificationRecordList, pNotificationRecord);
+	_install_records (pNotificationsTab, iNotifType, pRecords);
+	
+	if (s_pObjectsWithNotifications == NULL)
+		s_pObjectsWithNotifications = g_hash_table_new (g_direct_hash, g_direct_equal);
+	g_hash_table_add (s_pObjectsWithNotifications, pObject);
 }
 
 
@@ -175,19 +258,102 @@ void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNo
 	g_return_if_fail (pObject != NULL);
 	// grab the notifications tab
 	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	g_return_if_fail (pNotificationsTab != NULL && iNotifType < pNotificationsTab->len);
 	
 	// remove the record
-	GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);
-	GldiNotificationRecord *pNotificationRecord;
-	GSList *nr;
-	for (nr = pNotificationRecordList; nr != NULL; nr = nr->next)
+	GldiNotificationRecords *pPrevRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+	if (pPrevRecords == NULL)
+		return;
+	guint i, n = pPrevRecords->iNbRecords;
+	for (i = 0; i < n; i ++)
 	{
-		pNotificationRecord = nr->data;
-		if (pNotificationRecord->pFunction == pFunction && pNotificationRecord->pUserData == pUserData)
-		{
-			pNotificationsTab->pdata[iNotifType] = g_slist_delete_link (pNotificationRecordList, nr);
-			g_free (pNotificationRecord);
+		if (pPrevRecords->pRecords[i].pFunction == pFunction && pPrevRecords->pRecords[i].pUserData == pUserData)
 			break;
+	}
+	if (i == n)  // not found
+		return;
+	
+	GldiNotificationRecords *pRecords = NULL;
+	if (n > 1)
+	{
+		pRecords = _new_records (n - 1);
+		memcpy (pRecords->pRecords, pPrevRecords->pRecords, i * sizeof (GldiNotificationRecord));
+		memcpy (&pRecords->pRecords[i], &pPrevRecords->pRecords[i+1], (n - i - 1) * sizeof (GldiNotificationRecord));
+	}
+	_install_records (pNotificationsTab, iNotifType, pRecords);
+}
+
+
+void gldi_object_get_notification_stats (gpointer pObject, GldiNotificationType iNotifType, guint *iNbCalls, gint64 *iTime, gint64 *iCpuTime)
+{
+	*iNbCalls = 0;
+	*iTime = 0;
+	*iCpuTime = 0;
+	g_return_if_fail (pObject != NULL);
+	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	if (pNotificationsTab == NULL || iNotifType >= pNotificationsTab->len)
+		return;
+	GldiNotificationRecords *pRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+	if (pRecords == NULL)
+		return;
+	guint i;
+	for (i = 0; i < pRecords->iNbRecords; i ++)
+	{
+		*iNbCalls += pRecords->pRecords[i].iNbCalls;
+		*iTime += pRecords->pRecords[i].iTime;
+		*iCpuTime += pRecords->pRecords[i].iCpuTime;
+	}
+}
+
+void gldi_object_foreach_notification_record (gpointer pObject, GldiNotificationRecordFunc pFunction, gpointer pUserData)
+{
+	g_return_if_fail (pObject != NULL);
+	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	if (pNotificationsTab == NULL)
+		return;
+	GldiNotificationRecords *pRecords;
+	guint iNotifType, i;
+	for (iNotifType = 0; iNotifType < pNotificationsTab->len; iNotifType ++)
+	{
+		pRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+		if (pRecords == NULL)
+			continue;
+		pRecords->ref ++;  // in case the action modifies the notifications
+		for (i = 0; i < pRecords->iNbRecords; i ++)
+			pFunction (iNotifType, &pRecords->pRecords[i], pUserData);
+		gldi_notification_records_unref (pRecords);
+	}
+}
+
+void gldi_object_reset_notification_stats (gpointer pObject)
+{
+	g_return_if_fail (pObject != NULL);
+	GPtrArray *pNotificationsTab = GLDI_OBJECT(pObject)->pNotificationsTab;
+	if (pNotificationsTab == NULL)
+		return;
+	GldiNotificationRecords *pRecords;
+	guint iNotifType, i;
+	for (iNotifType = 0; iNotifType < pNotificationsTab->len; iNotifType ++)
+	{
+		pRecords = g_ptr_array_index (pNotificationsTab, iNotifType);
+		if (pRecords == NULL)
+			continue;
+		for (i = 0; i < pRecords->iNbRecords; i ++)
+		{
+			pRecords->pRecords[i].iNbCalls = 0;
+			pRecords->pRecords[i].iTime = 0;
+			pRecords->pRecords[i].iCpuTime = 0;
 		}
 	}
 }
+
+void gldi_objects_foreach_with_notifications (GFunc pFunction, gpointer pUserData)
+{
+	if (s_pObjectsWithNotifications == NULL)
+		return;
+	GHashTableIter iter;
+	gpointer pObject;
+	g_hash_table_iter_init (&iter, s_pObjectsWithNotifications);
+	while (g_hash_table_iter_next (&iter, &pObject, NULL))
+		pFunction (pObject, pUserData);
+}
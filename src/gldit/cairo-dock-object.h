@@ -22,6 +22,7 @@
 
 #include <glib.h>
 #include "cairo-dock-struct.h"
+#include "cairo-dock-profiling.h"  // g_bProfileNotifications
 
 G_BEGIN_DECLS
 
@@ -112,11 +113,26 @@ gboolean gldi_object_is_manager_child (GldiObject *pObject, GldiObjectManager *p
 /// Generic prototype of a notification callback.
 typedef gboolean (* GldiNotificationFunc) (gpointer pUserData, ...);
 
+/// A callback registered for a notification, and what it has cost so far.
 typedef struct {
 	GldiNotificationFunc pFunction;
 	gpointer pUserData;
+	guint iNbCalls;  // number of times it has been called
+	gint64 iTime;  // time spent inside it, in microseconds (only measured while g_bProfileNotifications is TRUE)
+	gint64 iCpuTime;  // CPU time consumed inside it, in microseconds (same)
 	} GldiNotificationRecord;
 
+typedef struct _GldiNotificationRecords GldiNotificationRecords;
+
+/// Contiguous array of the callbacks registered for a notification on an object. Once installed it is never modified: registering or removing a callback installs a new array, so that a notification being broadcasted keeps iterating on its own snapshot.
+struct _GldiNotificationRecords {
+	gint ref;
+	gboolean bStale;  // TRUE once a new array has been installed in place of this one
+	GldiNotificationRecords *pNewer;  // the array that replaced this one, or NULL if the notification has no callback anymore
+	guint iNbRecords;
+	GldiNotificationRecord pRecords[];
+	};
+
 typedef guint GldiNotificationType;
 
 /// Use this in \ref gldi_object_register_notification to be called before the core.
@@ -148,7 +164,7 @@ typedef guint GldiNotificationType;
 void gldi_object_register_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gboolean bRunFirst, gpointer pUserData);
 
 /** Remove a callback from the list of callbacks of a given object for a given notification and a given data.
-Note: it is safe to remove the callback when it is called, but not another one.
+Note: it is safe to register or remove any callback while the notification is being broadcasted; a callback removed meanwhile won't be called, and a callback registered meanwhile will only be called on the next broadcast.
 *@param pObject the object (Icon, Container, Manager) for which the action has been registered.
 *@param iNotifType type of the notification.
 *@param pFunction callback.
@@ -157,14 +173,31 @@ Note: it is safe to remove the callback when it is called, but not another one.
 void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNotifType, GldiNotificationFunc pFunction, gpointer pUserData);
 
 
-#define __notify(pNotificationRecordList, bStop, ...) do {\
+/* Tell if a callback of a stale array of records is still registered, ie if it has not been removed since the array was replaced.
+ */
+gboolean gldi_notification_record_is_registered (GldiNotificationRecords *pRecords, GldiNotificationRecord *pRecord);
+
+void gldi_notification_records_unref (GldiNotificationRecords *pRecords);
+
+#define __notify(pNotificationRecords, bStop, ...) do {\
 	GldiNotificationRecord *pNotificationRecord;\
-	GSList *pElement = pNotificationRecordList, *pNextElement;\
-	while (pElement != NULL && ! bStop) {\
-		pNotificationRecord = pElement->data;\
-		pNextElement = pElement->next;\
+	guint _i;\
+	gint64 _iTime, _iCpuTime = 0;\
+	pNotificationRecords->ref ++;\
+	for (_i = 0; _i < pNotificationRecords->iNbRecords && ! bStop; _i ++) {\
+		pNotificationRecord = &pNotificationRecords->pRecords[_i];\
+		if (pNotificationRecords->bStale && ! gldi_notification_record_is_registered (pNotificationRecords, pNotificationRecord))\
+			continue;\
+		_iTime = 0;\
+		if (g_bProfileNotifications) {\
+			_iTime = g_get_monotonic_time ();\
+			_iCpuTime = gldi_profiling_get_thread_cpu_time (); }\
 		bStop = pNotificationRecord->pFunction (pNotificationRecord->pUserData, ##__VA_ARGS__);\
-		pElement = pNextElement; }\
+		pNotificationRecord->iNbCalls ++;\
+		if (_iTime != 0) {\
+			pNotificationRecord->iTime += g_get_monotonic_time () - _iTime;\
+			pNotificationRecord->iCpuTime += gldi_profiling_get_thread_cpu_time () - _iCpuTime; } }\
+	gldi_notification_records_unref (pNotificationRecords);\
 	} while (0)
 
 #define __notify_on_object(pObject, iNotifType, ...) \
@@ -172,8 +205,9 @@ void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNo
 	gboolean _stop = FALSE;\
 	GPtrArray *pNotificationsTab = (pObject)->pNotificationsTab;\
 	if (pNotificationsTab && iNotifType < pNotificationsTab->len) {\
-		GSList *pNotificationRecordList = g_ptr_array_index (pNotificationsTab, iNotifType);\
-		__notify (pNotificationRecordList, _stop, ##__VA_ARGS__);} \
+		GldiNotificationRecords *_pRecords = g_ptr_array_index (pNotificationsTab, iNotifType);\
+		if (_pRecords != NULL)\
+			__notify (_pRecords, _stop, ##__VA_ARGS__);} \
 	else {_stop = TRUE;}\
 	_stop; })
 
@@ -193,6 +227,36 @@ void gldi_object_remove_notification (gpointer pObject, GldiNotificationType iNo
 
 
 
+/** Get the cost of a notification on an object (not including its managers), summed over all the callbacks registered on it.
+*@param pObject the object (Icon, Container, Manager).
+*@param iNotifType type of the notification.
+*@param iNbCalls filled with the number of calls to the callbacks.
+*@param iTime filled with the time spent inside the callbacks, in microseconds.
+*@param iCpuTime filled with the CPU time consumed inside the callbacks, in microseconds.
+*/
+void gldi_object_get_notification_stats (gpointer pObject, GldiNotificationType iNotifType, guint *iNbCalls, gint64 *iTime, gint64 *iCpuTime);
+
+typedef void (* GldiNotificationRecordFunc) (GldiNotificationType iNotifType, const GldiNotificationRecord *pRecord, gpointer pUserData);
+
+/** Execute an action on each callback registered on an object, for any notification. It lets you know which callback costs what.
+*@param pObject the object (Icon, Container, Manager).
+*@param pFunction the action.
+*@param pUserData data passed to the action.
+*/
+void gldi_object_foreach_notification_record (gpointer pObject, GldiNotificationRecordFunc pFunction, gpointer pUserData);
+
+/** Reset the number of calls and the time of all the callbacks registered on an object.
+*@param pObject the object (Icon, Container, Manager).
+*/
+void gldi_object_reset_notification_stats (gpointer pObject);
+
+/** Execute an action on each object (Icon, Container, Manager, ObjectManager, ...) that has had a callback registered on it.
+*@param pFunction the action, called with the object; it must not create or destroy any object.
+*@param pUserData data passed to the action.
+*/
+void gldi_objects_foreach_with_notifications (GFunc pFunction, gpointer pUserData);
+
+
 #define	GLDI_STR_HELPER(x) #x
 #define	GLDI_STR(x) GLDI_STR_HELPER(x)
 
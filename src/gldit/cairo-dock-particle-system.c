@@ -23,6 +23,7 @@
 #include <cairo.h>
 
 #include "cairo-dock-draw-opengl.h"
+#include "cairo-dock-image-buffer.h"
 #include "cairo-dock-particle-system.h"
 
 static GLfloat s_pCornerCoords[8] = {0.0, 0.0,
@@ -30,120 +31,101 @@ static GLfloat s_pCornerCoords[8] = {0.0, 0.0,
 	1.0, 1.0,
 	1.0, 0.0};
 
-void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int iDepth)
+// vertical position of the center of a particle, in the frame of the particle system (Y upward).
+#define _get_particle_y(pParticleSystem, p) ((pParticleSystem)->bDirectionUp ? (p)->y * (pParticleSystem)->fHeight : (pParticleSystem)->fHeight - (p)->y * (pParticleSystem)->fHeight)
+
+static inline GLfloat *_write_quad (GLfloat *vertices, GLfloat x, GLfloat y, GLfloat z, GLfloat w, GLfloat h)
+{
+	vertices[0] = x - w;
+	vertices[1] = y + h;
+	vertices[2] = z;
+	vertices[3] = x - w;
+	vertices[4] = y - h;
+	vertices[5] = z;
+	vertices[6] = x + w;
+	vertices[7] = y - h;
+	vertices[8] = z;
+	vertices[9] = x + w;
+	vertices[10] = y + h;
+	vertices[11] = z;
+	return vertices + 12;
+}
+
+static inline GLfloat *_write_quad_color (GLfloat *colors, GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	int j;
+	for (j = 0; j < 4; j ++, colors += 4)  // same color on the 4 corners.
+	{
+		colors[0] = r;
+		colors[1] = g;
+		colors[2] = b;
+		colors[3] = a;
+	}
+	return colors;
+}
+
+int cairo_dock_compute_particles_vertices (CairoParticleSystem *pParticleSystem, int iDepth)
 {
-	_cairo_dock_enable_texture ();
-	
-	if (pParticleSystem->bAddLuminance)
-		_cairo_dock_set_blend_over ();
-		//glBlendFunc (GL_SRC_ALPHA, GL_ONE);
-	else
-		_cairo_dock_set_blend_alpha ();
-	
-	glBindTexture(GL_TEXTURE_2D, pParticleSystem->iTexture);
-	
 	GLfloat *vertices = pParticleSystem->pVertices;
-	///GLfloat *coords = pParticleSystem->pCoords;
 	GLfloat *colors = pParticleSystem->pColors;
 	GLfloat *vertices2 = &pParticleSystem->pVertices[pParticleSystem->iNbParticles * 4 * 3];
-	///GLfloat *coords2 = &pParticleSystem->pCoords[pParticleSystem->iNbParticles * 4 * 2];
 	GLfloat *colors2 = &pParticleSystem->pColors[pParticleSystem->iNbParticles * 4 * 4];
 	
 	GLfloat x,y,z;
 	GLfloat w, h;
-	GLfloat fHeight = pParticleSystem->fHeight;
+	GLfloat fHalfWidth = pParticleSystem->fWidth / 2;
+	gboolean bAddLight = pParticleSystem->bAddLight;
 	
-	int numActive = 0;
-	CairoParticle *p;
-	int i;
-	for (i = 0; i < pParticleSystem->iNbParticles; i ++)
+	int n = 0;
+	CairoParticle *p = pParticleSystem->pParticles, *pEnd = p + pParticleSystem->iNbParticles;
+	for (; p < pEnd; p ++)
 	{
-		p = &pParticleSystem->pParticles[i];
 		if (p->iLife == 0 || iDepth * p->z < 0)
 			continue;
 		
-		numActive += 4;
+		n ++;
 		w = p->fWidth * p->fSizeFactor;
 		h = p->fHeight * p->fSizeFactor;
-		x = p->x * pParticleSystem->fWidth / 2;
-		y = p->y * pParticleSystem->fHeight;
+		x = p->x * fHalfWidth;
+		y = _get_particle_y (pParticleSystem, p);
 		z = p->z;
 		
-		vertices[0] = x - w;
-		vertices[2] = z;
-		vertices[3] = x - w;
-		vertices[5] = z;
-		vertices[6] = x + w;
-		vertices[8] = z;
-		vertices[9] = x + w;
-		vertices[11] = z;
-		if (pParticleSystem->bDirectionUp)
-		{
-			vertices[1] = y + h;
-			vertices[4] = y - h;
-			vertices[7] = y - h;
-			vertices[10] = y + h;
-		}
-		else
-		{
-			vertices[1] = fHeight - y + h;
-			vertices[4] = fHeight - y - h;
-			vertices[7] = fHeight - y - h;
-			vertices[10] = fHeight - y + h;
-		}
-		vertices += 12;
+		vertices = _write_quad (vertices, x, y, z, w, h);
+		colors = _write_quad_color (colors, p->color[0], p->color[1], p->color[2], p->color[3]);
 		
-		///memcpy (coords, s_pCornerCoords, sizeof (s_pCornerCoords));
-		///coords += 8;
-
-		colors[0] = p->color[0];
-		colors[1] = p->color[1];
-		colors[2] = p->color[2];
-		colors[3] = p->color[3];
-		memcpy (colors + 4, colors, 4*sizeof (GLfloat));
-		memcpy (colors + 8, colors, 8*sizeof (GLfloat));
-		colors += 16;
-		
-		if (pParticleSystem->bAddLight)
+		if (bAddLight)  // a smaller white particle on top of it.
 		{
-			w/=1.6;
-			h/=1.6;
-			vertices2[0] = x - w;
-			vertices2[2] = z;
-			vertices2[3] = x - w;
-			vertices2[5] = z;
-			vertices2[6] = x + w;
-			vertices2[8] = z;
-			vertices2[9] = x + w;
-			vertices2[11] = z;
-			if (pParticleSystem->bDirectionUp)
-			{
-				vertices2[1] = y + h;
-				vertices2[4] = y - h;
-				vertices2[7] = y - h;
-				vertices2[10] = y + h;
-			}
-			else
-			{
-				vertices2[1] = fHeight - y + h;
-				vertices2[4] = fHeight - y - h;
-				vertices2[7] = fHeight - y - h;
-				vertices2[10] = fHeight - y + h;
-			}
-			vertices2 += 12;
-			
-			///memcpy (coords2, s_pCornerCoords, sizeof (s_pCornerCoords));
-			///coords2 += 8;
-			
-			colors2[0] = 1;
-			colors2[1] = 1;
-			colors2[2] = 1;
-			colors2[3] = colors[3];
-			memcpy (colors2 + 4, colors2, 4*sizeof (GLfloat));
-			memcpy (colors2 + 8, colors2, 8*sizeof (GLfloat));
-			colors2 += 16;
+			vertices2 = _write_quad (vertices2, x, y, z, w/1.6, h/1.6);
+			colors2 = _write_quad_color (colors2, 1., 1., 1., p->color[3]);
 		}
 	}
+	if (! bAddLight)
+		return 4 * n;
+	
+	// the white particles are drawn with the others, so they must follow them.
+	if (n < pParticleSystem->iNbParticles)
+	{
+		memmove (vertices, &pParticleSystem->pVertices[pParticleSystem->iNbParticles * 4 * 3], n * 4 * 3 * sizeof (GLfloat));
+		memmove (colors, &pParticleSystem->pColors[pParticleSystem->iNbParticles * 4 * 4], n * 4 * 4 * sizeof (GLfloat));
+	}
+	return 8 * n;
+}
+
+void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int iDepth)
+{
+	int iNbVertices = cairo_dock_compute_particles_vertices (pParticleSystem, iDepth);
+	if (iNbVertices == 0)
+		return;
+	
+	_cairo_dock_enable_texture ();
+	
+	if (pParticleSystem->bAddLuminance)
+		_cairo_dock_set_blend_over ();
+		//glBlendFunc (GL_SRC_ALPHA, GL_ONE);
+	else
+		_cairo_dock_set_blend_alpha ();
+	
+	glBindTexture(GL_TEXTURE_2D, pParticleSystem->iTexture);
 	
 	glEnableClientState(GL_COLOR_ARRAY);
 	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
@@ -153,7 +135,7 @@ void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int
 	glVertexPointer(3, GL_FLOAT, 3 * sizeof(GLfloat), pParticleSystem->pVertices);
 	glColorPointer(4, GL_FLOAT, 4 * sizeof(GLfloat), pParticleSystem->pColors);
 
-	glDrawArrays(GL_QUADS, 0, pParticleSystem->bAddLight ? numActive*2 : numActive);
+	glDrawArrays(GL_QUADS, 0, iNbVertices);
 
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState (GL_TEXTURE_COORD_ARRAY);
@@ -162,6 +144,44 @@ void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int
 	_cairo_dock_disable_texture ();
 }
 
+static inline void _render_particle_cairo (cairo_t *pCairoContext, CairoDockImageBuffer *pImage, double x, double y, double w, double h)
+{
+	cairo_save (pCairoContext);
+	cairo_translate (pCairoContext, x - w, - y - h);  // Y goes downward with cairo.
+	cairo_scale (pCairoContext, 2 * w / pImage->iWidth, 2 * h / pImage->iHeight);
+	cairo_mask_surface (pCairoContext, pImage->pSurface, 0., 0.);
+	cairo_restore (pCairoContext);
+}
+
+void cairo_dock_render_particles_cairo_full (CairoParticleSystem *pParticleSystem, cairo_t *pCairoContext, CairoDockImageBuffer *pImage, int iDepth)
+{
+	g_return_if_fail (pImage != NULL && pImage->pSurface != NULL && pImage->iWidth != 0 && pImage->iHeight != 0);
+	
+	double x, y, w, h;
+	double fHalfWidth = pParticleSystem->fWidth / 2;
+	CairoParticle *p = pParticleSystem->pParticles, *pEnd = p + pParticleSystem->iNbParticles;
+	for (; p < pEnd; p ++)
+	{
+		if (p->iLife == 0 || iDepth * p->z < 0 || p->color[3] <= 0)
+			continue;
+		
+		w = p->fWidth * p->fSizeFactor;
+		h = p->fHeight * p->fSizeFactor;
+		x = p->x * fHalfWidth;
+		y = _get_particle_y (pParticleSystem, p);
+		
+		// the image is used as a mask for the color of the particle, which is the same as mapping a white texture with this color.
+		cairo_set_source_rgba (pCairoContext, p->color[0], p->color[1], p->color[2], p->color[3]);
+		_render_particle_cairo (pCairoContext, pImage, x, y, w, h);
+		
+		if (pParticleSystem->bAddLight)
+		{
+			cairo_set_source_rgba (pCairoContext, 1., 1., 1., p->color[3]);
+			_render_particle_cairo (pCairoContext, pImage, x, y, w/1.6, h/1.6);
+		}
+	}
+}
+
 CairoParticleSystem *cairo_dock_create_particle_system (int iNbParticles, GLuint iTexture, double fWidth, double fHeight)
 {
 	g_return_val_if_fail (iNbParticles > 0, NULL);
@@ -208,19 +228,29 @@ void cairo_dock_free_particle_system (CairoParticleSystem *pParticleSystem)
 }
 
 
+// sine of an angle in [-pi, pi], with a polynomial (precision ~1e-4, which is plenty for the oscillations of the particles, and much cheaper than sin()).
+static inline GLfloat _fast_sin (GLfloat x)
+{
+	if (x > G_PI/2)
+		x = G_PI - x;
+	else if (x < -G_PI/2)
+		x = -G_PI - x;
+	GLfloat x2 = x * x;
+	return x * (1 - x2/6 * (1 - x2/20 * (1 - x2/42)));
+}
+
 gboolean cairo_dock_update_default_particle_system (CairoParticleSystem *pParticleSystem, CairoDockRewindParticleFunc pRewindParticle)
 {
 	gboolean bAllParticlesEnded = TRUE;
-	CairoParticle *p;
-	int i;
-	for (i = 0; i < pParticleSystem->iNbParticles; i ++)
+	CairoParticle *p = pParticleSystem->pParticles, *pEnd = p + pParticleSystem->iNbParticles;
+	for (; p < pEnd; p ++)
 	{
-		p = &(pParticleSystem->pParticles[i]);
-		
 		p->fOscillation += p->fOmega;
-		p->x += p->vx + (p->z + 2)/3. * .02 * sin (p->fOscillation);  // 3%
+		if (p->fOscillation > G_PI || p->fOscillation < -G_PI)  // keep the phase in [-pi, pi], so that it doesn't lose its precision over time.
+			p->fOscillation -= 2*G_PI * floorf ((p->fOscillation + G_PI) / (2*G_PI));
+		p->x += p->vx + (p->z + 2)/3.f * .02f * _fast_sin (p->fOscillation);  // 3%
 		p->y += p->vy;
-		p->color[3] = 1.*p->iLife / p->iInitialLife;
+		p->color[3] = (GLfloat)p->iLife / p->iInitialLife;
 		p->fSizeFactor += p->fResizeSpeed;
 		if (p->iLife > 0)
 		{
@@ -22,12 +22,13 @@
 #define  __CAIRO_DOCK_PARTICLE_SYSTEM__
 
 #include <glib.h>
+#include "cairo-dock-struct.h"
 
 G_BEGIN_DECLS
 
 /**
 *@file cairo-dock-particle-system.h A Particle System is a set of particles that evolve according to a given model. Each particle will see its parameters change with time : direction, speed, oscillation, color, size, etc.
-* Particle Systems fully take advantage of OpenGL and are able to render many thousands of particles at a high frequency refresh.
+* Particle Systems fully take advantage of OpenGL and are able to render many thousands of particles at a high frequency refresh. They can also be rendered with Cairo, for a small number of particles.
 * 
 */
 
@@ -79,6 +80,13 @@ typedef struct _CairoParticleSystem {
 /// Function that re-initializes a particle when its life is over.
 typedef void (CairoDockRewindParticleFunc) (CairoParticle *pParticle, double dt);
 
+/** Compute the quads of the particles of a particle system with a given depth into its vertices and colors buffers, without drawing them. This is done by #cairo_dock_render_particles_full.
+*@param pParticleSystem the particle system.
+*@param iDepth depth of the particles (see #cairo_dock_render_particles_full).
+*@return the number of vertices to draw.
+*/
+int cairo_dock_compute_particles_vertices (CairoParticleSystem *pParticleSystem, int iDepth);
+
 /** Render all the particles of a particle system with a given depth.
 *@param pParticleSystem the particle system.
 *@param iDepth depth of the particles that will be rendered. If set to -1, only particles with a negative z will be rendered, if set to 1, only particles with a positive z will be rendered, if set to 0, all the particles will be rendered.
@@ -89,6 +97,20 @@ void cairo_dock_render_particles_full (CairoParticleSystem *pParticleSystem, int
 */
 #define cairo_dock_render_particles(pParticleSystem) cairo_dock_render_particles_full (pParticleSystem, 0)
 
+/** Render all the particles of a particle system with a given depth, with Cairo. The image is used as a mask for the color of each particle, so it should be white, like the texture in OpenGL.
+*@param pParticleSystem the particle system.
+*@param pCairoContext the context to draw on; its origin is at the center-bottom of the particle system, and the particles are drawn upward from it, like in OpenGL.
+*@param pImage image of a particle.
+*@param iDepth depth of the particles that will be rendered (see #cairo_dock_render_particles_full).
+*/
+void cairo_dock_render_particles_cairo_full (CairoParticleSystem *pParticleSystem, cairo_t *pCairoContext, CairoDockImageBuffer *pImage, int iDepth);
+/** Render all the particles of a particle system, with Cairo.
+*@param pParticleSystem the particle system.
+*@param pCairoContext the context to draw on (see #cairo_dock_render_particles_cairo_full).
+*@param pImage image of a particle.
+*/
+#define cairo_dock_render_particles_cairo(pParticleSystem, pCairoContext, pImage) cairo_dock_render_particles_cairo_full (pParticleSystem, pCairoContext, pImage, 0)
+
 /**  Create a particle system.
 *@param iNbParticles number of particles of the system.
 *@param iTexture texture to map on each particle.
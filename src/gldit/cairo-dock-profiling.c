@@ -0,0 +1,252 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE  // dladdr, clock_gettime
+#include <time.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#include <glib/gstdio.h>
+
+#include "cairo-dock-object.h"
+#include "cairo-dock-manager.h"  // GLDI_OBJECT_IS_MANAGER
+#include "cairo-dock-module-manager.h"  // gldi_module_foreach
+#include "cairo-dock-module-instance-manager.h"  // GldiModuleInstance
+#include "cairo-dock-task.h"  // gldi_tasks_foreach, gldi_task_get_nb_wakeups_per_minute
+#include "cairo-dock-surface-factory.h"  // cairo_dock_get_text_surface_cache_stats
+#include "cairo-dock-log.h"
+#include "cairo-dock-profiling.h"
+
+gboolean g_bProfileNotifications = FALSE;
+
+typedef struct {
+	gchar *cKey;  // "owner\tobject\tevent"
+	guint iNbCalls;
+	gint64 iTime;
+	gint64 iCpuTime;
+	} CDProfilingEntry;
+
+typedef struct {
+	GHashTable *pInstances;  // set of the module instances, to recognize the data of the callbacks
+	GHashTable *pEntries;  // key -> CDProfilingEntry
+	GldiObject *pObject;  // object being walked
+	} CDProfilingReport;
+
+
+void gldi_profiling_set_enabled (gboolean bEnable)
+{
+	if (bEnable != g_bProfileNotifications)
+		cd_message ("profiling %s", bEnable ? "enabled" : "disabled");
+	g_bProfileNotifications = bEnable;
+}
+
+gint64 gldi_profiling_get_thread_cpu_time (void)
+{
+	struct timespec t;
+	if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &t) != 0)
+		return 0;
+	return (gint64)t.tv_sec * G_USEC_PER_SEC + t.tv_nsec / 1000;
+}
+
+
+  //////////////
+ /// REPORT ///
+//////////////
+
+static gboolean _add_instances (G_GNUC_UNUSED gpointer key, GldiModule *pModule, GHashTable *pInstances)
+{
+	GList *i;
+	for (i = pModule->pInstancesList; i != NULL; i = i->next)
+		g_hash_table_add (pInstances, i->data);
+	return FALSE;  // continue
+}
+
+// name of the library containing a function (the executable for the core of the dock), with the name of the function if it is exported.
+static gchar *_get_function_owner (gpointer pFunction)
+{
+	Dl_info info;
+	if (pFunction == NULL || dladdr (pFunction, &info) == 0 || info.dli_fname == NULL)
+		return g_strdup_printf ("%p", pFunction);
+	const gchar *cLibName = strrchr (info.dli_fname, '/');
+	cLibName = (cLibName ? cLibName + 1 : info.dli_fname);
+	if (info.dli_sname != NULL)
+		return g_strdup_printf ("%s:%s", cLibName, info.dli_sname);
+	return g_strdup_printf ("%s+%p", cLibName, (gpointer)((gchar*)pFunction - (gchar*)info.dli_fbase));
+}
+
+static gchar *_get_callback_owner (CDProfilingReport *pReport, GldiNotificationFunc pFunction, gpointer pUserData)
+{
+	if (pUserData != NULL && g_hash_table_contains (pReport->pInstances, pUserData))
+	{
+		GldiModuleInstance *pInstance = pUserData;
+		gchar *cConfFileName = (pInstance->cConfFilePath ? g_path_get_basename (pInstance->cConfFilePath) : NULL);
+		gchar *cOwner = g_strdup_printf ("%s[%s]", pInstance->pModule->pVisitCard->cModuleName, cConfFileName ? cConfFileName : "-");
+		g_free (cConfFileName);
+		return cOwner;
+	}
+	return _get_function_owner (pFunction);
+}
+
+static const gchar *_get_object_name (GldiObject *pObject)
+{
+	if (pObject->ref == 0)  // the ObjectManagers are static objects that are never initialized
+		return ((GldiObjectManager*)pObject)->cName;
+	if (GLDI_OBJECT_IS_MANAGER (pObject))
+		return ((GldiManager*)pObject)->cModuleName;
+	return gldi_object_get_type (pObject);
+}
+
+static void _add_to_entry (CDProfilingReport *pReport, gchar *cKey, guint iNbCalls, gint64 iTime, gint64 iCpuTime)  // takes the key
+{
+	CDProfilingEntry *pEntry = g_hash_table_lookup (pReport->pEntries, cKey);
+	if (pEntry == NULL)
+	{
+		pEntry = g_new0 (CDProfilingEntry, 1);
+		pEntry->cKey = cKey;
+		g_hash_table_insert (pReport->pEntries, cKey, pEntry);
+	}
+	else
+		g_free (cKey);
+	pEntry->iNbCalls += iNbCalls;
+	pEntry->iTime += iTime;
+	pEntry->iCpuTime += iCpuTime;
+}
+
+static void _add_record (GldiNotificationType iNotifType, const GldiNotificationRecord *pRecord, CDProfilingReport *pReport)
+{
+	if (pRecord->iNbCalls == 0)
+		return;
+	gchar *cOwner = _get_callback_owner (pReport, pRecord->pFunction, pRecord->pUserData);
+	gchar *cKey = g_strdup_printf ("%s\t%s\tnotification %u", cOwner, _get_object_name (pReport->pObject), iNotifType);
+	g_free (cOwner);
+	_add_to_entry (pReport, cKey, pRecord->iNbCalls, pRecord->iTime, pRecord->iCpuTime);
+}
+
+static void _add_object (GldiObject *pObject, CDProfilingReport *pReport)
+{
+	pReport->pObject = pObject;
+	gldi_object_foreach_notification_record (pObject, (GldiNotificationRecordFunc) _add_record, pReport);
+}
+
+static void _add_task (GldiTask *pTask, CDProfilingReport *pReport)
+{
+	gchar *cOwner = _get_function_owner (pTask->get_data ? (gpointer)pTask->get_data : (gpointer)pTask->update);
+	if (pTask->iNbGetData != 0)
+		_add_to_entry (pReport, g_strdup_printf ("%s\tTask\tget_data", cOwner), pTask->iNbGetData, pTask->iGetDataTime, pTask->iGetDataCpuTime);
+	if (pTask->iNbUpdates != 0)
+		_add_to_entry (pReport, g_strdup_printf ("%s\tTask\tupdate", cOwner), pTask->iNbUpdates, pTask->iUpdateTime, pTask->iUpdateCpuTime);
+	g_free (cOwner);
+}
+
+static int _compare_entries (const CDProfilingEntry *e1, const CDProfilingEntry *e2)
+{
+	if (e1->iCpuTime != e2->iCpuTime)
+		return (e1->iCpuTime > e2->iCpuTime ? -1 : 1);
+	if (e1->iTime != e2->iTime)
+		return (e1->iTime > e2->iTime ? -1 : 1);
+	return (e1->iNbCalls > e2->iNbCalls ? -1 : e1->iNbCalls < e2->iNbCalls);
+}
+
+gchar *gldi_profiling_get_report (void)
+{
+	CDProfilingReport report;
+	report.pInstances = g_hash_table_new (g_direct_hash, g_direct_equal);
+	report.pEntries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, NULL);  // the entries own their key
+	report.pObject = NULL;
+	
+	gldi_module_foreach ((GHRFunc) _add_instances, report.pInstances);
+	gldi_objects_foreach_with_notifications ((GFunc) _add_object, &report);
+	gldi_tasks_foreach ((GFunc) _add_task, &report);
+	
+	GList *pEntries = g_list_sort (g_hash_table_get_values (report.pEntries), (GCompareFunc) _compare_entries);
+	GString *sReport = g_string_new ("");
+	g_string_append_printf (sReport, "# time of the notifications: %s\n", g_bProfileNotifications ? "measured" : "not measured");
+	guint iNbHits, iNbMisses;
+	gsize iMemory;
+	cairo_dock_get_text_surface_cache_stats (&iNbHits, &iNbMisses, &iMemory);
+	g_string_append_printf (sReport, "# text surfaces: %u found in the cache, %u drawn, %" G_GSIZE_FORMAT " KB in the cache\n", iNbHits, iNbMisses, iMemory / 1024);
+	g_string_append_printf (sReport, "# wakeups of the periodic tasks during the last minute: %u\n", gldi_task_get_nb_wakeups_per_minute ());
+	g_string_append (sReport, "# owner\tobject\tevent\tcalls\ttime (ms)\tCPU time (ms)\n");
+	CDProfilingEntry *pEntry;
+	GList *e;
+	for (e = pEntries; e != NULL; e = e->next)
+	{
+		pEntry = e->data;
+		g_string_append_printf (sReport, "%s\t%u\t%.3f\t%.3f\n", pEntry->cKey, pEntry->iNbCalls, pEntry->iTime / 1e3, pEntry->iCpuTime / 1e3);
+		g_free (pEntry->cKey);
+		g_free (pEntry);
+	}
+	g_list_free (pEntries);
+	g_hash_table_destroy (report.pEntries);
+	g_hash_table_destroy (report.pInstances);
+	return g_string_free (sReport, FALSE);
+}
+
+gboolean gldi_profiling_dump_report (const gchar *cFilePath)
+{
+	gchar *cDefaultPath = NULL;
+	if (cFilePath == NULL)
+	{
+		gchar *cDir = g_build_filename (g_get_user_cache_dir (), "cairo-dock", NULL);
+		g_mkdir_with_parents (cDir, 7*8*8+7*8+5);
+		cDefaultPath = g_build_filename (cDir, "profiling.txt", NULL);
+		g_free (cDir);
+		cFilePath = cDefaultPath;
+	}
+	
+	gchar *cReport = gldi_profiling_get_report ();
+	GError *erreur = NULL;
+	gboolean bSuccess = g_file_set_contents (cFilePath, cReport, -1, &erreur);
+	if (erreur != NULL)
+	{
+		cd_warning ("couldn't write the profiling report into '%s': %s", cFilePath, erreur->message);
+		g_error_free (erreur);
+	}
+	else
+		cd_message ("profiling report written into '%s'", cFilePath);
+	g_free (cReport);
+	g_free (cDefaultPath);
+	return bSuccess;
+}
+
+
+  /////////////
+ /// RESET ///
+/////////////
+
+static void _reset_object (GldiObject *pObject, G_GNUC_UNUSED gpointer data)
+{
+	gldi_object_reset_notification_stats (pObject);
+}
+
+static void _reset_task (GldiTask *pTask, G_GNUC_UNUSED gpointer data)
+{
+	pTask->iNbGetData = 0;
+	pTask->iGetDataTime = 0;
+	pTask->iGetDataCpuTime = 0;
+	pTask->iNbUpdates = 0;
+	pTask->iUpdateTime = 0;
+	pTask->iUpdateCpuTime = 0;
+}
+
+void gldi_profiling_reset (void)
+{
+	gldi_objects_foreach_with_notifications ((GFunc) _reset_object, NULL);
+	gldi_tasks_foreach ((GFunc) _reset_task, NULL);
+}
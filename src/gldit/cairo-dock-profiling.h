@@ -0,0 +1,65 @@
+/*
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CAIRO_DOCK_PROFILING__
+#define  __CAIRO_DOCK_PROFILING__
+
+#include <glib.h>
+G_BEGIN_DECLS
+
+/**
+*@file cairo-dock-profiling.h This class measures where the dock spends its time, so that a misbehaving applet can be spotted.
+* The cost of each notification callback is accounted in its record (see \ref gldi_object_get_notification_stats), and the cost of each Task in the Task itself (see \ref gldi_tasks_foreach).
+* This class gathers all these numbers in a report, attributing each callback to the module instance it has been registered for, or else to the library it belongs to.
+*
+* The number of calls is always counted. The time spent in the Tasks is always measured too, since they run at most once per second; the time spent in the notifications is only measured while the profiling is enabled, since some of them are broadcasted for each icon at each frame.
+*/
+
+/// TRUE while the profiling is enabled; it's what the notifications check before measuring their callbacks. Use \ref gldi_profiling_set_enabled to change it.
+extern gboolean g_bProfileNotifications;
+
+/** Enable or disable the measure of the time spent in the notifications callbacks.
+*@param bEnable TRUE to enable the profiling.
+*/
+void gldi_profiling_set_enabled (gboolean bEnable);
+
+#define gldi_profiling_is_enabled() g_bProfileNotifications
+
+/** Get the CPU time consumed by the calling thread so far.
+*@return the CPU time, in microseconds.
+*/
+gint64 gldi_profiling_get_thread_cpu_time (void);
+
+/** Build a report of the cost of the notifications callbacks, grouped by (owner, notification), and of the Tasks, grouped by (owner, phase). The entries are sorted by decreasing CPU time.
+*@return the report, as a newly allocated text, with one tab-separated line per entry.
+*/
+gchar *gldi_profiling_get_report (void);
+
+/** Write the report given by \ref gldi_profiling_get_report into a file.
+*@param cFilePath path of the file, or NULL to use the default one (profiling.txt in the cache directory of the dock).
+*@return TRUE if the file has been written.
+*/
+gboolean gldi_profiling_dump_report (const gchar *cFilePath);
+
+/** Reset all the numbers, for the notifications and for the Tasks, so that the next report only covers what happens from now on.
+*/
+void gldi_profiling_reset (void);
+
+G_END_DECLS
+#endif
@@ -434,6 +434,8 @@ typedef struct _GldiAppInfo GldiAppInfo;
 typedef struct _GldiContainer GldiContainer;
 typedef struct _GldiContainerInterface GldiContainerInterface;
 typedef struct _CairoDock CairoDock;
+
+typedef struct _CairoDockIconsGeometry CairoDockIconsGeometry;
 typedef struct _CairoDesklet CairoDesklet;
 typedef struct _CairoDialog CairoDialog;
 typedef struct _CairoFlyingContainer CairoFlyingContainer;
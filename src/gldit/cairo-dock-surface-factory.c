@@ -23,6 +23,9 @@
 #include <pango/pango.h>
 #include <fcntl.h>
 #include <stdio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-draw.h"
@@ -33,6 +36,7 @@
 #include "cairo-dock-icon-manager.h"  // cairo_dock_search_icon_s_path
 #include "cairo-dock-dialog-manager.h"
 #include "cairo-dock-style-manager.h"
+#include "cairo-dock-image-cache.h"
 #include "cairo-dock-surface-factory.h"
 
 extern GldiContainer *g_pPrimaryContainer;
@@ -178,6 +182,8 @@ static void _cairo_dock_calculate_constrainted_size (double *fImageWidth, double
 }
 
 
+static GPrivate s_pThreadSourceContext;  // source context of a thread that is not allowed to use GDK (see cairo_dock_create_surface_from_image_in_thread)
+
 static inline cairo_t *_get_source_context (void)
 {
 	cairo_t *pSourceContext = NULL;
@@ -193,6 +199,8 @@ static inline cairo_t *_get_source_context (void)
 cairo_surface_t *cairo_dock_create_blank_surface_full (int iWidth, int iHeight, cairo_t *pSourceContext)
 {
 	cairo_t *tmpContext = NULL;
+	if (!pSourceContext)
+		pSourceContext = g_private_get (&s_pThreadSourceContext);
 	if (!pSourceContext && !g_bUseOpenGL)
 		pSourceContext = tmpContext = _get_source_context ();
 	cairo_surface_t *pSurface;
@@ -278,21 +286,92 @@ static inline void _apply_orientation_and_scale (cairo_t *pCairoContext, CairoDo
 }
 
 
+// premultiply the n ARGB pixels of an X icon by their alpha (needed by libcairo), and pack them into pDest (which can be the same memory as pSrc, since a gulong is at least as large as a pixel).
+// the channels are computed as c*a/255 with integers, rounded to the nearest, by (x + (x >> 8)) >> 8 where x = c*a + 128.
+#ifdef __SSE2__
+static inline __m128i _premultiply_4_pixels (__m128i p)
+{
+	const __m128i zero = _mm_setzero_si128 ();
+	const __m128i bias = _mm_set1_epi16 (128);
+	const __m128i alpha_mask = _mm_set1_epi32 (0xFF000000);
+	__m128i lo = _mm_unpacklo_epi8 (p, zero);  // 2 pixels, 1 channel per 16 bits: b g r a b g r a
+	__m128i hi = _mm_unpackhi_epi8 (p, zero);
+	__m128i alo = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (lo, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));  // alpha of each pixel on its 4 channels
+	__m128i ahi = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (hi, _MM_SHUFFLE (3, 3, 3, 3)), _MM_SHUFFLE (3, 3, 3, 3));
+	lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, alo), bias);  // at most 255*255+128, fits in 16 bits
+	hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, ahi), bias);
+	lo = _mm_srli_epi16 (_mm_add_epi16 (lo, _mm_srli_epi16 (lo, 8)), 8);
+	hi = _mm_srli_epi16 (_mm_add_epi16 (hi, _mm_srli_epi16 (hi, 8)), 8);
+	__m128i r = _mm_packus_epi16 (lo, hi);
+	return _mm_or_si128 (_mm_andnot_si128 (alpha_mask, r), _mm_and_si128 (p, alpha_mask));  // keep the original alpha
+}
+#endif
+static void _premultiply_xicon_pixels (const gulong *pSrc, guint32 *pDest, int n)
+{
+	int i = 0;
+	#ifdef __SSE2__
+	__m128i p;
+	for (; i + 4 <= n; i += 4)
+	{
+		#if GLIB_SIZEOF_LONG == 8
+		__m128i p01 = _mm_loadu_si128 ((const __m128i*)&pSrc[i]);  // 2 pixels, on 64 bits each
+		__m128i p23 = _mm_loadu_si128 ((const __m128i*)&pSrc[i+2]);
+		p = _mm_unpacklo_epi64 (_mm_shuffle_epi32 (p01, _MM_SHUFFLE (3, 3, 2, 0)),
+			_mm_shuffle_epi32 (p23, _MM_SHUFFLE (3, 3, 2, 0)));  // keep the lower 32 bits of each
+		#else
+		p = _mm_loadu_si128 ((const __m128i*)&pSrc[i]);
+		#endif
+		_mm_storeu_si128 ((__m128i*)&pDest[i], _premultiply_4_pixels (p));  // the 4 pixels have been read already, and the next ones are further in the buffer
+	}
+	#endif
+	guint32 pixel, alpha, red, green, blue;
+	for (; i < n; i ++)
+	{
+		pixel = (guint32) pSrc[i];
+		alpha = pixel >> 24;
+		red   = ((pixel >> 16) & 0xFF) * alpha + 128;
+		green = ((pixel >> 8) & 0xFF) * alpha + 128;
+		blue  = (pixel & 0xFF) * alpha + 128;
+		red   = (red + (red >> 8)) >> 8;
+		green = (green + (green >> 8)) >> 8;
+		blue  = (blue + (blue >> 8)) >> 8;
+		pDest[i] = (pixel & 0xFF000000) | (red << 16) | (green << 8) | blue;
+	}
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuffer, int iBufferNbElements, int iWidth, int iHeight)
 {
-	//\____________________ On recupere la plus grosse des icones presentes dans le tampon (meilleur rendu).
+	//\____________________ On cree la surface de destination, pour connaitre sa taille reelle en pixels.
+	cairo_surface_t *pNewSurface = cairo_dock_create_blank_surface (
+		iWidth,
+		iHeight);
+	double fScaleX = 1., fScaleY = 1.;
+	cairo_surface_get_device_scale (pNewSurface, &fScaleX, &fScaleY);
+	gulong iNeededSize = MAX (ceil (iWidth * fScaleX), ceil (iHeight * fScaleY));
+	
+	//\____________________ On recupere la plus petite des icones presentes dans le tampon qui soit au moins aussi grande que la surface (meilleur rendu, sans convertir des pixels pour rien), ou a defaut la plus grosse.
 	int iIndex = 0, iBestIndex = 0;
+	gulong iSize, iBestSize = 0;
 	while (iIndex + 2 < iBufferNbElements)
 	{
 		if (pXIconBuffer[iIndex] == 0 || pXIconBuffer[iIndex+1] == 0)  // precaution au cas ou un buffer foirreux nous serait retourne, on risque de boucler sans fin.
 		{
 			cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
 			if (iIndex == 0)  // tout le buffer est a jeter.
+			{
+				cairo_surface_destroy (pNewSurface);
 				return NULL;
+			}
 			break;
 		}
-		if (pXIconBuffer[iIndex] > pXIconBuffer[iBestIndex])
+		iSize = MAX (pXIconBuffer[iIndex], pXIconBuffer[iIndex+1]);
+		if (iBestSize == 0
+		|| (iBestSize < iNeededSize && iSize > iBestSize)  // the current best is too small, take any bigger one
+		|| (iSize >= iNeededSize && iSize < iBestSize))  // big enough, and closer to the needed size
+		{
 			iBestIndex = iIndex;
+			iBestSize = iSize;
+		}
 		iIndex += 2 + pXIconBuffer[iIndex] * pXIconBuffer[iIndex+1];
 	}
 
@@ -302,28 +381,15 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 	iBestIndex += 2;
 	//g_print ("%s (%dx%d)\n", __func__, w, h);
 	
-	int i, n = w * h;
+	int n = w * h;
 	if (iBestIndex + n > iBufferNbElements)  // precaution au cas ou le nombre d'elements dans le buffer serait incorrect.
 	{
 		cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
+		cairo_surface_destroy (pNewSurface);
 		return NULL;
 	}
-	gint pixel, alpha, red, green, blue;
-	float fAlphaFactor;
-	gint *pPixelBuffer = (gint *) &pXIconBuffer[iBestIndex];  // on va ecrire le resultat du filtre directement dans le tableau fourni en entree. C'est ok car sizeof(gulong) >= sizeof(gint), donc le tableau de pixels est plus petit que le buffer fourni en entree. merci a Hannemann pour ses tests et ses screenshots ! :-)
-	for (i = 0; i < n; i ++)
-	{
-		pixel = (gint) pXIconBuffer[iBestIndex+i];
-		alpha = (pixel & 0xFF000000) >> 24;
-		red   = (pixel & 0x00FF0000) >> 16;
-		green = (pixel & 0x0000FF00) >> 8;
-		blue  = (pixel & 0x000000FF);
-		fAlphaFactor = (float) alpha / 255;
-		red *= fAlphaFactor;
-		green *= fAlphaFactor;
-		blue *= fAlphaFactor;
-		pPixelBuffer[i] = (pixel & 0xFF000000) + (red << 16) + (green << 8) + blue;
-	}
+	guint32 *pPixelBuffer = (guint32 *) &pXIconBuffer[iBestIndex];  // on va ecrire le resultat du filtre directement dans le tableau fourni en entree. C'est ok car sizeof(gulong) >= sizeof(gint), donc le tableau de pixels est plus petit que le buffer fourni en entree. merci a Hannemann pour ses tests et ses screenshots ! :-)
+	_premultiply_xicon_pixels (&pXIconBuffer[iBestIndex], pPixelBuffer, n);
 
 	//\____________________ On cree la surface a partir du tampon.
 	int iStride = w * sizeof (gint);  // nbre d'octets entre le debut de 2 lignes.
@@ -343,9 +409,6 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 		&fIconWidthSaturationFactor,
 		&fIconHeightSaturationFactor);
 	
-	cairo_surface_t *pNewSurface = cairo_dock_create_blank_surface (
-		iWidth,
-		iHeight);
 	cairo_t *pCairoContext = cairo_create (pNewSurface);
 	
 	double fUsefulWidth = w * fIconWidthSaturationFactor;  // a part dans le cas fill && keep ratio, c'est la meme chose que fImageWidth et fImageHeight.
@@ -511,7 +574,7 @@ static cairo_status_t _cairo_read_func (void *ptr, unsigned char *data, unsigned
 	return CAIRO_STATUS_READ_ERROR;
 }
 
-cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+static cairo_surface_t *_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
 {
 	//g_print ("%s (%s, %dx%dx%.2f, %d)\n", __func__, cImagePath, iWidthConstraint, iHeightConstraint, fMaxScale, iLoadingModifier);
 	g_return_val_if_fail (cImagePath != NULL, NULL);
@@ -691,6 +754,100 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 	return pNewSurface;
 }
 
+// tell if the surfaces made by cairo_dock_create_blank_surface in the current thread are image surfaces, and with which scale.
+static gboolean _blank_surfaces_are_image_surfaces (double *fScale)
+{
+	double ys;
+	*fScale = 1.;
+	cairo_t *pSourceContext = g_private_get (&s_pThreadSourceContext);
+	if (pSourceContext != NULL)
+	{
+		cairo_surface_t *pTarget = cairo_get_target (pSourceContext);
+		cairo_surface_get_device_scale (pTarget, fScale, &ys);
+		return (g_bUseOpenGL || cairo_surface_get_type (pTarget) == CAIRO_SURFACE_TYPE_IMAGE);
+	}
+	if (g_bUseOpenGL)
+	{
+		if (g_pPrimaryContainer != NULL)
+		{
+			GdkWindow* gdkwindow = gldi_container_get_gdk_window (g_pPrimaryContainer);
+			*fScale = gdk_window_get_scale_factor (gdkwindow);
+		}
+		return TRUE;
+	}
+	if (g_pPrimaryContainer != NULL)
+	{
+		GdkWindow* gdkwindow = gldi_container_get_gdk_window (g_pPrimaryContainer);
+		*fScale = gdk_window_get_scale_factor (gdkwindow);
+	}
+	return FALSE;  // similar to the window of the main container (typically a X surface), we can't map it from a file.
+}
+
+// copy an image surface into a blank surface, for the threads whose surfaces are similar to the window.
+static cairo_surface_t *_copy_to_blank_surface (cairo_surface_t *pImageSurface)
+{
+	double fScale, ys;
+	cairo_surface_get_device_scale (pImageSurface, &fScale, &ys);
+	cairo_surface_t *pSurface = cairo_dock_create_blank_surface (
+		ceil (cairo_image_surface_get_width (pImageSurface) / fScale),
+		ceil (cairo_image_surface_get_height (pImageSurface) / ys));
+	cairo_t *pCairoContext = cairo_create (pSurface);
+	cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface (pCairoContext, pImageSurface, 0, 0);
+	cairo_paint (pCairoContext);
+	cairo_destroy (pCairoContext);
+	cairo_surface_destroy (pImageSurface);
+	return pSurface;
+}
+
+cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
+{
+	g_return_val_if_fail (cImagePath != NULL, NULL);
+	double fScale;
+	gboolean bImageSurfaces = _blank_surfaces_are_image_surfaces (&fScale);  // the cache only holds image surfaces; else they are copied from/to the cache, which is still much cheaper than decoding the image.
+	
+	//\_______________ look for the image in the cache, and load and store it if it's not there.
+	CairoDockImageCacheKey key;
+	memset (&key, 0, sizeof (CairoDockImageCacheKey));
+	key.cImagePath = cImagePath;
+	key.fMaxScale = fMaxScale;
+	key.iWidthConstraint = iWidthConstraint;
+	key.iHeightConstraint = iHeightConstraint;
+	key.iLoadingModifier = iLoadingModifier;
+	key.fScale = fScale;
+	double fZoomX_ = 1., fZoomY_ = 1.;
+	cairo_surface_t *pSurface = cairo_dock_image_cache_lookup (&key, fImageWidth, fImageHeight, &fZoomX_, &fZoomY_);
+	if (pSurface != NULL)
+	{
+		if (! bImageSurfaces)
+			pSurface = _copy_to_blank_surface (pSurface);
+	}
+	else
+	{
+		pSurface = _create_surface_from_image (cImagePath, fMaxScale, iWidthConstraint, iHeightConstraint, iLoadingModifier, fImageWidth, fImageHeight, &fZoomX_, &fZoomY_);
+		if (pSurface != NULL && key.bCacheable)
+		{
+			if (bImageSurfaces)
+				cairo_dock_image_cache_store (&key, pSurface, *fImageWidth, *fImageHeight, fZoomX_, fZoomY_);
+			else
+			{
+				cairo_surface_t *pImage = cairo_surface_map_to_image (pSurface, NULL);
+				double xs, ys;
+				cairo_surface_get_device_scale (pSurface, &xs, &ys);
+				cairo_surface_set_device_scale (pImage, xs, ys);
+				cairo_dock_image_cache_store (&key, pImage, *fImageWidth, *fImageHeight, fZoomX_, fZoomY_);
+				cairo_surface_unmap_image (pSurface, pImage);
+			}
+		}
+	}
+	
+	if (fZoomX != NULL)
+		*fZoomX = fZoomX_;
+	if (fZoomY != NULL)
+		*fZoomY = fZoomY_;
+	return pSurface;
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_image_simple (const gchar *cImageFile, double fImageWidth, double fImageHeight)
 {
 	g_return_val_if_fail (cImageFile != NULL, NULL);
@@ -715,6 +872,33 @@ cairo_surface_t *cairo_dock_create_surface_from_image_simple (const gchar *cImag
 	return pSurface;
 }
 
+cairo_surface_t *cairo_dock_create_surface_from_image_in_thread (const gchar *cImagePath, double fImageWidth, double fImageHeight, double fScale)
+{
+	g_return_val_if_fail (cImagePath != NULL, NULL);
+	double fImageWidth_ = fImageWidth, fImageHeight_ = fImageHeight;
+	
+	// the new surfaces will be similar to this one, instead of the GDK window of the main container.
+	cairo_surface_t *pTarget = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo_surface_set_device_scale (pTarget, fScale, fScale);
+	cairo_t *pSourceContext = cairo_create (pTarget);
+	g_private_set (&s_pThreadSourceContext, pSourceContext);
+	
+	cairo_surface_t *pSurface = cairo_dock_create_surface_from_image (cImagePath,
+		1.,
+		fImageWidth,
+		fImageHeight,
+		CAIRO_DOCK_FILL_SPACE,
+		&fImageWidth_,
+		&fImageHeight_,
+		NULL,
+		NULL);
+	
+	g_private_set (&s_pThreadSourceContext, NULL);
+	cairo_destroy (pSourceContext);
+	cairo_surface_destroy (pTarget);
+	return pSurface;
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_icon (const gchar *cImageFile, double fImageWidth, double fImageHeight)
 {
 	g_return_val_if_fail (cImageFile != NULL, NULL);
@@ -963,6 +1147,120 @@ cairo_surface_t *cairo_dock_create_surface_from_text_full (const gchar *cText, G
 }
 
 
+// cache of the last text surfaces, for the labels and the quick-infos that are set again and again with the same few values (window titles, percentages).
+#define CD_TEXT_CACHE_MAX_ENTRIES 256
+#define CD_TEXT_CACHE_MAX_MEMORY (4 * 1024 * 1024)  // bytes
+
+typedef struct {
+	gchar *cKey;
+	cairo_surface_t *pSurface;
+	int iWidth, iHeight;
+	gsize iMemory;
+	GList *pLink;  // in s_textCacheLru
+	} CDTextCacheEntry;
+
+static GHashTable *s_pTextCache = NULL;  // key -> CDTextCacheEntry
+static GQueue s_textCacheLru = G_QUEUE_INIT;  // most recently used first
+static gsize s_iTextCacheMemory = 0;
+static guint s_iTextCacheHits = 0, s_iTextCacheMisses = 0;
+
+static void _free_text_cache_entry (CDTextCacheEntry *pEntry)
+{
+	s_iTextCacheMemory -= pEntry->iMemory;
+	g_queue_delete_link (&s_textCacheLru, pEntry->pLink);
+	cairo_surface_destroy (pEntry->pSurface);
+	g_free (pEntry->cKey);
+	g_free (pEntry);
+}
+
+static gboolean _on_style_changed_clear_text_cache (G_GNUC_UNUSED gpointer data)
+{
+	g_hash_table_remove_all (s_pTextCache);  // the default colors and font, and the corner radius, are used to draw the texts
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gchar *_make_text_cache_key (const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth)
+{
+	const GldiColor *c1 = &pTextDescription->fColorStart, *c2 = &pTextDescription->fBackgroundColor, *c3 = &pTextDescription->fLineColor;
+	return g_strdup_printf ("%s|%d|%d%d%d%d|%d|%.3f|%d|%g|%d|%g,%g,%g,%g|%g,%g,%g,%g|%g,%g,%g,%g|%s",
+		pTextDescription->cFont ? pTextDescription->cFont : "",
+		pTextDescription->iSize,
+		pTextDescription->bNoDecorations, pTextDescription->bUseDefaultColors, pTextDescription->bOutlined, pTextDescription->bUseMarkup,
+		pTextDescription->iMargin,
+		pTextDescription->fMaxRelativeWidth,
+		pTextDescription->fMaxRelativeWidth != 0 ? gldi_desktop_get_width() / g_desktopGeometry.iNbScreens : 0,
+		fMaxScale,
+		iMaxWidth,
+		c1->rgba.red, c1->rgba.green, c1->rgba.blue, c1->rgba.alpha,
+		c2->rgba.red, c2->rgba.green, c2->rgba.blue, c2->rgba.alpha,
+		c3->rgba.red, c3->rgba.green, c3->rgba.blue, c3->rgba.alpha,
+		cText);
+}
+
+cairo_surface_t *cairo_dock_get_text_surface (const gchar *cText, GldiTextDescription *pTextDescription, double fMaxScale, int iMaxWidth, int *iTextWidth, int *iTextHeight)
+{
+	g_return_val_if_fail (cText != NULL && pTextDescription != NULL, NULL);
+	if (s_pTextCache == NULL)
+	{
+		s_pTextCache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)_free_text_cache_entry);  // the entry owns the key
+		gldi_object_register_notification (&myStyleMgr,
+			NOTIFICATION_STYLE_CHANGED,
+			(GldiNotificationFunc) _on_style_changed_clear_text_cache,
+			GLDI_RUN_FIRST, NULL);
+	}
+	
+	gchar *cKey = _make_text_cache_key (cText, pTextDescription, fMaxScale, iMaxWidth);
+	CDTextCacheEntry *pEntry = g_hash_table_lookup (s_pTextCache, cKey);
+	if (pEntry != NULL)
+	{
+		s_iTextCacheHits ++;
+		g_free (cKey);
+		g_queue_unlink (&s_textCacheLru, pEntry->pLink);  // move it to the front
+		g_queue_push_head_link (&s_textCacheLru, pEntry->pLink);
+		*iTextWidth = pEntry->iWidth;
+		*iTextHeight = pEntry->iHeight;
+		return cairo_surface_reference (pEntry->pSurface);
+	}
+	s_iTextCacheMisses ++;
+	
+	cairo_surface_t *pSurface = cairo_dock_create_surface_from_text_full (cText, pTextDescription, fMaxScale, iMaxWidth, iTextWidth, iTextHeight);
+	if (pSurface == NULL)
+	{
+		g_free (cKey);
+		return NULL;
+	}
+	
+	pEntry = g_new0 (CDTextCacheEntry, 1);
+	pEntry->cKey = cKey;
+	pEntry->pSurface = cairo_surface_reference (pSurface);
+	pEntry->iWidth = *iTextWidth;
+	pEntry->iHeight = *iTextHeight;
+	double fScaleX = 1., fScaleY = 1.;
+	cairo_surface_get_device_scale (pSurface, &fScaleX, &fScaleY);
+	pEntry->iMemory = 4 * (gsize)(*iTextWidth * fScaleX) * (gsize)(*iTextHeight * fScaleY);
+	g_queue_push_head (&s_textCacheLru, pEntry);
+	pEntry->pLink = s_textCacheLru.head;
+	s_iTextCacheMemory += pEntry->iMemory;
+	g_hash_table_insert (s_pTextCache, cKey, pEntry);
+	
+	// evict the least recently used surfaces (they may still be used elsewhere, they are only released by the cache)
+	CDTextCacheEntry *pOldest;
+	while (s_textCacheLru.length > 1 && (s_textCacheLru.length > CD_TEXT_CACHE_MAX_ENTRIES || s_iTextCacheMemory > CD_TEXT_CACHE_MAX_MEMORY))
+	{
+		pOldest = s_textCacheLru.tail->data;
+		g_hash_table_remove (s_pTextCache, pOldest->cKey);
+	}
+	return pSurface;
+}
+
+void cairo_dock_get_text_surface_cache_stats (guint *iNbHits, guint *iNbMisses, gsize *iMemory)
+{
+	*iNbHits = s_iTextCacheHits;
+	*iNbMisses = s_iTextCacheMisses;
+	*iMemory = s_iTextCacheMemory;
+}
+
+
 cairo_surface_t * cairo_dock_duplicate_surface (cairo_surface_t *pSurface, double fWidth, double fHeight, double fDesiredWidth, double fDesiredHeight)
 {
 	g_return_val_if_fail (pSurface != NULL, NULL);
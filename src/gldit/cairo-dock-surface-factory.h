@@ -70,7 +70,7 @@ typedef enum {
 #define CAIRO_DOCK_ORIENTATION_MASK (7<<3)
 
 
-/** Create a surface from raw data of an X icon. The biggest icon possible is taken. The ratio is kept, and the surface will fill the space with transparency if necessary.
+/** Create a surface from raw data of an X icon. The smallest icon that is at least as big as the surface is taken (or the biggest one if none is). The buffer is modified. The ratio is kept, and the surface will fill the space with transparency if necessary.
 *@param pXIconBuffer raw data of the icon.
 *@param iBufferNbElements number of elements in the buffer.
 *@param iWidth will be filled with the resulting width of the surface.
@@ -143,6 +143,15 @@ cairo_surface_t *cairo_dock_create_surface_from_image (const gchar *cImagePath,
 */
 cairo_surface_t *cairo_dock_create_surface_from_image_simple (const gchar *cImageFile, double fImageWidth, double fImageHeight);
 
+/** Same as \ref cairo_dock_create_surface_from_image_simple, but can be called from any thread, since it doesn't use GDK: the surface is a mere image surface with the given scale factor.
+*@param cImagePath complete path to the image.
+*@param fImageWidth the desired surface width.
+*@param fImageHeight the desired surface height.
+*@param fScale scale factor of the screen the surface will be displayed on.
+*@return the newly allocated surface.
+*/
+cairo_surface_t *cairo_dock_create_surface_from_image_in_thread (const gchar *cImagePath, double fImageWidth, double fImageHeight, double fScale);
+
 /** Create a surface from any image, at a given size. If the image is given by its sole name, it is searched inside the icons themes known by Cairo-Dock. 
 *@param cImagePath path or name of an image.
 *@param fImageWidth the desired surface width.
@@ -188,6 +197,24 @@ cairo_surface_t * cairo_dock_rotate_surface (cairo_surface_t *pSurface, double f
 */
 cairo_surface_t *cairo_dock_create_surface_from_text_full (const gchar *cText, GldiTextDescription *pLabelDescription, double fMaxScale, int iMaxWidth, int *iTextWidth, int *iTextHeight);
 
+/** Like cairo_dock_create_surface_from_text_full, but the surface comes from a cache of the last texts that have been drawn, so it may be shared and must not be drawn on. Release it with cairo_surface_destroy as usual.
+*@param cText the text.
+*@param pLabelDescription description of the text rendering.
+*@param fMaxScale maximum zoom of the text.
+*@param iMaxWidth maximum authorized width for the surface; it will be zoomed in to fits this limit. 0 for no limit.
+*@param iTextWidth will be filled the width of the resulting surface.
+*@param iTextHeight will be filled the height of the resulting surface.
+*@return a reference on the surface.
+*/
+cairo_surface_t *cairo_dock_get_text_surface (const gchar *cText, GldiTextDescription *pLabelDescription, double fMaxScale, int iMaxWidth, int *iTextWidth, int *iTextHeight);
+
+/** Get the statistics of the cache used by cairo_dock_get_text_surface.
+*@param iNbHits will be filled with the number of texts that were found in the cache
+*@param iNbMisses will be filled with the number of texts that had to be drawn
+*@param iMemory will be filled with the memory used by the surfaces of the cache, in bytes
+*/
+void cairo_dock_get_text_surface_cache_stats (guint *iNbHits, guint *iNbMisses, gsize *iMemory);
+
 /** Create a surface representing a text, according to a given text description.
 *@param cText the text.
 *@param pLabelDescription description of the text rendering.
@@ -20,81 +20,263 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include "cairo-dock-profiling.h"  // gldi_profiling_get_thread_cpu_time
 #include "cairo-dock-log.h"
 #include "cairo-dock-task.h"
 
 #define _schedule_next_iteration(pTask) do {\
-	if (pTask->iSidTimer == 0 && pTask->iPeriod)\
-		pTask->iSidTimer = g_timeout_add_seconds (pTask->iPeriod, (GSourceFunc) _launch_task_timer, pTask); } while (0)
+	if (pTask->iSidTimer == 0 && pTask->iNextTick == 0 && pTask->iPeriod)\
+		_wheel_insert (pTask, pTask->iPeriod, pTask->iPeriod); } while (0)
 
 #define _cancel_next_iteration(pTask) do {\
 	if (pTask->iSidTimer != 0) {\
 		g_source_remove (pTask->iSidTimer);\
-		pTask->iSidTimer = 0; } } while (0)
+		pTask->iSidTimer = 0; }\
+	_wheel_remove (pTask); } while (0)
 
 #define _set_elapsed_time(pTask) do {\
 	pTask->fElapsedTime = g_timer_elapsed (pTask->pClock, NULL);\
 	g_timer_start (pTask->pClock); } while (0)
 
+  ///////////////////
+ /// TIMER WHEEL ///
+///////////////////
+
+// The periodic tasks don't have their own timer: they are placed in a wheel of 1s slots, and a single timer is armed for the earliest task.
+// The ticks are the whole seconds of the monotonic clock, and the timer is armed for the exact time of the tick (g_timeout_add_seconds() fires on a grid of its own, which is not aligned with them).
+// The iterations of a task are aligned on the multiples of its period, so that tasks with compatible periods (1, 2, 5, 10, 60s...) wake up the process together.
+// When a task is put on the grid, it takes the first multiple that is far enough: a full period after its launch (which runs its first iteration), half a period otherwise.
+#define GLDI_TASK_WHEEL_SIZE 64  // nb of slots; a task scheduled further than that just stays in its slot for more turns.
+#define GLDI_TASK_NB_WAKEUPS 64  // nb of wakeups we remember, enough since there is at most 1 per second.
+
+static GSList *s_pWheel[GLDI_TASK_WHEEL_SIZE];
+static gint64 s_iWheelTick = 0;  // last tick that has been processed; all the scheduled ticks are after it.
+static guint s_iNbScheduledTasks = 0;
+static guint s_iSidWheel = 0;
+static gint64 s_iWheelTimerTick = 0;  // tick for which the timer is armed.
+static gint64 s_pWakeupTicks[GLDI_TASK_NB_WAKEUPS];
+static guint s_iNbWakeups = 0;
+
+static inline gint64 _get_current_tick (void)
+{
+	return g_get_monotonic_time () / G_USEC_PER_SEC;
+}
+
+static gboolean _has_task_at_tick (gint64 iTick)
+{
+	GSList *t;
+	for (t = s_pWheel[iTick % GLDI_TASK_WHEEL_SIZE]; t != NULL; t = t->next)
+	{
+		if (((GldiTask*)t->data)->iNextTick == iTick)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static gint64 _get_next_scheduled_tick (void)
+{
+	gint64 iNextTick = G_MAXINT64;
+	GSList *t;
+	int i;
+	for (i = 0; i < GLDI_TASK_WHEEL_SIZE; i ++)
+	{
+		for (t = s_pWheel[i]; t != NULL; t = t->next)
+			iNextTick = MIN (iNextTick, ((GldiTask*)t->data)->iNextTick);
+	}
+	return iNextTick;
+}
+
+static gboolean _on_wheel_tick (gpointer data);
+static void _arm_wheel (void)
+{
+	if (s_iNbScheduledTasks == 0)  // nothing to wait for, don't wake up at all.
+	{
+		if (s_iSidWheel != 0)
+		{
+			g_source_remove (s_iSidWheel);
+			s_iSidWheel = 0;
+		}
+		return;
+	}
+	
+	gint64 iNextTick = _get_next_scheduled_tick ();  // possibly more than a turn ahead; we don't wake up for the empty turns.
+	if (s_iSidWheel != 0)
+	{
+		if (s_iWheelTimerTick == iNextTick)  // already armed for this tick
+			return;
+		g_source_remove (s_iSidWheel);
+	}
+	gint64 iDelay = iNextTick * G_USEC_PER_SEC - g_get_monotonic_time ();  // in us
+	s_iSidWheel = g_timeout_add (iDelay > 0 ? (iDelay + 999) / 1000 : 0, (GSourceFunc) _on_wheel_tick, NULL);  // rounded up, so that we never wake up before the tick.
+	s_iWheelTimerTick = iNextTick;
+}
+
+static gint64 _get_aligned_tick (GldiTask *pTask, guint iPeriod, gint64 iNow, guint iMinDelay)
+{
+	gint64 iEarliest = iNow + MAX (iMinDelay, 1);
+	gint64 iTick = (iEarliest + iPeriod - 1) / iPeriod * iPeriod;  // first multiple of the period that is not too close
+	if (pTask->iFrequencyState != GLDI_TASK_FREQUENCY_NORMAL)  // a downgraded task is not accurate anyway, let it join a tick that already wakes us up.
+	{
+		gint64 iSlack = iPeriod / 4, t;
+		for (t = MAX (iEarliest, iTick - iSlack); t <= iTick + iSlack; t ++)
+		{
+			if (_has_task_at_tick (t))
+			{
+				iTick = t;
+				break;
+			}
+		}
+	}
+	return iTick;
+}
+
+static void _insert_at_tick (GldiTask *pTask, gint64 iTick)
+{
+	pTask->iNextTick = iTick;
+	s_pWheel[iTick % GLDI_TASK_WHEEL_SIZE] = g_slist_prepend (s_pWheel[iTick % GLDI_TASK_WHEEL_SIZE], pTask);
+	s_iNbScheduledTasks ++;
+}
+
+static void _wheel_insert (GldiTask *pTask, guint iPeriod, guint iMinDelay)
+{
+	gint64 iNow = _get_current_tick ();
+	if (s_iNbScheduledTasks == 0)  // the wheel was stopped, make it start from now.
+		s_iWheelTick = iNow;
+	pTask->iTimerPeriod = iPeriod;
+	_insert_at_tick (pTask, _get_aligned_tick (pTask, iPeriod, iNow, iMinDelay));
+	_arm_wheel ();
+}
+
+static void _wheel_remove (GldiTask *pTask)
+{
+	if (pTask->iNextTick == 0)
+		return;
+	int i = pTask->iNextTick % GLDI_TASK_WHEEL_SIZE;
+	s_pWheel[i] = g_slist_remove (s_pWheel[i], pTask);
+	pTask->iNextTick = 0;
+	s_iNbScheduledTasks --;
+	if (s_iNbScheduledTasks == 0)
+		_arm_wheel ();  // just stop it; otherwise it will be re-armed when it fires.
+}
+
+static gboolean _on_wheel_tick (G_GNUC_UNUSED gpointer data)
+{
+	s_iSidWheel = 0;
+	gint64 iNow = _get_current_tick ();
+	s_pWakeupTicks[s_iNbWakeups % GLDI_TASK_NB_WAKEUPS] = iNow;
+	s_iNbWakeups ++;
+	
+	// launch the due tasks; a launch can stop or free any other task, so we take them one by one from the wheel, rather than from a list made beforehand.
+	gint64 iLastTick = MIN (iNow, s_iWheelTick + GLDI_TASK_WHEEL_SIZE);  // if we're late by more than a turn, one turn covers all the slots.
+	gint64 t;
+	GSList *s;
+	GldiTask *pTask;
+	for (t = s_iWheelTick + 1; t <= iLastTick; t ++)
+	{
+		do
+		{
+			pTask = NULL;
+			for (s = s_pWheel[t % GLDI_TASK_WHEEL_SIZE]; s != NULL; s = s->next)
+			{
+				if (((GldiTask*)s->data)->iNextTick <= iNow)
+				{
+					pTask = s->data;
+					break;
+				}
+			}
+			if (pTask != NULL)
+			{
+				// re-schedule it before launching it, as the launch may stop it.
+				gint64 iNextTick = pTask->iNextTick + pTask->iTimerPeriod;
+				_wheel_remove (pTask);
+				if (iNextTick <= iNow)  // we're late by more than a period (the machine was suspended, etc), go back on the grid.
+					iNextTick = _get_aligned_tick (pTask, pTask->iTimerPeriod, iNow, pTask->iTimerPeriod / 2);  // it is launched now
+				_insert_at_tick (pTask, iNextTick);
+				
+				gldi_task_launch (pTask);
+			}
+		} while (pTask != NULL);
+	}
+	s_iWheelTick = iNow;
+	
+	_arm_wheel ();
+	return FALSE;
+}
+
+guint gldi_task_get_nb_wakeups_per_minute (void)
+{
+	gint64 iNow = _get_current_tick ();
+	guint i, n = 0;
+	for (i = 0; i < MIN (s_iNbWakeups, GLDI_TASK_NB_WAKEUPS); i ++)
+	{
+		if (iNow - s_pWakeupTicks[i] < 60)
+			n ++;
+	}
+	return n;
+}
+
+  ////////////
+ /// TASK ///
+////////////
+
+// a job in the queue of the workers pool. It is separated from the task, so that a task can be freed while its job is still waiting in the queue.
+typedef struct {
+	GldiTask *pTask;  // NULL if the job has been cancelled before a worker could take it.
+	GldiTaskPriority iPriority;
+	guint iOrder;
+} GldiTaskJob;
+
+static GThreadPool *s_pTaskPool = NULL;  // shared by all the tasks, created on the first launch.
+static GMutex s_mJobsMutex;  // protects 'pJob->pTask' and 'pTask->pJob'.
+static guint s_iNbJobs = 0;  // to keep the jobs of the same priority in the order they were launched.
+
+static GList *s_pTasks = NULL;  // all the existing tasks, for the profiling.
+
 static void _free_task (GldiTask *pTask)
 {
+	s_pTasks = g_list_remove (s_pTasks, pTask);
 	if (pTask->free_data)
 		pTask->free_data (pTask->pSharedMemory);
 	g_timer_destroy (pTask->pClock);
 	g_mutex_clear (&pTask->mutex);
-	if (pTask->iPeriod) g_cond_clear (&pTask->cond);
-	if (pTask->pThread) g_thread_unref (pTask->pThread);
 	g_free (pTask);
 }
 
-static gboolean _launch_task_timer (GldiTask *pTask)
+static gboolean _call_update (GldiTask *pTask)
 {
-	gldi_task_launch (pTask);
-	return TRUE;
+	gint64 iTime = g_get_monotonic_time ();
+	gint64 iCpuTime = gldi_profiling_get_thread_cpu_time ();
+	gboolean bContinue = pTask->update (pTask->pSharedMemory);
+	pTask->iNbUpdates ++;
+	pTask->iUpdateTime += g_get_monotonic_time () - iTime;
+	pTask->iUpdateCpuTime += gldi_profiling_get_thread_cpu_time () - iCpuTime;
+	return bContinue;
 }
+
 static gboolean _check_for_update_idle (GldiTask *pTask)
 {
-	// process the data (we don't need to wait that the thread is over, so do it now, it will let more time for the thread to finish, and therefore often save a 'usleep').
+	// process the data (we don't need to wait that the worker is done, so do it now, it will let more time for the worker to finish, and therefore often save a 'usleep').
 	if (pTask->bNeedsUpdate)  // data are ready to be processed -> perform the update
 	{
 		if (! pTask->bDiscard)  // of course if the task has been discarded before, don't do anything.
 		{
-			pTask->bContinue = pTask->update (pTask->pSharedMemory);
+			pTask->bContinue = _call_update (pTask);
 		}
 		pTask->bNeedsUpdate = FALSE;  // now update is done, we won't do it any more until the next iteration, even is we loop on this function.
 	}
 	
-	// finish the iteration, and possibly schedule the next one (the thread must be finished for this part).
-	if (g_mutex_trylock (&pTask->mutex))  // if the thread is over
+	// finish the iteration, and possibly schedule the next one (the worker must be done with the task for this part).
+	if (g_mutex_trylock (&pTask->mutex))  // if the worker is done
 	{
+		pTask->iSidUpdateIdle = 0;  // set it before the unlock, as it is accessed in the worker
+		g_mutex_unlock (&pTask->mutex);
+		
 		if (pTask->bDiscard)  // if the task has been discarded, it's the end of the journey for it.
 		{
-			if (pTask->iPeriod)
-			{
-				pTask->bRunThread = TRUE;
-				g_cond_signal (&pTask->cond);
-				g_mutex_unlock (&pTask->mutex);
-				g_thread_join (pTask->pThread); // unref the thread
-				pTask->pThread = NULL;
-			}
-			else g_mutex_unlock (&pTask->mutex);
-
 			_free_task (pTask);
 			return FALSE;
 		}
 		
-		if (! pTask->iPeriod)  // one-shot thread => the thread is over
-		{
-			if (pTask->pThread)
-			{
-				g_thread_unref (pTask->pThread);
-				pTask->pThread = NULL;
-			}
-		}
-		
-		pTask->iSidUpdateIdle = 0;  // set it before the unlock, as it is accessed in the thread part
-		g_mutex_unlock (&pTask->mutex);
-		
 		// schedule the next iteration if necessary.
 		if (! pTask->bContinue)
 		{
@@ -109,38 +291,95 @@ static gboolean _check_for_update_idle (GldiTask *pTask)
 		return FALSE;  // the update is now finished, quit.
 	}
 	
-	// if the thread is not yet over, come back in 1ms.
-	g_usleep (1);  // we don't want to block the main loop until the thread is over; so just sleep 1ms to give it a chance to terminate. so it's a kind of 'sched_yield()' without blocking the main loop.
+	// if the worker is not yet done, come back in 1ms.
+	g_usleep (1);  // we don't want to block the main loop until the worker is done; so just sleep 1ms to give it a chance to terminate. so it's a kind of 'sched_yield()' without blocking the main loop.
 	return TRUE;
 }
-static gpointer _get_data_threaded (GldiTask *pTask)
+static void _get_data_threaded (GldiTaskJob *pJob, G_GNUC_UNUSED gpointer data)
 {
-	g_mutex_lock (&pTask->mutex);
-	_run_thread:  // at this point the mutex is locked, either by the first execution of this function, or by 'g_cond_wait'
-	
-	//\_______________________ get the data
-	_set_elapsed_time (pTask);
-	pTask->get_data (pTask->pSharedMemory);
+	// take the task out of its job; its mutex is locked before the job is released, so that a 'stop' either cancels the job or waits for us.
+	g_mutex_lock (&s_mJobsMutex);
+	GldiTask *pTask = pJob->pTask;
+	if (pTask != NULL)
+	{
+		g_mutex_lock (&pTask->mutex);
+		pTask->pJob = NULL;
+	}
+	g_mutex_unlock (&s_mJobsMutex);
+	g_free (pJob);
+	if (pTask == NULL)  // the job has been cancelled while it was waiting in the queue.
+		return;
 	
-	// and signal that data are ready to be processed.
-	pTask->bNeedsUpdate = TRUE;  // this is only accessed by the update fonction, which is triggered just after, so no need to protect this variable.
+	//\_______________________ get the data, unless the task has been stopped or discarded in the meantime
+	if (! g_atomic_int_get (&pTask->bDiscard))
+	{
+		_set_elapsed_time (pTask);
+		gint64 iTime = g_get_monotonic_time ();
+		gint64 iCpuTime = gldi_profiling_get_thread_cpu_time ();  // of the worker
+		pTask->get_data (pTask->pSharedMemory);
+		pTask->iNbGetData ++;
+		pTask->iGetDataTime += g_get_monotonic_time () - iTime;
+		pTask->iGetDataCpuTime += gldi_profiling_get_thread_cpu_time () - iCpuTime;
+		
+		// and signal that data are ready to be processed.
+		pTask->bNeedsUpdate = TRUE;  // this is only accessed by the update fonction, which is triggered just after, so no need to protect this variable.
+	}
 	
-	//\_______________________ call the update function from the main loop
+	//\_______________________ call the update function from the main loop (it also frees the task if it has been discarded)
 	if (pTask->iSidUpdateIdle == 0)
 		pTask->iSidUpdateIdle = g_idle_add ((GSourceFunc) _check_for_update_idle, pTask);  // note that 'iSidUpdateIdle' can actually be set after the 'update' is called. that's why the 'update' have to wait for the mutex to finish its job.
 	
-	// sleep until the next iteration or just leave.
-	if (pTask->iPeriod)  // periodic task -> block until the condition becomes TRUE again.
+	g_mutex_unlock (&pTask->mutex);
+}
+static gint _compare_jobs (GldiTaskJob *pJob1, GldiTaskJob *pJob2, G_GNUC_UNUSED gpointer data)
+{
+	if (pJob1->iPriority != pJob2->iPriority)
+		return (pJob1->iPriority > pJob2->iPriority ? -1 : 1);
+	return (gint) (pJob1->iOrder - pJob2->iOrder);
+}
+static void _push_job (GldiTask *pTask)
+{
+	GError *erreur = NULL;
+	if (s_pTaskPool == NULL)  // first launch -> create the pool; its threads are created on demand and exit after a while if unused.
+	{
+		s_pTaskPool = g_thread_pool_new ((GFunc) _get_data_threaded, NULL, MAX (2, g_get_num_processors ()), FALSE, &erreur);
+		if (erreur != NULL)  // can't happen with a non-exclusive pool, but just in case.
+		{
+			cd_warning (erreur->message);
+			g_error_free (erreur);
+			erreur = NULL;
+		}
+		g_thread_pool_set_sort_function (s_pTaskPool, (GCompareDataFunc) _compare_jobs, NULL);
+	}
+	
+	GldiTaskJob *pJob = g_new0 (GldiTaskJob, 1);
+	pJob->pTask = pTask;
+	pJob->iPriority = pTask->iPriority;
+	pJob->iOrder = s_iNbJobs ++;
+	g_mutex_lock (&s_mJobsMutex);
+	pTask->pJob = pJob;
+	g_mutex_unlock (&s_mJobsMutex);
+	
+	g_thread_pool_push (s_pTaskPool, pJob, &erreur);
+	if (erreur != NULL)  // no new worker could be created; the job stays in the queue and will be taken by the next available worker.
 	{
-		pTask->bRunThread = FALSE;
-		while (! pTask->bRunThread)
-			g_cond_wait (&pTask->cond, &pTask->mutex);  // releases the mutex, then takes it again when awakening.
-		if (g_atomic_int_get (&pTask->bDiscard) == 0)
-			goto _run_thread;
+		cd_warning (erreur->message);
+		g_error_free (erreur);
 	}
-	g_mutex_unlock (&pTask->mutex);
-	g_thread_exit (NULL);
-	return NULL;
+}
+// cancel the job of the task if it's still in the queue; returns TRUE if it was the case, i.e. the 'get_data' will not be called.
+static gboolean _cancel_job (GldiTask *pTask)
+{
+	gboolean bCancelled = FALSE;
+	g_mutex_lock (&s_mJobsMutex);
+	if (pTask->pJob != NULL)
+	{
+		((GldiTaskJob*)pTask->pJob)->pTask = NULL;  // the worker will just free the job
+		pTask->pJob = NULL;
+		bCancelled = TRUE;
+	}
+	g_mutex_unlock (&s_mJobsMutex);
+	return bCancelled;
 }
 void gldi_task_launch (GldiTask *pTask)
 {
@@ -148,7 +387,7 @@ void gldi_task_launch (GldiTask *pTask)
 	if (pTask->get_data == NULL)  // no asynchronous work -> just call the 'update' and directly schedule the next iteration
 	{
 		_set_elapsed_time (pTask);
-		pTask->bContinue = pTask->update (pTask->pSharedMemory);
+		pTask->bContinue = _call_update (pTask);
 		if (! pTask->bContinue)
 		{
 			_cancel_next_iteration (pTask);
@@ -159,32 +398,11 @@ void gldi_task_launch (GldiTask *pTask)
 			_schedule_next_iteration (pTask);
 		}
 	}
-	else  // launch the asynchronous work in a thread
+	else if (! pTask->bIsRunning)  // launch the asynchronous work in the workers pool
 	{
-		if (pTask->pThread == NULL)  // no thread yet -> create and launch it
-		{
-			pTask->bIsRunning = TRUE;
-			GError *erreur = NULL;
-			pTask->pThread = g_thread_try_new ("Cairo-Dock Task", (GThreadFunc) _get_data_threaded, pTask, &erreur);
-			if (erreur != NULL)  // on n'a pas pu lancer le thread.
-			{
-				cd_warning (erreur->message);
-				g_error_free (erreur);
-				pTask->bIsRunning = FALSE;
-			}
-		}
-		else  // thread already exists; it's either running or sleeping or finished with a pending update
-		if (pTask->iPeriod && g_mutex_trylock (&pTask->mutex))  // it's a periodic thread, and it's not currently running...
-		{
-			if (pTask->iSidUpdateIdle == 0)  // ...and it doesn't have a pending update -> awake it and run it again.
-			{
-				pTask->bRunThread = TRUE;
-				pTask->bIsRunning = TRUE;
-				g_cond_signal (&pTask->cond);
-			}
-			g_mutex_unlock (&pTask->mutex);
-		}  // else it's a one-shot thread or it's currently running or has a pending update -> don't launch it. so if the task is periodic, it will skip this iteration.
-	}
+		pTask->bIsRunning = TRUE;
+		_push_job (pTask);
+	}  // else the previous iteration is still waiting for a worker, running or has a pending update -> don't launch it. so if the task is periodic, it will skip this iteration.
 }
 
 
@@ -214,14 +432,24 @@ GldiTask *gldi_task_new_full (int iPeriod, GldiGetDataAsyncFunc get_data, GldiUp
 	pTask->pSharedMemory = pSharedMemory;
 	pTask->pClock = g_timer_new ();
 	g_mutex_init (&pTask->mutex);
-	if (iPeriod != 0)
-	{
-		g_cond_init (&pTask->cond);
-	}
+	s_pTasks = g_list_prepend (s_pTasks, pTask);
 	return pTask;
 }
 
 
+void gldi_tasks_foreach (GFunc pFunction, gpointer pUserData)
+{
+	g_list_foreach (s_pTasks, pFunction, pUserData);
+}
+
+
+void gldi_task_set_priority (GldiTask *pTask, GldiTaskPriority iPriority)
+{
+	g_return_if_fail (pTask != NULL);
+	pTask->iPriority = iPriority;
+}
+
+
 void gldi_task_stop (GldiTask *pTask)
 {
 	if (pTask == NULL)
@@ -231,42 +459,21 @@ void gldi_task_stop (GldiTask *pTask)
 	
 	if (gldi_task_is_running (pTask))
 	{
-		if (pTask->pThread)
+		if (! _cancel_job (pTask))  // a worker has taken the job, wait until it's done with it.
 		{
 			g_atomic_int_set (&pTask->bDiscard, 1);  // set the discard flag to help the 'get_data' callback knows that it should stop.
-			if (pTask->iPeriod)  // the thread might be sleeping, awake it.
-			{
-				if (g_mutex_trylock (&pTask->mutex))
-				{
-					pTask->bRunThread = TRUE;
-					g_cond_signal (&pTask->cond);
-					g_mutex_unlock (&pTask->mutex);
-				}
-			}
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
+			g_mutex_lock (&pTask->mutex);  // the worker keeps it until it's done.
+			g_mutex_unlock (&pTask->mutex);
 			g_atomic_int_set (&pTask->bDiscard, 0);
 		}
-		if (pTask->iSidUpdateIdle != 0)  // do it after the thread has possibly scheduled the 'update'
+		if (pTask->iSidUpdateIdle != 0)  // do it after the worker has possibly scheduled the 'update'
 		{
 			g_source_remove (pTask->iSidUpdateIdle);
 			pTask->iSidUpdateIdle = 0;
 		}
+		pTask->bNeedsUpdate = FALSE;
 		pTask->bIsRunning = FALSE;  // since we didn't go through the 'update'
 	}
-	else
-	{
-		if (pTask->pThread && pTask->iPeriod && g_mutex_trylock (&pTask->mutex))  // the thread is sleeping, awake it and let it exit.
-		{
-			g_atomic_int_set (&pTask->bDiscard, 1);
-			pTask->bRunThread = TRUE;
-			g_cond_signal (&pTask->cond);
-			g_mutex_unlock (&pTask->mutex);
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
-			g_atomic_int_set (&pTask->bDiscard, 0);
-		}
-	}
 }
 
 
@@ -280,19 +487,12 @@ void gldi_task_discard (GldiTask *pTask)
 	g_atomic_int_set (&pTask->bDiscard, 1);
 	
 	// if the task is running, there is nothing to do:
-	//   if we're inside the thread, it will trigger the 'update' anyway, which will destroy the task.
+	//   if the job is still in the queue, we can cancel it and free the task now.
+	//   if we're inside the worker, it will trigger the 'update' anyway, which will destroy the task.
 	//   if we're waiting for the 'update', same as above
 	//   if we're inside the 'update' user callback, the task will be destroyed in the 2nd stage of the function (the user callback is called in the 1st stage).
-	if (! gldi_task_is_running (pTask))  // we can free the task immediately.
+	if (! gldi_task_is_running (pTask) || _cancel_job (pTask))  // we can free the task immediately.
 	{
-		if (pTask->pThread && pTask->iPeriod && g_mutex_trylock (&pTask->mutex))  // the thread is sleeping, awake it and let it exit before we can free everything
-		{
-			pTask->bRunThread = TRUE;
-			g_cond_signal (&pTask->cond);
-			g_mutex_unlock (&pTask->mutex);
-			g_thread_join (pTask->pThread);  // unref the thread
-			pTask->pThread = NULL;
-		}
 		_free_task (pTask);
 	}
 }
@@ -308,7 +508,7 @@ void gldi_task_free (GldiTask *pTask)
 
 gboolean gldi_task_is_active (GldiTask *pTask)
 {
-	return (pTask != NULL && pTask->iSidTimer != 0);
+	return (pTask != NULL && (pTask->iSidTimer != 0 || pTask->iNextTick != 0));
 }
 
 gboolean gldi_task_is_running (GldiTask *pTask)
@@ -318,11 +518,11 @@ gboolean gldi_task_is_running (GldiTask *pTask)
 
 static void _restart_timer_with_frequency (GldiTask *pTask, int iNewPeriod)
 {
-	gboolean bNeedsRestart = (pTask->iSidTimer != 0);
+	gboolean bNeedsRestart = gldi_task_is_active (pTask);
 	_cancel_next_iteration (pTask);
 	
 	if (bNeedsRestart && iNewPeriod != 0)
-		pTask->iSidTimer = g_timeout_add_seconds (iNewPeriod, (GSourceFunc) _launch_task_timer, pTask);
+		_wheel_insert (pTask, iNewPeriod, iNewPeriod / 2);
 }
 
 void gldi_task_change_frequency (GldiTask *pTask, int iNewPeriod)
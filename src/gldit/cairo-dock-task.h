@@ -37,6 +37,10 @@ G_BEGIN_DECLS
  *
  * A Task can be periodic if you specify a period, otherwise it will be executed once. It also can also be fully synchronous if you don't specify an asynchronous function.
  * 
+ * The periodic Tasks share a single timer: their iterations are aligned on common ticks, so that Tasks with compatible periods wake up the dock together, and downgraded Tasks may be shifted a little to join an existing tick (see \ref gldi_task_get_nb_wakeups_per_minute).
+ * 
+ * The asynchronous phases of all the Tasks are run by a shared pool of worker threads, sized after the number of processors; so a Task doesn't own a thread, and the number of threads doesn't grow with the number of Tasks. Jobs waiting for a free worker are picked by order of priority (see \ref gldi_task_set_priority), and a job that has not started yet is simply cancelled when its Task is stopped or discarded.
+ * 
  */
 
 // Type of frequency for a periodic task. The frequency of the Task is divided by 2, 4, and 10 for each state.
@@ -48,6 +52,13 @@ typedef enum {
 	GLDI_TASK_NB_FREQUENCIES
 } GldiTaskFrequencyState;
 
+/// Priority of a Task, used to pick the next job when all the workers are busy.
+typedef enum {
+	GLDI_TASK_PRIORITY_LOW = -1,
+	GLDI_TASK_PRIORITY_NORMAL = 0,
+	GLDI_TASK_PRIORITY_HIGH = 1
+} GldiTaskPriority;
+
 /// Definition of the asynchronous job, that does the heavy part.
 typedef void (* GldiGetDataAsyncFunc ) (gpointer pSharedMemory);
 /// Definition of the synchronous job, that update the dock with the results of the previous job. Returns TRUE to continue, FALSE to stop
@@ -55,8 +66,12 @@ typedef gboolean (* GldiUpdateSyncFunc ) (gpointer pSharedMemory);
 
 /// Definition of a periodic and/or asynchronous Task.
 struct _GldiTask {
-	// ID of the timer of the Task (if periodic)
+	// ID of the timer of the Task (if launched with a delay)
 	gint iSidTimer;
+	// tick (in s) at which the Task is scheduled in the timer wheel, 0 if not scheduled.
+	gint64 iNextTick;
+	// current period of the Task in the timer wheel, taking into account its frequency state.
+	guint iTimerPeriod;
 	// TRUE if the thread is running or about to run or if the update is pending
 	gboolean bIsRunning;
 	// function carrying out the heavy job.
@@ -82,10 +97,15 @@ struct _GldiTask {
 	gboolean bDiscard;
 	gboolean bNeedsUpdate;  // TRUE when new data are waiting to be processed.
 	gboolean bContinue;  // result of the 'update' function (TRUE -> continue, FALSE -> stop, if the task is periodic).
-	GThread *pThread;  // the thread that execute the asynchronous 'get_data' callback
-	GCond cond;  // condition to awake the thread (if periodic). Only used if iPeriod > 0
-	gboolean bRunThread;  // condition value: whether to run the thread or exit.
-	GMutex mutex;  // mutex associated with the condition. Always initialized when creating a task.
+	gpointer pJob;  // the job waiting in the queue of the workers pool, or NULL once a worker took it. Only accessed under the lock of the pool.
+	GldiTaskPriority iPriority;  // priority of the jobs of this task in the workers pool.
+	GMutex mutex;  // held by the worker while it executes the 'get_data' callback. Always initialized when creating a task.
+	/// number of times the 'get_data' has been called, and the time and CPU time spent in it, in microseconds (written by the worker, so only approximate when read outside of the task).
+	guint iNbGetData;
+	gint64 iGetDataTime, iGetDataCpuTime;
+	/// number of times the 'update' has been called, and the time and CPU time spent in it, in microseconds.
+	guint iNbUpdates;
+	gint64 iUpdateTime, iUpdateCpuTime;
 } ;
 
 
@@ -119,7 +139,13 @@ GldiTask *gldi_task_new_full (int iPeriod, GldiGetDataAsyncFunc get_data, GldiUp
 */
 #define gldi_task_new(iPeriod, get_data, update, pSharedMemory) gldi_task_new_full (iPeriod, get_data, update, NULL, pSharedMemory)
 
-/** Stop a periodic Task. If the Task is running, it will wait until the asynchronous thread has finished, and skip the update. The Task can be launched again with a call to #gldi_task_launch.
+/** Set the priority of a Task. It takes effect from the next iteration; when all the workers are busy, the jobs with a higher priority are executed first.
+*@param pTask the Task.
+*@param iPriority the new priority.
+*/
+void gldi_task_set_priority (GldiTask *pTask, GldiTaskPriority iPriority);
+
+/** Stop a periodic Task. If the Task is running, it will wait until the asynchronous thread has finished, and skip the update. If the job is still waiting for a free worker, it is just cancelled. The Task can be launched again with a call to #gldi_task_launch.
 *@param pTask the periodic Task.
 */
 void gldi_task_stop (GldiTask *pTask);
@@ -166,10 +192,21 @@ void gldi_task_downgrade_frequency (GldiTask *pTask);
 */
 void gldi_task_set_normal_frequency (GldiTask *pTask);
 
+/** Get the number of times the timer of the periodic Tasks woke up the dock during the last minute. It is also given in the profiling report (see \ref gldi_profiling_get_report).
+*@return the number of wakeups.
+*/
+guint gldi_task_get_nb_wakeups_per_minute (void);
+
 /** Get the time elapsed since the last time the Task has run.
 *@param pTask the periodic Task.
 */
 #define gldi_task_get_elapsed_time(pTask) (pTask->fElapsedTime)
 
+/** Execute an action on all the Tasks that currently exist. It is mainly useful to know what they cost (see cairo-dock-profiling.h).
+*@param pFunction the action, called with the Task; it must not create or destroy any Task.
+*@param pUserData data passed to the action.
+*/
+void gldi_tasks_foreach (GFunc pFunction, gpointer pUserData);
+
 G_END_DECLS
 #endif
@@ -36,6 +36,7 @@
 #include "cairo-dock-backends-manager.h"
 #include "cairo-dock-dialog-manager.h"
 #include "cairo-dock-icon-facility.h"  // gldi_icons_get_any_without_dialog
+#include "cairo-dock-icon-manager.h"  // cairo_dock_reset_icon_path_cache
 #include "cairo-dock-task.h"
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_get_command_with_right_terminal
@@ -136,13 +137,13 @@ gboolean cairo_dock_current_theme_need_save (void)
 
 void cairo_dock_delete_conf_file (const gchar *cConfFilePath)
 {
-	g_remove (cConfFilePath);
+	cairo_dock_remove_key_file (cConfFilePath);
 	cairo_dock_mark_current_theme_as_modified (TRUE);
 }
 
 gboolean cairo_dock_add_conf_file (const gchar *cOriginalConfFilePath, const gchar *cConfFilePath)
 {
-	gboolean r = cairo_dock_copy_file (cOriginalConfFilePath, cConfFilePath);
+	gboolean r = cairo_dock_copy_key_file (cOriginalConfFilePath, cConfFilePath);
 	if (r)
 		cairo_dock_mark_current_theme_as_modified (TRUE);
 	return r;
@@ -177,6 +178,7 @@ gchar *cairo_dock_write_keys_to_new_conf_file (GKeyFile *pKeyFile, const gchar *
 gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean bSaveBehavior, gboolean bSaveLaunchers)
 {
 	g_return_val_if_fail (cNewThemeName != NULL, FALSE);
+	cairo_dock_sync_key_files ();  // the current theme must be up-to-date on the disk
 
 	gchar *cNewThemeNameWithoutSlashes = _replace_slash_by_underscore (g_strdup (cNewThemeName));
 	
@@ -303,6 +305,7 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 gboolean cairo_dock_package_current_theme (const gchar *cThemeName, const gchar *cDirPath)
 {
 	g_return_val_if_fail (cThemeName != NULL, FALSE);
+	cairo_dock_sync_key_files ();  // the current theme must be up-to-date on the disk
 	gboolean bSuccess = FALSE;
 
 	gchar *cNewThemeName = _escape_string_for_filename (cThemeName);
@@ -464,6 +467,7 @@ static void _launch_cmd (const gchar *cCommand)
 static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboolean bLoadBehavior, gboolean bLoadLaunchers)
 {
 	g_return_val_if_fail (cNewThemePath != NULL && g_file_test (cNewThemePath, G_FILE_TEST_EXISTS), FALSE);
+	cairo_dock_sync_key_files ();  // the current theme must be up-to-date on the disk
 	
 	//\___________________ We load global behaviour parameters for each dock.
 	GString *sCommand = g_string_new ("");
@@ -529,6 +533,7 @@ static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboo
 	}
 	_launch_cmd (sCommand->str);
 	g_free (cNewLocalIconsPath);
+	cairo_dock_reset_icon_path_cache ();  // the local icons have changed
 	
 	//\___________________ We load extras.
 	g_string_printf (sCommand, "%s/%s", cNewThemePath, CAIRO_DOCK_LOCAL_EXTRAS_DIR);
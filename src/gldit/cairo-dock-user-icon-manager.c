@@ -149,40 +149,54 @@ static void _load_one_icon (gpointer pAttr, G_GNUC_UNUSED gpointer dummy)
 	g_free ((void*)attr->cConfFileName);
 }
 
+static void _open_one_conf_file (GldiUserIconAttr *attr, G_GNUC_UNUSED gpointer data)
+{
+	gchar *cConfFile = (gchar*)attr->cConfFileName;
+	if (! _user_icon_conf_open (cConfFile, attr))  // sets cConfFileName to a copy on success
+		attr->iType = -1;
+	g_free (cConfFile);
+}
+
 void gldi_user_icons_new_from_directory (const gchar *cDirectory)
 {
 	cd_message ("%s (%s)", __func__, cDirectory);
 	GDir *dir = g_dir_open (cDirectory, 0, NULL);
 	g_return_if_fail (dir != NULL);
 	
+	//\__________________ read and parse the conf files in parallel (it's mainly waiting for the disk); the icons are created afterwards in the main thread.
+	cairo_dock_sync_key_files ();  // so that the conf files are only read from the disk by the threads
 	const gchar *cFileName;
-	GPtrArray *array = g_ptr_array_new_full (10, g_free);
-
+	GPtrArray *pAttrs = g_ptr_array_new_full (100, g_free);
+	GThreadPool *pPool = g_thread_pool_new ((GFunc)_open_one_conf_file, NULL, g_get_num_processors (), FALSE, NULL);
+	GldiUserIconAttr *attr;
 	while ((cFileName = g_dir_read_name (dir)) != NULL)
 	{
 		if (g_str_has_suffix (cFileName, ".desktop"))
 		{
-			GldiUserIconAttr *attr = g_new0 (GldiUserIconAttr, 1);
-			gboolean bRead = _user_icon_conf_open (cFileName, attr);
-			if (bRead)
-			{
-				if (attr->iType == GLDI_USER_ICON_TYPE_STACK)
-				{
-					// this is a subdock, create it now
-					_load_one_icon (attr, NULL);
-					g_free (attr);
-				}
-				// this is a launcher or separator, save it for later, after all subdocks have been created
-				else g_ptr_array_add (array, attr);
-			}
-			else g_free (attr);
+			attr = g_new0 (GldiUserIconAttr, 1);
+			attr->cConfFileName = g_strdup (cFileName);
+			g_ptr_array_add (pAttrs, attr);
+			g_thread_pool_push (pPool, attr, NULL);
 		}
 	}
 	g_dir_close (dir);
+	g_thread_pool_free (pPool, FALSE, TRUE);  // wait for all the files to be parsed
 	
-	// we have created all subdock, load launchers and separators now
-	g_ptr_array_foreach (array, _load_one_icon, NULL);
-	g_ptr_array_free (array, TRUE);
+	//\__________________ create the sub-docks first, then the launchers and separators that may go inside
+	guint i;
+	for (i = 0; i < pAttrs->len; i ++)
+	{
+		attr = g_ptr_array_index (pAttrs, i);
+		if (attr->iType == GLDI_USER_ICON_TYPE_STACK)
+			_load_one_icon (attr, NULL);
+	}
+	for (i = 0; i < pAttrs->len; i ++)
+	{
+		attr = g_ptr_array_index (pAttrs, i);
+		if (attr->iType != GLDI_USER_ICON_TYPE_STACK && attr->iType != -1)
+			_load_one_icon (attr, NULL);
+	}
+	g_ptr_array_free (pAttrs, TRUE);
 }
 
 
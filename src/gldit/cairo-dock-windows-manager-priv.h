@@ -74,6 +74,18 @@ const gchar *gldi_windows_manager_get_name ();
 */
 GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data);
 
+/** Get the window actor that has a given id. Since only one backend can be registered, the id alone identifies a window.
+*@param id the id of the window
+*@return the actor, or NULL if no window has this id
+*/
+GldiWindowActor *gldi_windows_find_by_id (guint id);
+
+/** Set the id of a window actor, so that it can be found with gldi_windows_find_by_id. Backends that provide ids must call it as soon as they know the id of an actor, and each time it changes.
+*@param actor the actor
+*@param id its id (the same as returned by get_id), or 0 to remove it from the index
+*/
+void gldi_window_set_id (GldiWindowActor *actor, guint id);
+
 /** Set the position of this window's icon, to be used by the WM for its minimize animation.
  * Note: coordinates are relative to the passed container's main surface. */
 void gldi_window_set_thumbnail_area (GldiWindowActor *actor, GldiContainer* pContainer, int x, int y, int w, int h);
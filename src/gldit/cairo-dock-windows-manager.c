@@ -29,73 +29,112 @@ GldiObjectManager myWindowObjectMgr;
 // dependencies
 
 // private
-GList *s_pWindowsList = NULL;  // list of all window actors
-static gboolean s_bSortedByZ = FALSE;  // whether the list is currently sorted by z-order
-static gboolean s_bSortedByAge = FALSE;  // whether the list is currently sorted by age
+static GPtrArray *s_pWindowsByAge = NULL;  // all window actors, in creation order (so sorted by age)
+static GPtrArray *s_pWindowsByZ = NULL;  // the same actors, sorted by z-order when s_bSortedByZ is TRUE
+static gboolean s_bSortedByZ = TRUE;  // whether s_pWindowsByZ is currently sorted
+static GHashTable *s_hWindowsById = NULL;  // id (as given by the backend with gldi_window_set_id) -> actor
+static gint s_iNbForeach = 0;  // number of iterations in progress on the arrays
+static gboolean s_bNeedsCompaction = FALSE;  // whether some slots have been emptied during an iteration
 static GldiWindowManagerBackend s_backend = {0};
 
 
 static gboolean on_zorder_changed (G_GNUC_UNUSED gpointer data)
 {
-	s_bSortedByZ = FALSE;  // invalidate the sorting
+	s_bSortedByZ = FALSE;  // the array will be re-sorted on the next ordered iteration
 	return GLDI_NOTIFICATION_LET_PASS;
 }
 
-static int _compare_z_order (GldiWindowActor *actor1, GldiWindowActor *actor2)
+static void _sort_by_z_order (void)
 {
-	if (actor1->iStackOrder < actor2->iStackOrder)
-		return -1;
-	else if (actor1->iStackOrder > actor2->iStackOrder)
-		return 1;
-	else
-		return 0;
+	// the stack orders are updated in place by the backends, and usually only a few windows move between 2 changes (raise, new window), so the array is almost sorted: an insertion sort is linear in that case and keeps the relative order of equal windows.
+	GldiWindowActor **pActors = (GldiWindowActor**)s_pWindowsByZ->pdata;
+	GldiWindowActor *actor;
+	guint i, j, n = s_pWindowsByZ->len;
+	for (i = 1; i < n; i ++)
+	{
+		actor = pActors[i];
+		for (j = i; j > 0 && pActors[j-1]->iStackOrder > actor->iStackOrder; j --)
+			pActors[j] = pActors[j-1];
+		pActors[j] = actor;
+	}
+	s_bSortedByZ = TRUE;
 }
 
-static int _compare_age (GldiWindowActor *actor1, GldiWindowActor *actor2)
+static void _compact_arrays (void)
 {
-	if (actor1->iAge < actor2->iAge)
-		return -1;
-	else if (actor1->iAge > actor2->iAge)
-		return 1;
-	else
-		return 0;
+	guint i;
+	for (i = s_pWindowsByAge->len; i > 0; i --)
+		if (g_ptr_array_index (s_pWindowsByAge, i-1) == NULL)
+			g_ptr_array_remove_index (s_pWindowsByAge, i-1);
+	for (i = s_pWindowsByZ->len; i > 0; i --)
+		if (g_ptr_array_index (s_pWindowsByZ, i-1) == NULL)
+			g_ptr_array_remove_index (s_pWindowsByZ, i-1);
+	s_bNeedsCompaction = FALSE;
 }
 
-void gldi_windows_foreach (gboolean bOrderedByZ, GFunc callback, gpointer data)
+static void _foreach_in_array (GPtrArray *pArray, GFunc callback, gpointer data)
 {
-	if (bOrderedByZ && ! s_bSortedByZ)
+	// the callback may destroy windows (their slot is then emptied, see reset_object) or create new ones (they are appended, and not iterated, like with the list we had before).
+	s_iNbForeach ++;
+	guint i, n = pArray->len;
+	gpointer actor;
+	for (i = 0; i < n; i ++)
 	{
-		s_pWindowsList = g_list_sort (s_pWindowsList, (GCompareFunc)_compare_z_order);
-		s_bSortedByZ = TRUE;
-		s_bSortedByAge = FALSE;
+		actor = g_ptr_array_index (pArray, i);
+		if (actor != NULL)
+			callback (actor, data);
 	}
-	else if (! bOrderedByZ && ! s_bSortedByAge)
+	s_iNbForeach --;
+	if (s_iNbForeach == 0 && s_bNeedsCompaction)
+		_compact_arrays ();
+}
+
+void gldi_windows_foreach (gboolean bOrderedByZ, GFunc callback, gpointer data)
+{
+	if (bOrderedByZ)
 	{
-		s_pWindowsList = g_list_sort (s_pWindowsList, (GCompareFunc)_compare_age);
-		s_bSortedByAge = TRUE;
-		s_bSortedByZ = FALSE;
+		if (! s_bSortedByZ && s_iNbForeach == 0)  // don't move the actors under the feet of an iteration in progress
+			_sort_by_z_order ();
+		_foreach_in_array (s_pWindowsByZ, callback, data);
 	}
-	g_list_foreach (s_pWindowsList, callback, data);
+	else
+		_foreach_in_array (s_pWindowsByAge, callback, data);
 }
 
 void gldi_windows_foreach_unordered (GFunc callback, gpointer data)
 {
-	g_list_foreach (s_pWindowsList, callback, data);
+	_foreach_in_array (s_pWindowsByAge, callback, data);
 }
 
 GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data)
 {
 	GldiWindowActor *actor;
-	GList *a;
-	for (a = s_pWindowsList; a != NULL; a = a->next)
+	guint i;
+	for (i = 0; i < s_pWindowsByAge->len; i ++)
 	{
-		actor = a->data;
-		if (callback (actor, data))
+		actor = g_ptr_array_index (s_pWindowsByAge, i);
+		if (actor != NULL && callback (actor, data))
 			return actor;
 	}
 	return NULL;
 }
 
+GldiWindowActor *gldi_windows_find_by_id (guint id)
+{
+	return (id != 0 ? g_hash_table_lookup (s_hWindowsById, GUINT_TO_POINTER (id)) : NULL);
+}
+
+void gldi_window_set_id (GldiWindowActor *actor, guint id)
+{
+	if (actor->iId == id)
+		return;
+	if (actor->iId != 0 && g_hash_table_lookup (s_hWindowsById, GUINT_TO_POINTER (actor->iId)) == actor)
+		g_hash_table_remove (s_hWindowsById, GUINT_TO_POINTER (actor->iId));
+	actor->iId = id;
+	if (id != 0)
+		g_hash_table_insert (s_hWindowsById, GUINT_TO_POINTER (id), actor);
+}
+
 static void _add_to_array (void *actor, void *data)
 {
 	GPtrArray *array = (GPtrArray*)data;
@@ -104,8 +143,8 @@ static void _add_to_array (void *actor, void *data)
 
 GPtrArray *gldi_window_manager_get_all (void)
 {
-	GPtrArray *ret = g_ptr_array_new ();
-	g_list_foreach (s_pWindowsList, _add_to_array, ret);
+	GPtrArray *ret = g_ptr_array_sized_new (s_pWindowsByAge->len);
+	gldi_windows_foreach_unordered (_add_to_array, ret);
 	return ret;
 }
 
@@ -507,7 +546,9 @@ gchar* gldi_window_parse_class(const gchar* res_class, const gchar* res_name) {
 static void init_object (GldiObject *obj, G_GNUC_UNUSED gpointer attr)
 {
 	GldiWindowActor *actor = (GldiWindowActor*)obj;
-	s_pWindowsList = g_list_prepend (s_pWindowsList, actor);
+	g_ptr_array_add (s_pWindowsByAge, actor);
+	g_ptr_array_add (s_pWindowsByZ, actor);
+	s_bSortedByZ = FALSE;  // its z-order is not known yet
 }
 
 static void reset_object (GldiObject *obj)
@@ -518,7 +559,27 @@ static void reset_object (GldiObject *obj)
 	g_free (actor->cWmClass);
 	g_free (actor->cWmName);
 	g_free (actor->cLastAttentionDemand);
-	s_pWindowsList = g_list_remove (s_pWindowsList, actor);
+	
+	// remove it from the index
+	gldi_window_set_id (actor, 0);
+	
+	// remove it from the arrays, keeping the order of the other actors
+	if (s_iNbForeach != 0)  // an iteration is in progress, just empty the slots, they will be removed at the end
+	{
+		guint i;
+		for (i = 0; i < s_pWindowsByAge->len; i ++)
+			if (g_ptr_array_index (s_pWindowsByAge, i) == actor)
+				g_ptr_array_index (s_pWindowsByAge, i) = NULL;
+		for (i = 0; i < s_pWindowsByZ->len; i ++)
+			if (g_ptr_array_index (s_pWindowsByZ, i) == actor)
+				g_ptr_array_index (s_pWindowsByZ, i) = NULL;
+		s_bNeedsCompaction = TRUE;
+	}
+	else
+	{
+		g_ptr_array_remove (s_pWindowsByAge, actor);
+		g_ptr_array_remove (s_pWindowsByZ, actor);
+	}
 }
 
 void gldi_register_windows_manager (void)
@@ -535,6 +596,9 @@ void gldi_register_windows_manager (void)
 	
 	// init
 	memset (&s_backend, 0, sizeof (GldiWindowManagerBackend));
+	s_pWindowsByAge = g_ptr_array_new ();
+	s_pWindowsByZ = g_ptr_array_new ();
+	s_hWindowsById = g_hash_table_new (g_direct_hash, g_direct_equal);
 	gldi_object_register_notification (&myWindowObjectMgr,
 		NOTIFICATION_WINDOW_Z_ORDER_CHANGED,
 		(GldiNotificationFunc) on_zorder_changed,
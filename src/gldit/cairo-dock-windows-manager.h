@@ -73,6 +73,7 @@ struct _GldiWindowActor {
 	gint iAge;  // age of the window (a mere growing integer).
 	gboolean bIsTransientFor;  // TRUE if the window is transient (for a parent window).
 	gboolean bIsSticky;
+	guint iId;  // id given by the backend with gldi_window_set_id (0 if none), see gldi_windows_find_by_id
 	};
 
 
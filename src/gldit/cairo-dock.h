@@ -88,6 +88,7 @@
 #include <gldit/cairo-dock-keyfile-utilities.h>
 #include <gldit/cairo-dock-keybinder.h>
 #include <gldit/cairo-dock-task.h>
+#include <gldit/cairo-dock-profiling.h>
 #include <gldit/cairo-dock-particle-system.h>
 #include <gldit/cairo-dock-packages.h>
 #include <gldit/cairo-dock-surface-factory.h>
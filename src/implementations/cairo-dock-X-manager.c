@@ -106,6 +106,8 @@ static Atom s_aNetStartupInfoBegin;
 static Atom s_aNetStartupInfo;
 static GHashTable *s_hXWindowTable = NULL;  // table of (Xid,actor)
 static GHashTable *s_hXClientMessageTable = NULL;  // table of (Xid,client-message)
+static GHashTable *s_hPendingXProps = NULL;  // table of (Xid,CairoDockXPropMask): properties that changed during the current events burst, and that will be fetched all at once at the end of it
+#define XPROP_SEARCH_WM_NAME (CAIRO_DOCK_XPROP_ALL + 1)  // pending flag: the WM_NAME changed, fall back on it if the window has no _NET_WM_NAME
 static int s_iTime = 1;  // on peut aller jusqu'a 2^31, soit 17 ans a 4Hz.
 static int s_iNumWindow = 1;  // used to order appli icons by age (=creation date).
 static Window s_iCurrentActiveWindow = 0;
@@ -136,8 +138,9 @@ struct _GldiXWindowActor {
 	};
 
 
-static GldiXWindowActor *_make_new_actor (Window Xid)
+static GldiXWindowActor *_make_new_actor (const CairoDockXWindowProps *pProps)  // pProps holds all the properties of the window (CAIRO_DOCK_XPROP_ALL)
 {
+	Window Xid = pProps->Xid;
 	GldiXWindowActor *xactor;
 	gboolean bShowInTaskbar = FALSE;
 	gboolean bNormalWindow = FALSE;
@@ -147,19 +150,19 @@ static GldiXWindowActor *_make_new_actor (Window Xid)
 	
 	//\__________________ see if we should skip it
 	// check its 'skip taskbar' property
-	bShowInTaskbar = cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Xid, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention, &bIsSticky);
+	bShowInTaskbar = cairo_dock_xwindow_props_get_state (pProps, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention, &bIsSticky);
 	
 	if (bShowInTaskbar)
 	{
 		// check its type
-		bNormalWindow = cairo_dock_get_xwindow_type (Xid, &iTransientFor);
+		bNormalWindow = cairo_dock_xwindow_props_get_type (pProps, &iTransientFor);
 		if (bNormalWindow || iTransientFor != None)
 		{
 			// check get its class
-			cClass = cairo_dock_get_xwindow_class (Xid, &cWmClass, &cWmName);
+			cClass = cairo_dock_xwindow_props_get_class (pProps, &cWmClass, &cWmName);
 			if (cClass == NULL)
 			{
-				gchar *cName = cairo_dock_get_xwindow_name (Xid, TRUE);
+				gchar *cName = cairo_dock_xwindow_props_get_name (pProps, TRUE);
 				cd_warning ("this window (%s, %ld) doesn't belong to any class, skip it.\n"
 					"Please report this bug to the application's devs.", cName, Xid);
 				g_free (cName);
@@ -174,13 +177,13 @@ static GldiXWindowActor *_make_new_actor (Window Xid)
 	}
 	else
 	{
-		XGetTransientForHint (s_XDisplay, Xid, &iTransientFor);
+		iTransientFor = pProps->iTransientFor;
 	}
 	
 	//\__________________ if the window passed all the tests, make a new actor
 	if (bShowInTaskbar)  // make a new actor and fill the properties we got before
 	{
-		xactor = (GldiXWindowActor*)gldi_object_new (&myXObjectMgr, &Xid);
+		xactor = (GldiXWindowActor*)gldi_object_new (&myXObjectMgr, (gpointer)pProps);
 		GldiWindowActor *actor = (GldiWindowActor*)xactor;
 		actor->bDisplayed = bNormalWindow;
 		actor->cClass = cClass;
@@ -302,34 +305,53 @@ static void _on_update_applis_list (void)
 	gulong i, iNbWindows = 0;
 	Window *pXWindowsList = cairo_dock_get_windows_list (&iNbWindows, TRUE);  // TRUE => ordered by z-stack.
 	
-	// set the z-order of existing windows, and create actors for new windows
+	// get the properties of all the new windows at once
 	Window Xid;
+	Window *pNewXids = g_new (Window, MAX (iNbWindows, 1));
+	guint n, iNbNewWindows = 0;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		Xid = pXWindowsList[i];
+		if (g_hash_table_lookup (s_hXWindowTable, &Xid) == NULL)
+			pNewXids[iNbNewWindows ++] = Xid;
+	}
+	CairoDockXWindowProps *pNewProps = cairo_dock_fetch_xwindows_properties (pNewXids, iNbNewWindows, CAIRO_DOCK_XPROP_ALL);
+	
+	// set the z-order of existing windows, and create actors for new windows
 	GldiXWindowActor *actor;
 	int iStackOrder = 0;
-	for (i = 0; i < iNbWindows; i ++)
+	for (i = 0, n = 0; i < iNbWindows; i ++)
 	{
 		Xid = pXWindowsList[i];
 		
 		// check if the window is already known
 		actor = g_hash_table_lookup (s_hXWindowTable, &Xid);
-		if (actor == NULL)
+		gboolean bNewWindow = (n < iNbNewWindows && pNewXids[n] == Xid);  // new windows come in the same order as in the list
+		if (actor == NULL && bNewWindow)
 		{
 			// create a window actor
 			cd_message (" cette fenetre (%ld) de la pile n'est pas dans la liste", Xid);
-			actor = _make_new_actor (Xid);
+			actor = _make_new_actor (&pNewProps[n]);
 			
 			// notify everybody
 			if (! actor->bIgnored)
 				gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CREATED, actor);
 		}
-		else  // just update its check-time
+		else if (actor != NULL)  // just update its check-time
 			actor->iLastCheckTime = s_iTime;
+		if (bNewWindow)
+			n ++;
+		if (actor == NULL)
+			continue;
 		
 		// update the z-order
 		if (! actor->bIgnored)
 			actor->actor.iStackOrder = iStackOrder ++;
 	}
 	
+	cairo_dock_free_xwindows_properties (pNewProps, iNbNewWindows);
+	g_free (pNewXids);
+	
 	// remove old actors for windows that disappeared
 	g_hash_table_foreach_remove (s_hXWindowTable, (GHRFunc) _remove_old_applis, GINT_TO_POINTER (s_iTime));
 	
@@ -374,6 +396,159 @@ static void lookup_ignorable_modifiers (void)
 	scroll_lock_mask = XkbKeysymToModifiers (s_XDisplay, GDK_KEY_Scroll_Lock);
 }
 
+static void _queue_properties_update (Window Xid, guint iMask)
+{
+	guint iPendingMask = GPOINTER_TO_UINT (g_hash_table_lookup (s_hPendingXProps, &Xid));
+	Window *pXid = g_new (Window, 1);
+	*pXid = Xid;
+	g_hash_table_insert (s_hPendingXProps, pXid, GUINT_TO_POINTER (iPendingMask | iMask));  // if the window is already pending, the table keeps its key and frees this one
+}
+
+static void _on_state_changed (GldiXWindowActor *xactor, const CairoDockXWindowProps *pProps)
+{
+	GldiWindowActor *actor = (GldiWindowActor*)xactor;
+	Window Xid = xactor->Xid;
+	// get current state
+	gboolean bIsFullScreen, bIsHidden, bIsMaximized, bDemandsAttention, bIsSticky;
+	gboolean bSkipTaskbar = ! cairo_dock_xwindow_props_get_state (pProps, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention, &bIsSticky);
+	
+	// special case where a window enters/leaves the taskbar
+	if (bSkipTaskbar != xactor->bIgnored)
+	{
+		if (xactor->bIgnored)  // was ignored, simply recreate it
+		{
+			// remove it from the table, so that the XEvent loop detects it again
+			g_hash_table_remove (s_hXWindowTable, &Xid);  // remove it explicitly, because the 'unref' might not free it
+			xactor->iLastCheckTime = -1;
+			_delete_actor (xactor);  // unref it since we don't need it anymore
+		}
+		else  // is now ignored
+		{
+			xactor->bIgnored = bSkipTaskbar;
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
+		}
+		return;  // actor is either freed or ignored
+	}
+	
+	if (xactor->bIgnored)  // skip taskbar
+		return;
+	// update the actor
+	gboolean bHiddenChanged     = (bIsHidden != actor->bIsHidden);
+	gboolean bMaximizedChanged  = (bIsMaximized != actor->bIsMaximized);
+	gboolean bFullScreenChanged = (bIsFullScreen != actor->bIsFullScreen);
+	actor->bIsHidden     = bIsHidden;
+	actor->bIsMaximized  = bIsMaximized;
+	actor->bIsFullScreen = bIsFullScreen;
+	if (bHiddenChanged && ! bIsHidden)  // the window is now mapped => BackingPixmap is available.
+		_update_backing_pixmap (xactor);
+	
+	// notify everybody
+	if (bDemandsAttention)
+		_set_demand_attention (xactor, X_DEMANDS_ATTENTION);  // -> NOTIFICATION_WINDOW_ATTENTION_CHANGED
+	else
+		_unset_demand_attention (xactor, X_DEMANDS_ATTENTION);  // -> NOTIFICATION_WINDOW_ATTENTION_CHANGED
+	gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_STATE_CHANGED, actor, bHiddenChanged, bMaximizedChanged, bFullScreenChanged);
+	
+	if (actor->bIsSticky != bIsSticky)  // a change in stickyness can be seen as a change in the desktop position
+	{
+		actor->bIsSticky = bIsSticky;
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESKTOP_CHANGED, actor);
+	}
+}
+
+static void _on_class_changed (GldiXWindowActor *xactor, const CairoDockXWindowProps *pProps)
+{
+	GldiWindowActor *actor = (GldiWindowActor*)xactor;
+	// update the actor
+	gchar *cOldClass = actor->cClass, *cOldWmClass = actor->cWmClass;
+	gchar *cWmClass = NULL;
+	gchar *cWmName = NULL;
+	gchar *cNewClass = cairo_dock_xwindow_props_get_class (pProps, &cWmClass, &cWmName);
+	if (! cNewClass || g_strcmp0 (cNewClass, cOldClass) == 0)
+	{
+		g_free (cNewClass);
+		g_free (cWmClass);
+		g_free (cWmName);
+		return;
+	}
+	actor->cClass = cNewClass;
+	actor->cWmClass = cWmClass;
+	g_free (actor->cWmName);
+	actor->cWmName = cWmName;
+	
+	// notify everybody
+	gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CLASS_CHANGED, actor, cOldClass, cOldWmClass);
+	
+	g_free (cOldClass);
+	g_free (cOldWmClass);
+}
+
+static void _update_pending_properties (void)
+{
+	guint iNbWindows = g_hash_table_size (s_hPendingXProps);
+	if (iNbWindows == 0)
+		return;
+	
+	// collect the windows and what changed on them
+	Window *pXids = g_new (Window, iNbWindows);
+	guint *pMasks = g_new (guint, iNbWindows);
+	guint i = 0, iMask = 0;
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init (&iter, s_hPendingXProps);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		pXids[i] = *(Window*)key;
+		pMasks[i] = GPOINTER_TO_UINT (value);
+		iMask |= pMasks[i];
+		i ++;
+	}
+	g_hash_table_remove_all (s_hPendingXProps);
+	
+	// fetch them all at once
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (pXids, iNbWindows, iMask & CAIRO_DOCK_XPROP_ALL);
+	
+	// update the actors
+	GldiXWindowActor *xactor;
+	GldiWindowActor *actor;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		xactor = g_hash_table_lookup (s_hXWindowTable, &pXids[i]);
+		if (xactor == NULL)  // the window has disappeared in the meantime
+			continue;
+		if (pMasks[i] & CAIRO_DOCK_XPROP_STATE)
+		{
+			_on_state_changed (xactor, &pProps[i]);
+			xactor = g_hash_table_lookup (s_hXWindowTable, &pXids[i]);  // it may have been destroyed
+			if (xactor == NULL)
+				continue;
+		}
+		if (xactor->bIgnored)  // skip taskbar
+			continue;
+		actor = (GldiWindowActor*)xactor;
+		
+		if (pMasks[i] & CAIRO_DOCK_XPROP_DESKTOP)
+		{
+			actor->iNumDesktop = pProps[i].iNumDesktop;
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESKTOP_CHANGED, actor);
+		}
+		if (pMasks[i] & CAIRO_DOCK_XPROP_NAME)
+		{
+			g_free (actor->cName);
+			actor->cName = cairo_dock_xwindow_props_get_name (&pProps[i], (pMasks[i] & XPROP_SEARCH_WM_NAME) != 0);
+			gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_NAME_CHANGED, actor);
+		}
+		if (pMasks[i] & CAIRO_DOCK_XPROP_CLASS)
+		{
+			_on_class_changed (xactor, &pProps[i]);
+		}
+	}
+	
+	cairo_dock_free_xwindows_properties (pProps, iNbWindows);
+	g_free (pMasks);
+	g_free (pXids);
+}
+
 static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 {
 	static XEvent event;
@@ -587,73 +762,20 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 				}
 				else if (event.xproperty.atom == s_aNetWmState)
 				{
-					// get current state
-					gboolean bIsFullScreen, bIsHidden, bIsMaximized, bDemandsAttention, bIsSticky;
-					gboolean bSkipTaskbar = ! cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Xid, &bIsFullScreen, &bIsHidden, &bIsMaximized, &bDemandsAttention, &bIsSticky);
-					
-					// special case where a window enters/leaves the taskbar
-					if (bSkipTaskbar != xactor->bIgnored)
-					{
-						if (xactor->bIgnored)  // was ignored, simply recreate it
-						{
-							// remove it from the table, so that the XEvent loop detects it again
-							g_hash_table_remove (s_hXWindowTable, &Xid);  // remove it explicitly, because the 'unref' might not free it
-							xactor->iLastCheckTime = -1;
-							_delete_actor (xactor);  // unref it since we don't need it anymore
-						}
-						else  // is now ignored
-						{
-							xactor->bIgnored = bSkipTaskbar;
-							gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
-						}
-						continue;  // actor is either freed or ignored
-					}
-					
-					if (xactor->bIgnored)  // skip taskbar
-						continue;
-					// update the actor
-					gboolean bHiddenChanged     = (bIsHidden != actor->bIsHidden);
-					gboolean bMaximizedChanged  = (bIsMaximized != actor->bIsMaximized);
-					gboolean bFullScreenChanged = (bIsFullScreen != actor->bIsFullScreen);
-					actor->bIsHidden     = bIsHidden;
-					actor->bIsMaximized  = bIsMaximized;
-					actor->bIsFullScreen = bIsFullScreen;
-					if (bHiddenChanged && ! bIsHidden)  // the window is now mapped => BackingPixmap is available.
-						_update_backing_pixmap (xactor);
-					
-					// notify everybody
-					if (bDemandsAttention)
-						_set_demand_attention (xactor, X_DEMANDS_ATTENTION);  // -> NOTIFICATION_WINDOW_ATTENTION_CHANGED
-					else
-						_unset_demand_attention (xactor, X_DEMANDS_ATTENTION);  // -> NOTIFICATION_WINDOW_ATTENTION_CHANGED
-					gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_STATE_CHANGED, actor, bHiddenChanged, bMaximizedChanged, bFullScreenChanged);
-					
-					if (actor->bIsSticky != bIsSticky)  // a change in stickyness can be seen as a change in the desktop position
-					{
-						actor->bIsSticky = bIsSticky;
-						gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESKTOP_CHANGED, actor);
-					}
+					_queue_properties_update (Xid, CAIRO_DOCK_XPROP_STATE);  // even if the window is ignored, since it may enter the taskbar
 				}
 				else if (event.xproperty.atom == s_aNetWmDesktop)
 				{
 					if (xactor->bIgnored)  // skip taskbar
 						continue;
-					// update the actor
-					actor->iNumDesktop = cairo_dock_get_xwindow_desktop (Xid);
-					
-					// notify everybody
-					gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESKTOP_CHANGED, actor);
+					_queue_properties_update (Xid, CAIRO_DOCK_XPROP_DESKTOP);
 				}
 				else if (event.xproperty.atom == s_aWmName
 				|| event.xproperty.atom == s_aNetWmName)
 				{
 					if (xactor->bIgnored)  // skip taskbar
 						continue;
-					// update the actor
-					g_free (actor->cName);
-					actor->cName = cairo_dock_get_xwindow_name (Xid, event.xproperty.atom == s_aWmName);
-					// notify everybody
-					gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_NAME_CHANGED, actor);
+					_queue_properties_update (Xid, CAIRO_DOCK_XPROP_NAME | (event.xproperty.atom == s_aWmName ? XPROP_SEARCH_WM_NAME : 0));
 				}
 				else if (event.xproperty.atom == s_aWmHints)
 				{
@@ -691,27 +813,7 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 				{
 					if (xactor->bIgnored)  // skip taskbar
 						continue;
-					// update the actor
-					gchar *cOldClass = actor->cClass, *cOldWmClass = actor->cWmClass;
-					gchar *cWmClass = NULL;
-					gchar *cWmName = NULL;
-					gchar *cNewClass = cairo_dock_get_xwindow_class (Xid, &cWmClass, &cWmName);
-					if (! cNewClass || g_strcmp0 (cNewClass, cOldClass) == 0)
-					{
-						g_free (cWmClass);
-						g_free (cWmName);
-						continue;
-					}
-					actor->cClass = cNewClass;
-					actor->cWmClass = cWmClass;
-					g_free (actor->cWmName);
-					actor->cWmName = cWmName;
-					
-					// notify everybody
-					gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CLASS_CHANGED, actor, cOldClass, cOldWmClass);
-					
-					g_free (cOldClass);
-					g_free (cOldWmClass);
+					_queue_properties_update (Xid, CAIRO_DOCK_XPROP_CLASS);
 				}
 			}
 			else if (event.type == ConfigureNotify)
@@ -754,6 +856,8 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 		}  // end of event
 	}
 	
+	_update_pending_properties ();  // fetch in one go all the properties that changed during this burst
+	
 	XFlush (s_XDisplay);  // now that there are no more messages in the input queue, flush the output queue
 	return TRUE;
 }
@@ -1635,17 +1739,23 @@ static void init (void)
 		g_free,  // Xid
 		(GDestroyNotify)_string_free);  // GString
 	
+	s_hPendingXProps = g_hash_table_new_full (g_int_hash,
+		g_int_equal,
+		g_free,  // Xid
+		NULL);  // mask
+	
 	//\__________________ get the list of windows
 	gulong i, iNbWindows = 0;
 	Window *pXWindowsList = cairo_dock_get_windows_list (&iNbWindows, FALSE);  // ordered by creation date; this allows us to set the correct age to the icon, which is constant. On the next updates, the z-order (which is dynamic) will be set.
 	cd_debug ("got %d X windows", iNbWindows);
 	
-	Window Xid;
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (pXWindowsList, iNbWindows, CAIRO_DOCK_XPROP_ALL);  // a single round-trip for all the windows
 	for (i = 0; i < iNbWindows; i ++)
 	{
-		Xid = pXWindowsList[i];
-		(void)_make_new_actor (Xid);
+		if (g_hash_table_lookup (s_hXWindowTable, &pXWindowsList[i]) == NULL)  // in case the list contains a window twice
+			(void)_make_new_actor (&pProps[i]);
 	}
+	cairo_dock_free_xwindows_properties (pProps, iNbWindows);
 	if (pXWindowsList != NULL)
 		XFree (pXWindowsList);
 	
@@ -1752,17 +1862,17 @@ static void init_object (GldiObject *obj, gpointer attr)
 {
 	GldiXWindowActor *xactor = (GldiXWindowActor*)obj;
 	GldiWindowActor *actor = (GldiWindowActor*)xactor;
-	Window *xid = (Window*)attr;
-	Window Xid = *xid;
+	const CairoDockXWindowProps *pProps = attr;  // already fetched by _make_new_actor()
+	Window Xid = pProps->Xid;
 	
 	xactor->Xid = Xid;
+	gldi_window_set_id (actor, Xid);
 	
 	// get additional properties
-	actor->cName = cairo_dock_get_xwindow_name (Xid, TRUE);
-	actor->iNumDesktop = cairo_dock_get_xwindow_desktop (Xid);
+	actor->cName = cairo_dock_xwindow_props_get_name (pProps, TRUE);
+	actor->iNumDesktop = pProps->iNumDesktop;
 	
-	int iLocalPositionX=0, iLocalPositionY=0, iWidthExtent=0, iHeightExtent=0;
-	cairo_dock_get_xwindow_geometry (Xid, &iLocalPositionX, &iLocalPositionY, &iWidthExtent, &iHeightExtent);
+	int iLocalPositionX = pProps->x, iLocalPositionY = pProps->y, iWidthExtent = pProps->iWidth, iHeightExtent = pProps->iHeight;
 	
 	iLocalPositionX /= cairo_dock_X_display_scale;
 	iLocalPositionY /= cairo_dock_X_display_scale;
@@ -1808,6 +1918,8 @@ static void reset_object (GldiObject *obj)
 	
 	cairo_dock_set_xicon_geometry (actor->Xid, 0, 0, 0, 0);
 	
+	cairo_dock_forget_xwindow_icon (actor->Xid);
+	
 	// remove from table
 	if (actor->iLastCheckTime != -1)  // if not already removed
 		g_hash_table_remove (s_hXWindowTable, &actor->Xid);
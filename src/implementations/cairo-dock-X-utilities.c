@@ -31,6 +31,11 @@
 #endif
 #include <X11/extensions/Xrandr.h>
 #endif
+#ifdef HAVE_X11_XCB
+#include <X11/Xlib-xcb.h>  // XGetXCBConnection
+#include <xcb/xcb.h>
+#endif
+#include <string.h>  // memcpy, memchr
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_remove_version_from_string, cairo_dock_check_xrandr
@@ -87,6 +92,7 @@ static Atom s_aNetWMActionClose;
 static Atom s_aNetWmDesktop;
 static Atom s_aNetWmIcon;
 static Atom s_aNetWmName;
+static Atom s_aNetFrameExtents;
 static Atom s_aWmName;
 static Atom s_aUtf8String;
 static Atom s_aString;
@@ -160,6 +166,7 @@ Display *cairo_dock_initialize_X_desktop_support (void)
     s_aNetWmDesktop             = XInternAtom (s_XDisplay, "_NET_WM_DESKTOP", False);
     s_aNetWmIcon                = XInternAtom (s_XDisplay, "_NET_WM_ICON", False);
     s_aNetWmName                = XInternAtom (s_XDisplay, "_NET_WM_NAME", False);
+    s_aNetFrameExtents          = XInternAtom (s_XDisplay, "_NET_FRAME_EXTENTS", False);
     s_aWmName                   = XInternAtom (s_XDisplay, "WM_NAME", False);
     s_aUtf8String               = XInternAtom (s_XDisplay, "UTF8_STRING", False);
     s_aString                   = XInternAtom (s_XDisplay, "STRING", False);
@@ -970,41 +977,400 @@ gulong cairo_dock_get_xwindow_timestamp (Window Xid)
 	return iTimeStamp;
 }
 
-gchar *cairo_dock_get_xwindow_name (Window Xid, gboolean bSearchWmName)
+// Properties of a window, as they are sent by the server: the reply is copied into a buffer owned by the caller (format-32 values are stored as gulong, like Xlib does, and strings are nul-terminated).
+static gpointer _copy_property_value (const void *pValue, int iFormat, gulong iNbItems)
+{
+	if (iNbItems == 0 || pValue == NULL)
+		return NULL;
+	gpointer pBuffer;
+	if (iFormat == 32)
+	{
+		gulong *pLongs = g_new (gulong, iNbItems);
+		gulong i;
+		#ifdef HAVE_X11_XCB
+		const uint32_t *pValues = pValue;  // XCB gives us the raw 32 bits values
+		#else
+		const long *pValues = pValue;  // Xlib already expands them into longs
+		#endif
+		for (i = 0; i < iNbItems; i ++)
+			pLongs[i] = pValues[i];
+		pBuffer = pLongs;
+	}
+	else  // strings
+	{
+		gsize iSize = iNbItems * (iFormat / 8);
+		pBuffer = g_malloc (iSize + 1);
+		memcpy (pBuffer, pValue, iSize);
+		((gchar*)pBuffer)[iSize] = '\0';
+	}
+	return pBuffer;
+}
+
+static void _parse_wm_class (CairoDockXWindowProps *pProps, const gchar *pValue, gulong iLength)  // same as XGetClassHint: "res_name\0res_class\0"
+{
+	if (pValue == NULL || iLength == 0)
+		return;
+	const gchar *pEnd = memchr (pValue, '\0', iLength);  // strnlen is not C99
+	gsize iLengthName = (pEnd ? (gsize)(pEnd - pValue) : iLength);
+	pProps->cResName = g_strndup (pValue, iLengthName);
+	if (iLengthName == iLength)  // no res_class
+		iLengthName --;
+	pProps->cResClass = g_strndup (pValue + iLengthName + 1, iLength - iLengthName - 1);
+}
+
+#ifdef HAVE_X11_XCB
+static void _set_geometry (CairoDockXWindowProps *pProps, int iWidth, int iHeight, int iRootX, int iRootY, const gulong *pExtents, gulong iNbExtents)  // same as cairo_dock_get_xwindow_geometry
+{
+	int left=0, right=0, top=0, bottom=0;
+	if (iNbExtents > 3)
+	{
+		left=pExtents[0], right=pExtents[1], top=pExtents[2], bottom=pExtents[3];
+	}
+	pProps->x = iRootX - left;
+	pProps->y = iRootY - top;
+	pProps->iWidth = iWidth + left + right;
+	pProps->iHeight = iHeight + top + bottom;
+}
+
+typedef struct {
+	xcb_get_property_cookie_t state, type, transient, net_name, name, wm_class, desktop, extents;
+	xcb_get_geometry_cookie_t geometry;
+	xcb_translate_coordinates_cookie_t position;
+} CDXWindowCookies;
+
+static inline xcb_get_property_cookie_t _send_property_request (xcb_connection_t *c, Window Xid, Atom aProperty, Atom aType)
+{
+	return xcb_get_property (c, 0, Xid, aProperty, aType, 0, G_MAXUINT32 / 4);  // length is in 32 bits units
+}
+
+static gpointer _get_property_reply (xcb_connection_t *c, xcb_get_property_cookie_t cookie, int iFormat, gulong *iNbItems)
+{
+	*iNbItems = 0;
+	xcb_generic_error_t *pError = NULL;
+	xcb_get_property_reply_t *pReply = xcb_get_property_reply (c, cookie, &pError);
+	free (pError);  // typically the window has been destroyed in the meantime, just ignore it like we ignore X errors.
+	if (pReply == NULL)
+		return NULL;
+	gpointer pBuffer = NULL;
+	if (pReply->format == iFormat)
+	{
+		*iNbItems = xcb_get_property_value_length (pReply) / (iFormat / 8);
+		pBuffer = _copy_property_value (xcb_get_property_value (pReply), iFormat, *iNbItems);
+	}
+	free (pReply);
+	return pBuffer;
+}
+
+static void _send_requests (xcb_connection_t *c, CairoDockXWindowProps *pProps, CDXWindowCookies *pCookies)
+{
+	Window Xid = pProps->Xid;
+	if (pProps->iMask & CAIRO_DOCK_XPROP_STATE)
+		pCookies->state = _send_property_request (c, Xid, s_aNetWmState, XA_ATOM);
+	if (pProps->iMask & CAIRO_DOCK_XPROP_TYPE)
+	{
+		pCookies->type = _send_property_request (c, Xid, s_aNetWmWindowType, XA_ATOM);
+		pCookies->transient = _send_property_request (c, Xid, XA_WM_TRANSIENT_FOR, XA_WINDOW);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_NAME)
+	{
+		pCookies->net_name = _send_property_request (c, Xid, s_aNetWmName, s_aUtf8String);
+		pCookies->name = _send_property_request (c, Xid, s_aWmName, s_aString);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_CLASS)
+		pCookies->wm_class = _send_property_request (c, Xid, XA_WM_CLASS, XA_STRING);
+	if (pProps->iMask & CAIRO_DOCK_XPROP_DESKTOP)
+		pCookies->desktop = _send_property_request (c, Xid, s_aNetWmDesktop, XA_CARDINAL);
+	if (pProps->iMask & CAIRO_DOCK_XPROP_GEOMETRY)
+	{
+		pCookies->geometry = xcb_get_geometry (c, Xid);
+		pCookies->position = xcb_translate_coordinates (c, Xid, DefaultRootWindow (s_XDisplay), 0, 0);  // see cairo_dock_get_xwindow_geometry() for why we need it
+		pCookies->extents = _send_property_request (c, Xid, s_aNetFrameExtents, XA_CARDINAL);
+	}
+}
+
+static void _collect_replies (xcb_connection_t *c, CairoDockXWindowProps *pProps, CDXWindowCookies *pCookies)
+{
+	gulong iNbItems;
+	if (pProps->iMask & CAIRO_DOCK_XPROP_STATE)
+		pProps->pStates = _get_property_reply (c, pCookies->state, 32, &pProps->iNbStates);
+	if (pProps->iMask & CAIRO_DOCK_XPROP_TYPE)
+	{
+		pProps->pTypes = _get_property_reply (c, pCookies->type, 32, &pProps->iNbTypes);
+		gulong *pTransientFor = _get_property_reply (c, pCookies->transient, 32, &iNbItems);
+		pProps->iTransientFor = (iNbItems > 0 ? *pTransientFor : None);
+		g_free (pTransientFor);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_NAME)
+	{
+		pProps->cNetName = _get_property_reply (c, pCookies->net_name, 8, &iNbItems);
+		pProps->cName = _get_property_reply (c, pCookies->name, 8, &iNbItems);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_CLASS)
+	{
+		gchar *pClassBuffer = _get_property_reply (c, pCookies->wm_class, 8, &iNbItems);
+		_parse_wm_class (pProps, pClassBuffer, iNbItems);
+		g_free (pClassBuffer);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_DESKTOP)
+	{
+		gulong *pDesktop = _get_property_reply (c, pCookies->desktop, 32, &iNbItems);
+		pProps->iNumDesktop = (iNbItems > 0 ? (int)*pDesktop : 0);
+		g_free (pDesktop);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_GEOMETRY)
+	{
+		xcb_get_geometry_reply_t *pGeometry = xcb_get_geometry_reply (c, pCookies->geometry, NULL);
+		xcb_translate_coordinates_reply_t *pPosition = xcb_translate_coordinates_reply (c, pCookies->position, NULL);
+		gulong *pExtents = _get_property_reply (c, pCookies->extents, 32, &iNbItems);
+		_set_geometry (pProps,
+			pGeometry ? pGeometry->width : 0,
+			pGeometry ? pGeometry->height : 0,
+			pPosition ? pPosition->dst_x : 0,
+			pPosition ? pPosition->dst_y : 0,
+			pExtents, iNbItems);
+		free (pGeometry);
+		free (pPosition);
+		g_free (pExtents);
+	}
+}
+
+#else
+
+static gpointer _get_property (Window Xid, Atom aProperty, Atom aType, int iFormat, gulong *iNbItems)
 {
 	Atom aReturnedType = 0;
 	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements=0;
-	guchar *pNameBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmName, 0, G_MAXULONG, False, s_aUtf8String, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, &pNameBuffer);  // on cherche en priorite le nom en UTF8, car on est notifie des 2, mais il vaut mieux eviter le WM_NAME qui, ne l'etant pas, contient des caracteres bizarres qu'on ne peut pas convertir avec g_locale_to_utf8, puisque notre locale _est_ UTF8.
-	if (iBufferNbElements == 0 && bSearchWmName)
-		XGetWindowProperty (s_XDisplay, Xid, s_aWmName, 0, G_MAXULONG, False, s_aString, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, &pNameBuffer);
+	unsigned long iLeftBytes, iBufferNbElements = 0;
+	guchar *pXBuffer = NULL;
+	XGetWindowProperty (s_XDisplay, Xid, aProperty, 0, G_MAXULONG, False, aType, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, &pXBuffer);
+	gpointer pBuffer = NULL;
+	*iNbItems = 0;
+	if (aReturnedFormat == iFormat)
+	{
+		*iNbItems = iBufferNbElements;
+		pBuffer = _copy_property_value (pXBuffer, iFormat, iBufferNbElements);
+	}
+	if (pXBuffer)
+		XFree (pXBuffer);
+	return pBuffer;
+}
+
+static void _fetch_properties (CairoDockXWindowProps *pProps)  // one round-trip per property
+{
+	Window Xid = pProps->Xid;
+	gulong iNbItems;
+	if (pProps->iMask & CAIRO_DOCK_XPROP_STATE)
+		pProps->pStates = _get_property (Xid, s_aNetWmState, XA_ATOM, 32, &pProps->iNbStates);
+	if (pProps->iMask & CAIRO_DOCK_XPROP_TYPE)
+	{
+		pProps->pTypes = _get_property (Xid, s_aNetWmWindowType, XA_ATOM, 32, &pProps->iNbTypes);
+		XGetTransientForHint (s_XDisplay, Xid, &pProps->iTransientFor);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_NAME)
+	{
+		pProps->cNetName = _get_property (Xid, s_aNetWmName, s_aUtf8String, 8, &iNbItems);
+		pProps->cName = _get_property (Xid, s_aWmName, s_aString, 8, &iNbItems);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_CLASS)
+	{
+		gchar *pClassBuffer = _get_property (Xid, XA_WM_CLASS, XA_STRING, 8, &iNbItems);
+		_parse_wm_class (pProps, pClassBuffer, iNbItems);
+		g_free (pClassBuffer);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_DESKTOP)
+	{
+		gulong *pDesktop = _get_property (Xid, s_aNetWmDesktop, XA_CARDINAL, 32, &iNbItems);
+		pProps->iNumDesktop = (iNbItems > 0 ? (int)*pDesktop : 0);
+		g_free (pDesktop);
+	}
+	if (pProps->iMask & CAIRO_DOCK_XPROP_GEOMETRY)
+	{
+		int x=0, y=0, w=0, h=0;
+		cairo_dock_get_xwindow_geometry (Xid, &x, &y, &w, &h);
+		pProps->x = x;
+		pProps->y = y;
+		pProps->iWidth = w;
+		pProps->iHeight = h;
+	}
+}
+#endif
+
+CairoDockXWindowProps *cairo_dock_fetch_xwindows_properties (const Window *pXids, guint iNbWindows, guint iMask)
+{
+	CairoDockXWindowProps *pProps = g_new0 (CairoDockXWindowProps, iNbWindows);
+	guint i;
+	for (i = 0; i < iNbWindows; i ++)
+	{
+		pProps[i].Xid = pXids[i];
+		pProps[i].iMask = iMask;
+		pProps[i].iTransientFor = None;
+	}
 	
-	gchar *cName = NULL;
-	if (iBufferNbElements > 0)
+	#ifdef HAVE_X11_XCB
+	// send all the requests for all the windows first, and only then wait for the replies: the server answers them in a row, so we pay the latency of a single round-trip instead of one per property and per window.
+	xcb_connection_t *c = XGetXCBConnection (s_XDisplay);
+	CDXWindowCookies *pCookies = g_new0 (CDXWindowCookies, iNbWindows);
+	for (i = 0; i < iNbWindows; i ++)
+		_send_requests (c, &pProps[i], &pCookies[i]);
+	for (i = 0; i < iNbWindows; i ++)
+		_collect_replies (c, &pProps[i], &pCookies[i]);
+	g_free (pCookies);
+	#else
+	for (i = 0; i < iNbWindows; i ++)
+		_fetch_properties (&pProps[i]);
+	#endif
+	return pProps;
+}
+
+void cairo_dock_free_xwindows_properties (CairoDockXWindowProps *pProps, guint iNbWindows)
+{
+	if (pProps == NULL)
+		return;
+	guint i;
+	for (i = 0; i < iNbWindows; i ++)
 	{
-		cName = g_strdup ((gchar *)pNameBuffer);
-		XFree (pNameBuffer);
+		g_free (pProps[i].pStates);
+		g_free (pProps[i].pTypes);
+		g_free (pProps[i].cNetName);
+		g_free (pProps[i].cName);
+		g_free (pProps[i].cResClass);
+		g_free (pProps[i].cResName);
 	}
-	return cName;
+	g_free (pProps);
 }
 
-gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass, gchar **cWMName)
+gchar *cairo_dock_xwindow_props_get_name (const CairoDockXWindowProps *pProps, gboolean bSearchWmName)
+{
+	// on cherche en priorite le nom en UTF8, car on est notifie des 2, mais il vaut mieux eviter le WM_NAME qui, ne l'etant pas, contient des caracteres bizarres qu'on ne peut pas convertir avec g_locale_to_utf8, puisque notre locale _est_ UTF8.
+	if (pProps->cNetName != NULL)
+		return g_strdup (pProps->cNetName);
+	if (bSearchWmName && pProps->cName != NULL)
+		return g_strdup (pProps->cName);
+	return NULL;
+}
+
+gchar *cairo_dock_xwindow_props_get_class (const CairoDockXWindowProps *pProps, gchar **cWMClass, gchar **cWMName)
 {
-	XClassHint *pClassHint = XAllocClassHint ();
 	gchar *cClass = NULL;
-	if (XGetClassHint (s_XDisplay, Xid, pClassHint) != 0 && pClassHint->res_class)
+	if (pProps->cResClass)
 	{
-		cClass = gldi_window_parse_class(pClassHint->res_class, pClassHint->res_name);
+		cClass = gldi_window_parse_class(pProps->cResClass, pProps->cResName);
 		if (cClass)
 		{
-			if (cWMClass) *cWMClass = g_strdup (pClassHint->res_class);
-			if (pClassHint->res_name && cWMName) *cWMName = g_ascii_strdown (pClassHint->res_name, -1);
+			if (cWMClass) *cWMClass = g_strdup (pProps->cResClass);
+			if (pProps->cResName && cWMName) *cWMName = g_ascii_strdown (pProps->cResName, -1);
+		}
+	}
+	return cClass;
+}
+
+gboolean cairo_dock_xwindow_props_get_state (const CairoDockXWindowProps *pProps, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention, gboolean *bIsSticky)
+{
+	const gulong *pXStateBuffer = pProps->pStates;
+	gulong iBufferNbElements = pProps->iNbStates;
+	gboolean bValid = TRUE;
+	*bIsFullScreen = FALSE;
+	*bIsHidden = FALSE;
+	*bIsMaximized = FALSE;
+	if (bDemandsAttention != NULL)
+		*bDemandsAttention = FALSE;
+	if (bIsSticky != NULL)
+		*bIsSticky = FALSE;
+	if (iBufferNbElements > 0)
+	{
+		guint i, iNbMaximizedDimensions = 0;
+		for (i = 0; i < iBufferNbElements; i ++)
+		{
+			if (pXStateBuffer[i] == s_aNetWmFullScreen)
+			{
+				*bIsFullScreen = TRUE;
+			}
+			else if (pXStateBuffer[i] == s_aNetWmHidden)
+			{
+				*bIsHidden = TRUE;
+			}
+			else if (pXStateBuffer[i] == s_aNetWmMaximizedVert)
+			{
+				iNbMaximizedDimensions ++;
+				if (iNbMaximizedDimensions == 2)
+					*bIsMaximized = TRUE;
+			}
+			else if (pXStateBuffer[i] == s_aNetWmMaximizedHoriz)
+			{
+				iNbMaximizedDimensions ++;
+				if (iNbMaximizedDimensions == 2)
+					*bIsMaximized = TRUE;
+			}
+			else if (pXStateBuffer[i] == s_aNetWmDemandsAttention && bDemandsAttention != NULL)
+			{
+				*bDemandsAttention = TRUE;
+			}
+			else if (pXStateBuffer[i] == s_aNetWmSticky && bIsSticky != NULL)
+			{
+				*bIsSticky = TRUE;
+			}
+			
+			else if (pXStateBuffer[i] == s_aNetWmSkipTaskbar)
+			{
+				cd_debug ("this appli should not be in taskbar anymore");
+				bValid = FALSE;
+			}
+		}
+	}
+	return bValid;
+}
+
+gboolean cairo_dock_xwindow_props_get_type (const CairoDockXWindowProps *pProps, Window *pTransientFor)
+{
+	gboolean bKeep = FALSE;  // we only want to know if we can display this window in the dock or not, so a boolean is enough.
+	const gulong *pTypeBuffer = pProps->pTypes;
+	gulong iBufferNbElements = pProps->iNbTypes;
+	if (iBufferNbElements != 0)
+	{
+		guint i;
+		for (i = 0; i < iBufferNbElements; i ++)  // The Client SHOULD specify window types in order of preference (the first being most preferable) but MUST include at least one of the basic window type atoms.
+		{
+			if (pTypeBuffer[i] == s_aNetWmWindowTypeNormal)  // normal window -> take it
+			{
+				bKeep = TRUE;
+				break;
+			}
+			if (pTypeBuffer[i] == s_aNetWmWindowTypeDialog)  // dialog -> skip modal dialog, because we can't act on it independently from the parent window (it's most probably a dialog box like an open/save dialog)
+			{
+				*pTransientFor = pProps->iTransientFor;  // maybe we should also get the _NET_WM_STATE_MODAL property, although if a dialog is set modal but not transient, that would probably be an error from the application.
+				if (*pTransientFor == None)
+				{
+					bKeep = TRUE;
+					break;
+				}  // else it's a transient dialog, don't keep it, unless it also has the "normal" type further in the buffer.
+			}  // skip any other type (dock, menu, etc)
+			else if (pTypeBuffer[i] == s_aNetWmWindowTypeDock)  // workaround for the Unity-panel: if the type 'dock' is present, don't look further (as they add the 'normal' type too, which is non-sense).
+			{
+				break;
+			}
 		}
-		XFree (pClassHint->res_name);
-		XFree (pClassHint->res_class);
-		XFree (pClassHint);
 	}
+	else  // no type, take it by default, unless it's transient.
+	{
+		*pTransientFor = pProps->iTransientFor;
+		bKeep = (*pTransientFor == None);
+	}
+	return bKeep;
+}
+
+gchar *cairo_dock_get_xwindow_name (Window Xid, gboolean bSearchWmName)
+{
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (&Xid, 1, CAIRO_DOCK_XPROP_NAME);
+	gchar *cName = cairo_dock_xwindow_props_get_name (pProps, bSearchWmName);
+	cairo_dock_free_xwindows_properties (pProps, 1);
+	return cName;
+}
+
+gchar *cairo_dock_get_xwindow_class (Window Xid, gchar **cWMClass, gchar **cWMName)
+{
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (&Xid, 1, CAIRO_DOCK_XPROP_CLASS);
+	gchar *cClass = cairo_dock_xwindow_props_get_class (pProps, cWMClass, cWMName);
+	cairo_dock_free_xwindows_properties (pProps, 1);
 	return cClass;
 }
 
@@ -1113,64 +1479,9 @@ void cairo_dock_xwindow_is_above_or_below (Window Xid, gboolean *bIsAbove, gbool
 gboolean cairo_dock_xwindow_is_fullscreen_or_hidden_or_maximized (Window Xid, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention, gboolean *bIsSticky)
 {
 	g_return_val_if_fail (Xid > 0, FALSE);
-	//cd_debug ("%s (%d)", __func__, Xid);
-	Atom aReturnedType = 0;
-	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements = 0;
-	gulong *pXStateBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmState, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pXStateBuffer);
-	
-	gboolean bValid = TRUE;
-	*bIsFullScreen = FALSE;
-	*bIsHidden = FALSE;
-	*bIsMaximized = FALSE;
-	if (bDemandsAttention != NULL)
-		*bDemandsAttention = FALSE;
-	if (bIsSticky != NULL)
-		*bIsSticky = FALSE;
-	if (iBufferNbElements > 0)
-	{
-		guint i, iNbMaximizedDimensions = 0;
-		for (i = 0; i < iBufferNbElements; i ++)
-		{
-			if (pXStateBuffer[i] == s_aNetWmFullScreen)
-			{
-				*bIsFullScreen = TRUE;
-			}
-			else if (pXStateBuffer[i] == s_aNetWmHidden)
-			{
-				*bIsHidden = TRUE;
-			}
-			else if (pXStateBuffer[i] == s_aNetWmMaximizedVert)
-			{
-				iNbMaximizedDimensions ++;
-				if (iNbMaximizedDimensions == 2)
-					*bIsMaximized = TRUE;
-			}
-			else if (pXStateBuffer[i] == s_aNetWmMaximizedHoriz)
-			{
-				iNbMaximizedDimensions ++;
-				if (iNbMaximizedDimensions == 2)
-					*bIsMaximized = TRUE;
-			}
-			else if (pXStateBuffer[i] == s_aNetWmDemandsAttention && bDemandsAttention != NULL)
-			{
-				*bDemandsAttention = TRUE;
-			}
-			else if (pXStateBuffer[i] == s_aNetWmSticky && bIsSticky != NULL)
-			{
-				*bIsSticky = TRUE;
-			}
-			
-			else if (pXStateBuffer[i] == s_aNetWmSkipTaskbar)
-			{
-				cd_debug ("this appli should not be in taskbar anymore");
-				bValid = FALSE;
-			}
-		}
-	}
-	
-	XFree (pXStateBuffer);
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (&Xid, 1, CAIRO_DOCK_XPROP_STATE);
+	gboolean bValid = cairo_dock_xwindow_props_get_state (pProps, bIsFullScreen, bIsHidden, bIsMaximized, bDemandsAttention, bIsSticky);
+	cairo_dock_free_xwindows_properties (pProps, 1);
 	return bValid;
 }
 
@@ -1217,18 +1528,9 @@ void cairo_dock_xwindow_can_minimize_maximized_close (Window Xid, gboolean *bCan
 
 int cairo_dock_get_xwindow_desktop (Window Xid)
 {
-	int iDesktopNumber;
-	gulong iLeftBytes, iBufferNbElements = 0;
-	Atom aReturnedType = 0;
-	int aReturnedFormat = 0;
-	gulong *pBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmDesktop, 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pBuffer);
-	if (iBufferNbElements > 0)
-		iDesktopNumber = *pBuffer;
-	else
-		iDesktopNumber = 0;
-	
-	XFree (pBuffer);
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (&Xid, 1, CAIRO_DOCK_XPROP_DESKTOP);
+	int iDesktopNumber = pProps->iNumDesktop;
+	cairo_dock_free_xwindows_properties (pProps, 1);
 	return iDesktopNumber;
 }
 
@@ -1262,7 +1564,7 @@ void cairo_dock_get_xwindow_geometry (Window Xid, int *iLocalPositionX, int *iLo
 	Atom aReturnedType = 0;
 	int aReturnedFormat = 0;
 	gulong *pBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, XInternAtom (s_XDisplay, "_NET_FRAME_EXTENTS", False), 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pBuffer);
+	XGetWindowProperty (s_XDisplay, Xid, s_aNetFrameExtents, 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pBuffer);
 	if (iBufferNbElements > 3)
 	{
 		left=pBuffer[0], right=pBuffer[1], top=pBuffer[2], bottom=pBuffer[3];
@@ -1305,6 +1607,36 @@ Window cairo_dock_get_active_xwindow (void)
 
 
 
+// last surface built from the _NET_WM_ICON of each window, so that the property is not converted again when it changes without changing its content (which some applications do often), or when the icon is reloaded at the same size.
+typedef struct {
+	guint iHash;  // hash of the content of the property
+	gulong iBufferNbElements;
+	gint iWidth, iHeight;
+	cairo_surface_t *pSurface;
+	} CDXIconCacheEntry;
+static GHashTable *s_hXIconCache = NULL;  // Xid -> CDXIconCacheEntry
+
+static void _free_xicon_cache_entry (CDXIconCacheEntry *pEntry)
+{
+	cairo_surface_destroy (pEntry->pSurface);
+	g_free (pEntry);
+}
+
+static guint _hash_xicon_buffer (const gulong *pXIconBuffer, gulong iBufferNbElements)
+{
+	guint h = 2166136261u;  // FNV-1a, on the 32 bits of data of each element
+	gulong i;
+	for (i = 0; i < iBufferNbElements; i ++)
+		h = (h ^ (guint32)pXIconBuffer[i]) * 16777619u;
+	return h;
+}
+
+void cairo_dock_forget_xwindow_icon (Window Xid)
+{
+	if (s_hXIconCache != NULL)
+		g_hash_table_remove (s_hXIconCache, GUINT_TO_POINTER (Xid));
+}
+
 cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth, int iHeight)
 {
 	Atom aReturnedType = 0;
@@ -1315,11 +1647,37 @@ cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth,
 
 	if (iBufferNbElements > 2)
 	{
+		if (s_hXIconCache == NULL)
+			s_hXIconCache = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)_free_xicon_cache_entry);
+		
+		// if the icon has already been built from the same data, just copy it (the caller owns the surface and may draw on it).
+		guint iHash = _hash_xicon_buffer (pXIconBuffer, iBufferNbElements);
+		CDXIconCacheEntry *pEntry = g_hash_table_lookup (s_hXIconCache, GUINT_TO_POINTER (Xid));
+		if (pEntry && pEntry->iHash == iHash && pEntry->iBufferNbElements == iBufferNbElements
+		&& pEntry->iWidth == iWidth && pEntry->iHeight == iHeight)
+		{
+			XFree (pXIconBuffer);
+			return cairo_dock_duplicate_surface (pEntry->pSurface, iWidth, iHeight, iWidth, iHeight);
+		}
+		
 		cairo_surface_t *pNewSurface = cairo_dock_create_surface_from_xicon_buffer (pXIconBuffer,
 			iBufferNbElements,
 			iWidth,
 			iHeight);
 		XFree (pXIconBuffer);
+		
+		if (pNewSurface != NULL)
+		{
+			pEntry = g_new0 (CDXIconCacheEntry, 1);
+			pEntry->iHash = iHash;
+			pEntry->iBufferNbElements = iBufferNbElements;
+			pEntry->iWidth = iWidth;
+			pEntry->iHeight = iHeight;
+			pEntry->pSurface = cairo_dock_duplicate_surface (pNewSurface, iWidth, iHeight, iWidth, iHeight);
+			g_hash_table_insert (s_hXIconCache, GUINT_TO_POINTER (Xid), pEntry);
+		}
+		else
+			cairo_dock_forget_xwindow_icon (Xid);
 		return pNewSurface;
 	}
 	else  // sinon on tente avec l'icone eventuellement presente dans les WMHints.
@@ -1579,43 +1937,9 @@ GLuint cairo_dock_texture_from_pixmap (Window Xid, Pixmap iBackingPixmap)
 
 gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor)
 {
-	gboolean bKeep = FALSE;  // we only want to know if we can display this window in the dock or not, so a boolean is enough.
-	Atom aReturnedType = 0;
-	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements;
-	gulong *pTypeBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmWindowType, 0, G_MAXULONG, False, XA_ATOM, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pTypeBuffer);
-	if (iBufferNbElements != 0)
-	{
-		guint i;
-		for (i = 0; i < iBufferNbElements; i ++)  // The Client SHOULD specify window types in order of preference (the first being most preferable) but MUST include at least one of the basic window type atoms.
-		{
-			if (pTypeBuffer[i] == s_aNetWmWindowTypeNormal)  // normal window -> take it
-			{
-				bKeep = TRUE;
-				break;
-			}
-			if (pTypeBuffer[i] == s_aNetWmWindowTypeDialog)  // dialog -> skip modal dialog, because we can't act on it independently from the parent window (it's most probably a dialog box like an open/save dialog)
-			{
-				XGetTransientForHint (s_XDisplay, Xid, pTransientFor);  // maybe we should also get the _NET_WM_STATE_MODAL property, although if a dialog is set modal but not transient, that would probably be an error from the application.
-				if (*pTransientFor == None)
-				{
-					bKeep = TRUE;
-					break;
-				}  // else it's a transient dialog, don't keep it, unless it also has the "normal" type further in the buffer.
-			}  // skip any other type (dock, menu, etc)
-			else if (pTypeBuffer[i] == s_aNetWmWindowTypeDock)  // workaround for the Unity-panel: if the type 'dock' is present, don't look further (as they add the 'normal' type too, which is non-sense).
-			{
-				break;
-			}
-		}
-		XFree (pTypeBuffer);
-	}
-	else  // no type, take it by default, unless it's transient.
-	{
-		XGetTransientForHint (s_XDisplay, Xid, pTransientFor);
-		bKeep = (*pTransientFor == None);
-	}
+	CairoDockXWindowProps *pProps = cairo_dock_fetch_xwindows_properties (&Xid, 1, CAIRO_DOCK_XPROP_TYPE);
+	gboolean bKeep = cairo_dock_xwindow_props_get_type (pProps, pTransientFor);
+	cairo_dock_free_xwindows_properties (pProps, 1);
 	return bKeep;
 }
 
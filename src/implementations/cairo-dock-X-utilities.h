@@ -127,6 +127,8 @@ Window cairo_dock_get_active_xwindow (void);
 
 
 cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth, int iHeight);
+/// Forget the icon of a window that has been kept by cairo_dock_create_surface_from_xwindow; to be called when the window is destroyed.
+void cairo_dock_forget_xwindow_icon (Window Xid);
 
 cairo_surface_t *cairo_dock_create_surface_from_xpixmap (Pixmap Xid, int iWidth, int iHeight);
 
@@ -135,6 +137,51 @@ GLuint cairo_dock_texture_from_pixmap (Window Xid, Pixmap iBackingPixmap);
 
 gboolean cairo_dock_get_xwindow_type (Window Xid, Window *pTransientFor);
 
+// BATCH //
+/* Properties that can be fetched together with cairo_dock_fetch_xwindows_properties.
+ */
+typedef enum {
+	CAIRO_DOCK_XPROP_STATE    = 1 << 0,  // _NET_WM_STATE
+	CAIRO_DOCK_XPROP_TYPE     = 1 << 1,  // _NET_WM_WINDOW_TYPE and WM_TRANSIENT_FOR
+	CAIRO_DOCK_XPROP_NAME     = 1 << 2,  // _NET_WM_NAME and WM_NAME
+	CAIRO_DOCK_XPROP_CLASS    = 1 << 3,  // WM_CLASS
+	CAIRO_DOCK_XPROP_DESKTOP  = 1 << 4,  // _NET_WM_DESKTOP
+	CAIRO_DOCK_XPROP_GEOMETRY = 1 << 5,  // size, position on the root window and _NET_FRAME_EXTENTS
+	CAIRO_DOCK_XPROP_ALL      = (1 << 6) - 1
+	} CairoDockXPropMask;
+
+/* Raw properties of a window; use the cairo_dock_xwindow_props_get_* functions to interpret them.
+ */
+typedef struct _CairoDockXWindowProps {
+	Window Xid;
+	guint iMask;  // the CairoDockXPropMask that was fetched
+	gulong *pStates;
+	gulong iNbStates;
+	gulong *pTypes;
+	gulong iNbTypes;
+	Window iTransientFor;
+	gchar *cNetName;
+	gchar *cName;
+	gchar *cResClass;
+	gchar *cResName;
+	gint iNumDesktop;
+	gint x, y, iWidth, iHeight;  // same as cairo_dock_get_xwindow_geometry
+	} CairoDockXWindowProps;
+
+/* Get some properties of several windows at once. When XCB is available, all the requests are sent before any reply is read, so that it costs a single round-trip to the X server whatever the number of windows and properties.
+ *@param pXids the windows
+ *@param iNbWindows number of windows
+ *@param iMask a combination of CairoDockXPropMask
+ *@return an array of iNbWindows properties, in the same order as pXids. Free it with cairo_dock_free_xwindows_properties.
+ */
+CairoDockXWindowProps *cairo_dock_fetch_xwindows_properties (const Window *pXids, guint iNbWindows, guint iMask);
+void cairo_dock_free_xwindows_properties (CairoDockXWindowProps *pProps, guint iNbWindows);
+
+gchar *cairo_dock_xwindow_props_get_name (const CairoDockXWindowProps *pProps, gboolean bSearchWmName);
+gchar *cairo_dock_xwindow_props_get_class (const CairoDockXWindowProps *pProps, gchar **cWMClass, gchar **cWMName);
+gboolean cairo_dock_xwindow_props_get_state (const CairoDockXWindowProps *pProps, gboolean *bIsFullScreen, gboolean *bIsHidden, gboolean *bIsMaximized, gboolean *bDemandsAttention, gboolean *bIsSticky);
+gboolean cairo_dock_xwindow_props_get_type (const CairoDockXWindowProps *pProps, Window *pTransientFor);
+
 gboolean cairo_dock_xcomposite_is_available (void);
 
 
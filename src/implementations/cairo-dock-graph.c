@@ -42,40 +42,135 @@ typedef struct _Graph {
 	GLuint iBackgroundTexture;
 	gint iMargin;
 	gboolean bMixGraphs;
+	cairo_surface_t *pRasterSurface;  // the curves alone, scrolled by one column at each new value.
+	gint iRasterIndex;  // index of the last value drawn on the raster, -1 to redraw it entirely.
+	guint iRasterNbPushedValues;  // number of values pushed in the history when the raster was drawn.
+	gint iRasterMemorySize;  // size of the history when the raster was drawn.
+	gdouble *pRasterMinMaxValues;  // range of the values when the raster was drawn.
 	} Graph;
 
 
 extern gboolean g_bUseOpenGL;
 
 
-static void render (Graph *pGraph, cairo_t *pCairoContext)
+static inline int _get_nb_drawn_values (Graph *pGraph)
 {
-	g_return_if_fail (pGraph != NULL);
-	g_return_if_fail (pCairoContext != NULL && cairo_status (pCairoContext) == CAIRO_STATUS_SUCCESS);
-	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
 	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
-	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
-	
-	if (pGraph->pBackgroundSurface != NULL)
+	return MIN (pData->iMemorySize, pRenderer->iWidth - 2*pGraph->iMargin);
+}
+
+// draw the values from tFirst to tLast steps back in time of the i-th graph; the circles are always drawn entirely.
+static void _draw_values (Graph *pGraph, cairo_t *pCairoContext, int i, int iWidth, int iHeight, double fHeight, int n, int tFirst, int tLast)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int iMargin = pGraph->iMargin;
+	double fValue;
+	int t;
+	switch (pGraph->iType)
 	{
-		cairo_set_source_surface (pCairoContext, pGraph->pBackgroundSurface, 0., 0.);
-		cairo_paint (pCairoContext);
+		case CAIRO_DOCK_GRAPH_LINE:
+		case CAIRO_DOCK_GRAPH_PLAIN:
+		default :
+			cairo_set_line_width (pCairoContext, 1);
+			cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
+			for (t = tFirst; t <= tLast; t ++)
+			{
+				fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
+				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+					fValue = 0;
+				cairo_line_to (pCairoContext,
+					iWidth - t - .5,
+					(1 - fValue) * (iHeight - 1) + .5); // - .5 to align line draw on pixel and + 1 px down because size is reduced
+			}
+			if (pGraph->iType == CAIRO_DOCK_GRAPH_PLAIN)
+			{
+				cairo_line_to (pCairoContext,
+					tLast == n - 1 ? .5 : iWidth - tLast - .5, // - .5 to align line draw on pixel and + 1 to align with last value position
+					iHeight - .5); // - .5 to align next line draw on pixel
+				cairo_line_to (pCairoContext,
+					iWidth - tFirst - .5,
+					iHeight - .5);
+				cairo_close_path (pCairoContext);
+				cairo_fill_preserve (pCairoContext);
+			}
+			cairo_stroke (pCairoContext);
+		break;
+		
+		case CAIRO_DOCK_GRAPH_BAR:
+		{
+			cairo_set_line_width (pCairoContext, 1);
+			for (t = tFirst; t <= tLast; t ++)
+			{
+				fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
+				if (fValue > CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> no draw
+				{
+					cairo_move_to (pCairoContext,
+						iWidth - t - .5, // - .5 to align line draw on pixel
+						iHeight);
+					cairo_rel_line_to (pCairoContext,
+						0.,
+						- fValue * iHeight);
+					cairo_stroke (pCairoContext);
+				}
+			}
+		}
+		break;
+		
+		case CAIRO_DOCK_GRAPH_CIRCLE:
+		case CAIRO_DOCK_GRAPH_CIRCLE_PLAIN:
+			cairo_set_line_width (pCairoContext, 1);
+			cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
+			fValue = cairo_data_renderer_get_normalized_current_value (pRenderer, i);
+			if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+				fValue = 0;
+			double angle, radius = MIN (iWidth, fHeight)/2;
+			angle = -2*G_PI*(-.5/pData->iMemorySize);
+			cairo_move_to (pCairoContext,
+				iMargin + iWidth/2 + radius * (fValue * cos (angle)),
+				iMargin + fHeight/2 + radius * (fValue * sin (angle)));
+			angle = -2*G_PI*(.5/pData->iMemorySize);
+			cairo_line_to (pCairoContext,
+				iMargin + iWidth/2 + radius * (fValue * cos (angle)),
+				iMargin + fHeight/2 + radius * (fValue * sin (angle)));
+			for (t = 1; t < n; t ++)
+			{
+				fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
+				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+					fValue = 0;
+				angle = -2*G_PI*((t-.5)/n);
+				cairo_line_to (pCairoContext,
+					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
+					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
+				angle = -2*G_PI*((t+.5)/n);
+				cairo_line_to (pCairoContext,
+					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
+					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
+			}
+			if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+			{
+				cairo_close_path (pCairoContext);
+				cairo_fill_preserve (pCairoContext);
+			}
+			cairo_stroke (pCairoContext);
+		break;
 	}
+}
 
-	g_return_if_fail (pRenderer->iRank != 0); // workaround: FIXME
+static void _draw_graphs (Graph *pGraph, cairo_t *pCairoContext, int tFirst, int tLast)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
 	int iNbDrawings = iNbValues / pRenderer->iRank;
-	if (iNbDrawings == 0)
-		return;
 	
 	int iMargin = pGraph->iMargin;
 	int iWidth = pRenderer->iWidth - 2*iMargin;
 	double fHeight = pRenderer->iHeight - 2*iMargin;
 	fHeight /= iNbDrawings;
+	int n = _get_nb_drawn_values (pGraph);  // for iteration over the memorized values.
 	
-	double fValue;
 	cairo_pattern_t *pGradationPattern;
-	int t, n = MIN (pData->iMemorySize, iWidth);  // for iteration over the memorized values.
 	int i, iCurrentGraph, iGraphTop, iGraphBottom, iHeight = 0;
 	for (i = 0; i < iNbValues; i ++)
 	{
@@ -106,102 +201,142 @@ static void render (Graph *pGraph, cairo_t *pCairoContext)
 				pGraph->fLowColor[3*i+1],
 				pGraph->fLowColor[3*i+2]);
 		
-		switch (pGraph->iType)
+		_draw_values (pGraph, pCairoContext, i, iWidth, iHeight, fHeight, n, tFirst, tLast);
+		
+		cairo_restore (pCairoContext);
+	}
+}
+
+// clear the columns [x, x+w[ of the graphs on the raster, and redraw the values from tFirst to tLast there.
+static void _redraw_raster_columns (Graph *pGraph, cairo_t *ctx, int x, int w, int tFirst, int tLast)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	cairo_save (ctx);
+	cairo_rectangle (ctx, pGraph->iMargin + x, 0., w, pRenderer->iHeight);
+	cairo_clip (ctx);
+	cairo_set_operator (ctx, CAIRO_OPERATOR_CLEAR);
+	cairo_paint (ctx);
+	cairo_set_operator (ctx, CAIRO_OPERATOR_OVER);
+	_draw_graphs (pGraph, ctx, tFirst, tLast);
+	cairo_restore (ctx);
+}
+
+static void _update_raster (Graph *pGraph, cairo_t *pCairoContext)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	int iMargin = pGraph->iMargin;
+	int iWidth = pRenderer->iWidth - 2*iMargin;
+	int n = _get_nb_drawn_values (pGraph);
+	
+	//\_______________ the raster has the scale of the surface we draw on, so that the curves stay sharp.
+	double fScaleX = 1., fScaleY = 1.;
+	cairo_surface_get_device_scale (cairo_get_target (pCairoContext), &fScaleX, &fScaleY);
+	if (pGraph->pRasterSurface != NULL)
+	{
+		double fRasterScaleX, fRasterScaleY;
+		cairo_surface_get_device_scale (pGraph->pRasterSurface, &fRasterScaleX, &fRasterScaleY);
+		if (fRasterScaleX != fScaleX || fRasterScaleY != fScaleY)
 		{
-			case CAIRO_DOCK_GRAPH_LINE:
-			case CAIRO_DOCK_GRAPH_PLAIN:
-			default :
-				cairo_set_line_width (pCairoContext, 1);
-				cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
-				fValue = cairo_data_renderer_get_normalized_current_value (pRenderer, i);
-				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-					fValue = 0;
-				cairo_move_to (pCairoContext,
-					iWidth - .5,
-					(1 - fValue) * (iHeight - 1) + .5) ; // - .5 to align line draw on pixel and + 1 px down because size is reduced
-				for (t = 1; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-						fValue = 0;
-					cairo_line_to (pCairoContext,
-						iWidth - t - .5,
-						(1 - fValue) * (iHeight - 1) + .5); // - .5 to align line draw on pixel and + 1 px down because size is reduced
-				}
-				if (pGraph->iType == CAIRO_DOCK_GRAPH_PLAIN)
-				{
-					cairo_line_to (pCairoContext,
-						.5, // - .5 to align line draw on pixel and + 1 to align with last value position
-						iHeight - .5); // - .5 to align next line draw on pixel
-					cairo_rel_line_to (pCairoContext,
-						iWidth - 1,
-						0.);
-					cairo_close_path (pCairoContext);
-					cairo_fill_preserve (pCairoContext);
-				}
-				cairo_stroke (pCairoContext);
-			break;
-			
-			case CAIRO_DOCK_GRAPH_BAR:
-			{
-				cairo_set_line_width (pCairoContext, 1);
-				for (t = 0; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue > CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> no draw
-					{
-						cairo_move_to (pCairoContext,
-							iWidth - t - .5, // - .5 to align line draw on pixel
-							iHeight);
-						cairo_rel_line_to (pCairoContext,
-							0.,
-							- fValue * iHeight);
-						cairo_stroke (pCairoContext);
-					}
-				}
-			}
-			break;
-			
-			case CAIRO_DOCK_GRAPH_CIRCLE:
-			case CAIRO_DOCK_GRAPH_CIRCLE_PLAIN:
-				cairo_set_line_width (pCairoContext, 1);
-				cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
-				fValue = cairo_data_renderer_get_normalized_current_value (pRenderer, i);
-				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-					fValue = 0;
-				double angle, radius = MIN (iWidth, fHeight)/2;
-				angle = -2*G_PI*(-.5/pData->iMemorySize);
-				cairo_move_to (pCairoContext,
-					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				angle = -2*G_PI*(.5/pData->iMemorySize);
-				cairo_line_to (pCairoContext,
-					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				for (t = 1; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-						fValue = 0;
-					angle = -2*G_PI*((t-.5)/n);
-					cairo_line_to (pCairoContext,
-						iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-						iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-					angle = -2*G_PI*((t+.5)/n);
-					cairo_line_to (pCairoContext,
-						iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-						iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				}
-				if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
-				{
-					cairo_close_path (pCairoContext);
-					cairo_fill_preserve (pCairoContext);
-				}
-				cairo_stroke (pCairoContext);
-			break;
+			cairo_surface_destroy (pGraph->pRasterSurface);
+			pGraph->pRasterSurface = NULL;
 		}
-		cairo_restore (pCairoContext);
+	}
+	if (pGraph->pRasterSurface == NULL)
+	{
+		pGraph->pRasterSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+			ceil (pRenderer->iWidth * fScaleX),
+			ceil (pRenderer->iHeight * fScaleY));
+		cairo_surface_set_device_scale (pGraph->pRasterSurface, fScaleX, fScaleY);
+		pGraph->iRasterIndex = -1;
+	}
+	
+	//\_______________ see what changed since the raster was drawn.
+	if (pData->iMemorySize != pGraph->iRasterMemorySize
+	|| memcmp (pData->pMinMaxValues, pGraph->pRasterMinMaxValues, 2 * iNbValues * sizeof (gdouble)) != 0)  // the values are not normalized the same way any more.
+		pGraph->iRasterIndex = -1;
+	guint iNbNewValues = pData->iNbPushedValues - pGraph->iRasterNbPushedValues;  // the ring index alone can't tell 0 from iMemorySize new values.
+	if (pGraph->iRasterIndex != -1 && iNbNewValues == 0)  // no new value since last time.
+		return;
+	int iShift = fScaleX;  // in pixels.
+	gboolean bScroll = (pGraph->iRasterIndex != -1
+		&& iNbNewValues == 1  // exactly one new value.
+		&& n == iWidth  // the oldest value is on the left border, so it just goes out of the graph.
+		&& n > 4
+		&& iShift == fScaleX);
+	
+	cairo_t *ctx = cairo_create (pGraph->pRasterSurface);
+	if (bScroll)
+	{
+		//\_______________ scroll the graphs by one column to the left.
+		cairo_surface_flush (pGraph->pRasterSurface);
+		guchar *pPixels = cairo_image_surface_get_data (pGraph->pRasterSurface);
+		int iStride = cairo_image_surface_get_stride (pGraph->pRasterSurface);
+		int iNbRows = cairo_image_surface_get_height (pGraph->pRasterSurface);
+		guchar *pGraphRow = pPixels + iMargin * iShift * 4;
+		int y;
+		for (y = 0; y < iNbRows; y ++, pGraphRow += iStride)
+		{
+			memmove (pGraphRow, pGraphRow + iShift * 4, (iWidth - 1) * iShift * 4);
+		}
+		cairo_surface_mark_dirty (pGraph->pRasterSurface);
 		
+		//\_______________ draw the new value on the right border; a stroke is 1 pixel large, so the previous column and the previous values are redrawn too.
+		_redraw_raster_columns (pGraph, ctx, iWidth - 2, 2, 0, 3);
+		
+		//\_______________ the curves end on the left border, so redraw it without the value that just went out.
+		if (pGraph->iType != CAIRO_DOCK_GRAPH_BAR)
+			_redraw_raster_columns (pGraph, ctx, 0, 2, n - 4, n - 1);
+	}
+	else  // redraw everything.
+	{
+		cairo_set_operator (ctx, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (ctx);
+		cairo_set_operator (ctx, CAIRO_OPERATOR_OVER);
+		_draw_graphs (pGraph, ctx, 0, n - 1);
+	}
+	cairo_destroy (ctx);
+	
+	pGraph->iRasterIndex = pData->iCurrentIndex;
+	pGraph->iRasterNbPushedValues = pData->iNbPushedValues;
+	pGraph->iRasterMemorySize = pData->iMemorySize;
+	memcpy (pGraph->pRasterMinMaxValues, pData->pMinMaxValues, 2 * iNbValues * sizeof (gdouble));
+}
+
+static void render (Graph *pGraph, cairo_t *pCairoContext)
+{
+	g_return_if_fail (pGraph != NULL);
+	g_return_if_fail (pCairoContext != NULL && cairo_status (pCairoContext) == CAIRO_STATUS_SUCCESS);
+	
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	
+	if (pGraph->pBackgroundSurface != NULL)
+	{
+		cairo_set_source_surface (pCairoContext, pGraph->pBackgroundSurface, 0., 0.);
+		cairo_paint (pCairoContext);
+	}
+
+	g_return_if_fail (pRenderer->iRank != 0); // workaround: FIXME
+	int iNbDrawings = iNbValues / pRenderer->iRank;
+	if (iNbDrawings == 0)
+		return;
+	
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE || pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)  // circles turn rather than scroll, so they are redrawn entirely each time.
+	{
+		_draw_graphs (pGraph, pCairoContext, 0, _get_nb_drawn_values (pGraph) - 1);
+	}
+	else  // the other graphs are kept on a raster, where only the new value is drawn.
+	{
+		_update_raster (pGraph, pCairoContext);
+		cairo_set_source_surface (pCairoContext, pGraph->pRasterSurface, 0., 0.);
+		cairo_paint (pCairoContext);
+	}
+	
+	int i;
+	for (i = 0; i < iNbValues; i ++)
+	{
 		cairo_dock_render_overlays_to_context (pRenderer, i, pCairoContext);
 	}
 }
@@ -446,6 +581,8 @@ static void load (Graph *pGraph, G_GNUC_UNUSED Icon *pIcon, CairoGraphAttribute
 
 	pGraph->fHighColor = g_new0 (double, 3 * iNbValues);
 	pGraph->fLowColor = g_new0 (double, 3 * iNbValues);
+	pGraph->pRasterMinMaxValues = g_new0 (double, 2 * iNbValues);
+	pGraph->iRasterIndex = -1;
 
 	int i;
 	pGraph->pGradationPatterns = g_new (cairo_pattern_t *, iNbValues);
@@ -494,6 +631,11 @@ static void reload (Graph *pGraph)
 		pGraph->iBackgroundTexture = cairo_dock_create_texture_from_surface (pGraph->pBackgroundSurface);
 	else
 		pGraph->iBackgroundTexture = 0;
+	if (pGraph->pRasterSurface != NULL)  // will be re-created at the new size on the next drawing.
+	{
+		cairo_surface_destroy (pGraph->pRasterSurface);
+		pGraph->pRasterSurface = NULL;
+	}
 	int i;
 	for (i = 0; i < iNbValues; i ++)
 	{
@@ -516,6 +658,8 @@ static void unload (Graph *pGraph)
 		cairo_surface_destroy (pGraph->pBackgroundSurface);
 	if (pGraph->iBackgroundTexture != 0)
 		_cairo_dock_delete_texture (pGraph->iBackgroundTexture);
+	if (pGraph->pRasterSurface != NULL)
+		cairo_surface_destroy (pGraph->pRasterSurface);
 	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
@@ -529,6 +673,7 @@ static void unload (Graph *pGraph)
 	g_free (pGraph->pGradationPatterns);
 	g_free (pGraph->fHighColor);
 	g_free (pGraph->fLowColor);
+	g_free (pGraph->pRasterMinMaxValues);
 }
 
 
@@ -0,0 +1,116 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Measures the drawing of a graph with the Cairo backend, without any display:
+// each frame either gets one new value (the raster of the graph is scrolled) or two (the raster is redrawn entirely).
+// Usage: bench-data-renderer [nb of frames]
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cairo.h>
+#include <glib.h>
+
+#include "cairo-dock-log.h"
+#include "cairo-dock-manager.h"  // gldi_register_managers_manager, gldi_managers_init
+#include "cairo-dock-data-renderer-manager.h"  // gldi_register_data_renderers_manager
+#include "cairo-dock-data-renderer.h"
+#include "cairo-dock-graph.h"
+
+#define BENCH_NB_VALUES 2
+
+// time per frame, in us.
+static double _run (CairoDockTypeGraph iType, int iSize, int iNbValuesPerFrame, int iNbFrames)
+{
+	gdouble fHighColor[3] = {1., 0., 0.}, fLowColor[3] = {0., 1., 0.};
+	CairoGraphAttribute attr;
+	memset (&attr, 0, sizeof (CairoGraphAttribute));
+	attr.rendererAttribute.cModelName = "graph";
+	attr.rendererAttribute.iNbValues = BENCH_NB_VALUES;
+	attr.rendererAttribute.iMemorySize = iSize;  // as the applets do, one value per pixel.
+	attr.iType = iType;
+	attr.fHighColor = fHighColor;
+	attr.fLowColor = fLowColor;
+	attr.fBackGroundColor[3] = .5;
+	CairoDataRenderer *pRenderer = cairo_dock_new_unbound_data_renderer (CAIRO_DATA_RENDERER_ATTRIBUTE (&attr), iSize, iSize);
+	g_return_val_if_fail (pRenderer != NULL, 0.);
+	
+	cairo_surface_t *pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, iSize, iSize);
+	cairo_t *pCairoContext = cairo_create (pSurface);
+	
+	gdouble fValues[BENCH_NB_VALUES];
+	gint64 t0 = 0;
+	int t = 0, f, i, j;
+	for (f = -iSize; f < iNbFrames; f ++)  // fill the history first.
+	{
+		if (f == 0)  // start measuring.
+			t0 = g_get_monotonic_time ();
+		for (j = 0; j < iNbValuesPerFrame; j ++, t ++)
+		{
+			for (i = 0; i < BENCH_NB_VALUES; i ++)
+				fValues[i] = .5 + .45 * sin (.1 * t + i);
+			cairo_dock_push_new_data (pRenderer, fValues);
+		}
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (pCairoContext);
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_OVER);
+		pRenderer->interface.render (pRenderer, pCairoContext);
+	}
+	cairo_surface_flush (pSurface);
+	gint64 t1 = g_get_monotonic_time ();
+	
+	cairo_destroy (pCairoContext);
+	cairo_surface_destroy (pSurface);
+	cairo_dock_free_data_renderer (pRenderer);
+	return (double)(t1 - t0) / iNbFrames;
+}
+
+int main (int argc, char **argv)
+{
+	int iNbFrames = (argc > 1 ? atoi (argv[1]) : 2000);
+	if (iNbFrames <= 0)
+		iNbFrames = 1;
+	
+	cd_log_init (FALSE);
+	gldi_register_managers_manager ();
+	gldi_register_data_renderers_manager ();
+	gldi_managers_init ();
+	cairo_dock_register_built_in_data_renderers ();
+	
+	const int pSizes[] = {48, 96, 192};
+	const CairoDockTypeGraph pTypes[] = {CAIRO_DOCK_GRAPH_LINE, CAIRO_DOCK_GRAPH_PLAIN, CAIRO_DOCK_GRAPH_BAR};
+	const gchar *cTypeNames[] = {"line", "plain", "bar"};
+	guint k, l;
+	printf ("us per frame, %d values per graph, %d frames:\n", BENCH_NB_VALUES, iNbFrames);
+	printf ("%6s %6s %12s %12s\n", "graph", "size", "1 value", "2 values");
+	for (l = 0; l < G_N_ELEMENTS (pTypes); l ++)
+	{
+		for (k = 0; k < G_N_ELEMENTS (pSizes); k ++)
+		{
+			printf ("%6s %6d", cTypeNames[l], pSizes[k]);
+			printf (" %12.1f", _run (pTypes[l], pSizes[k], 1, iNbFrames));  // the raster is scrolled.
+			printf (" %12.1f", _run (pTypes[l], pSizes[k], 2, iNbFrames));  // the raster is redrawn.
+			printf ("\n");
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Compares the 3 ways of computing the magnification of the icons on the wave:
+// libm's sin(), the table of cairo_dock_get_magnification_profile(), and the polynomial of the linear dock's layout.
+// Usage: bench-magnification [nb of rounds]
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <glib.h>
+
+#include "cairo-dock-icon-manager.h"  // cairo_dock_build_magnification_profile, cairo_dock_get_magnification_profile
+
+#define BENCH_AMPLITUDE 1.
+
+// same polynomial as _sin_0_pi() in cairo-dock-dock-facility.c.
+static inline gdouble _sin_0_pi (gdouble x)
+{
+	gdouble t = x - G_PI_2;
+	gdouble t2 = t * t;
+	return 1. + t2 * (-1./2 + t2 * (1./24 + t2 * (-1./720 + t2 * (1./40320 + t2 * (-1./3628800)))));
+}
+
+static void _compute_libm (const gdouble *fPhase, gdouble *fScale, int n)
+{
+	int i;
+	for (i = 0; i < n; i ++)
+		fScale[i] = 1. + BENCH_AMPLITUDE * sin (fPhase[i]);
+}
+
+static void _compute_table (const gdouble *fPhase, gdouble *fScale, int n)
+{
+	int i;
+	for (i = 0; i < n; i ++)
+		fScale[i] = 1. + cairo_dock_get_magnification_profile (fPhase[i]);
+}
+
+static void _compute_polynomial (const gdouble *fPhase, gdouble *fScale, int n)
+{
+	int i;
+	for (i = 0; i < n; i ++)
+		fScale[i] = 1. + BENCH_AMPLITUDE * _sin_0_pi (fPhase[i]);
+}
+
+typedef void (*BenchFunc) (const gdouble *fPhase, gdouble *fScale, int n);
+
+static void _run (BenchFunc compute, const gdouble *fPhase, gdouble *fScale, int n, int iNbRounds, gdouble *fCheckSum)
+{
+	int r, i;
+	gint64 t0 = g_get_monotonic_time ();
+	for (r = 0; r < iNbRounds; r ++)
+	{
+		compute (fPhase, fScale, n);
+		*fCheckSum += fScale[r % n];  // so that the loop is not optimized out.
+	}
+	gint64 t1 = g_get_monotonic_time ();
+	double fMaxError = 0.;
+	for (i = 0; i < n; i ++)
+		fMaxError = MAX (fMaxError, fabs (fScale[i] - (1. + BENCH_AMPLITUDE * sin (fPhase[i]))));
+	printf (" %8.2f (%.1e)", 1000. * (t1 - t0) / ((double)iNbRounds * n), fMaxError);  // ns per icon, and max error against libm.
+}
+
+int main (int argc, char **argv)
+{
+	int iNbRounds = (argc > 1 ? atoi (argv[1]) : 200000);
+	if (iNbRounds <= 0)
+		iNbRounds = 1;
+	
+	cairo_dock_build_magnification_profile (BENCH_AMPLITUDE);
+	
+	const int pNbIcons[] = {10, 50, 100, 500};
+	gdouble fCheckSum = 0.;
+	guint k;
+	printf ("ns per icon (max error):\n");
+	printf ("%6s %18s %18s %18s\n", "icons", "sin", "table", "polynomial");
+	for (k = 0; k < G_N_ELEMENTS (pNbIcons); k ++)
+	{
+		int i, n = pNbIcons[k];
+		gdouble *fPhase = g_new (gdouble, n);
+		gdouble *fScale = g_new (gdouble, n);
+		for (i = 0; i < n; i ++)  // the wave over the whole dock, with the flat parts on both sides.
+			fPhase[i] = CLAMP ((2. * i / n - .5) * G_PI, 0., G_PI);
+		int iRounds = MAX (1, iNbRounds * 10 / n);
+		
+		printf ("%6d", n);
+		_run (_compute_libm, fPhase, fScale, n, iRounds, &fCheckSum);
+		_run (_compute_table, fPhase, fScale, n, iRounds, &fCheckSum);
+		_run (_compute_polynomial, fPhase, fScale, n, iRounds, &fCheckSum);
+		printf ("\n");
+		
+		g_free (fPhase);
+		g_free (fScale);
+	}
+	printf ("(checksum: %g)\n", fCheckSum);
+	return 0;
+}
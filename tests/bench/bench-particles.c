@@ -0,0 +1,94 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Measures the default particle model (including the rewinding of the dead particles) and the building of the quads of a particle system, without any display (nothing is drawn).
+// Usage: bench-particles [nb of steps]
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <glib.h>
+
+#include "cairo-dock-particle-system.h"
+
+static GRand *s_pRand = NULL;
+
+static void _rewind_particle (CairoParticle *p, G_GNUC_UNUSED double dt)
+{
+	p->x = 2 * g_rand_double (s_pRand) - 1;
+	p->y = 0.;
+	p->z = 2 * g_rand_double (s_pRand) - 1;
+	p->vx = 0.;
+	p->vy = .01 * g_rand_double (s_pRand);
+	p->fWidth = p->fHeight = 4.;
+	p->color[0] = 1.;
+	p->color[1] = .5;
+	p->color[2] = 0.;
+	p->fOscillation = G_PI * (2 * g_rand_double (s_pRand) - 1);
+	p->fOmega = .2 * g_rand_double (s_pRand);
+	p->fSizeFactor = 1.;
+	p->fResizeSpeed = -.01;
+	p->iInitialLife = g_rand_int_range (s_pRand, 10, 60);
+	p->iLife = p->iInitialLife;
+}
+
+int main (int argc, char **argv)
+{
+	int iNbSteps = (argc > 1 ? atoi (argv[1]) : 20000);
+	if (iNbSteps <= 0)
+		iNbSteps = 1;
+	s_pRand = g_rand_new_with_seed (1);
+	
+	const int pNbParticles[] = {100, 1000, 10000, 100000};
+	guint k;
+	int iCheckSum = 0;
+	printf ("ns per particle:\n");
+	printf ("%9s %9s %9s %9s\n", "particles", "update", "quads", "+light");
+	for (k = 0; k < G_N_ELEMENTS (pNbParticles); k ++)
+	{
+		int i, n = pNbParticles[k];
+		int iNbRounds = MAX (1, iNbSteps * 100 / n);
+		CairoParticleSystem *pParticleSystem = cairo_dock_create_particle_system (n, 0, 100., 100.);
+		for (i = 0; i < n; i ++)
+		{
+			_rewind_particle (&pParticleSystem->pParticles[i], 0.);
+			pParticleSystem->pParticles[i].iLife = g_rand_int_range (s_pRand, 1, pParticleSystem->pParticles[i].iInitialLife + 1);  // spread the deaths over time.
+		}
+		
+		gint64 t0 = g_get_monotonic_time ();
+		for (i = 0; i < iNbRounds; i ++)
+			iCheckSum += cairo_dock_update_default_particle_system (pParticleSystem, _rewind_particle);
+		gint64 t1 = g_get_monotonic_time ();
+		for (i = 0; i < iNbRounds; i ++)
+			iCheckSum += cairo_dock_compute_particles_vertices (pParticleSystem, 0);
+		gint64 t2 = g_get_monotonic_time ();
+		pParticleSystem->bAddLight = TRUE;
+		for (i = 0; i < iNbRounds; i ++)
+			iCheckSum += cairo_dock_compute_particles_vertices (pParticleSystem, 0);
+		gint64 t3 = g_get_monotonic_time ();
+		
+		double fNbParticles = (double)iNbRounds * n / 1000.;
+		printf ("%9d %9.2f %9.2f %9.2f\n", n, (t1 - t0) / fNbParticles, (t2 - t1) / fNbParticles, (t3 - t2) / fNbParticles);
+		cairo_dock_free_particle_system (pParticleSystem);
+	}
+	printf ("(checksum: %d)\n", iCheckSum);
+	g_rand_free (s_pRand);
+	return 0;
+}